@@ -0,0 +1,49 @@
+#include "internal/shared.h"
+#include "linc.h"
+
+#include <stdio.h>
+#include <time.h>
+
+// Cost of the timestamp read by producer threads with each clock, and of its conversion by the worker. Clocks that
+// are not available on this machine are skipped.
+
+#define BENCH_READS 1000000
+
+static int64_t bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000L + (int64_t)ts.tv_nsec;
+}
+
+static void bench_run(const char *name, enum linc_clock clock) {
+    if (linc_set_clock(clock) < 0) {
+        printf("%-10s %16s %16s\n", name, "-", "-");
+        return;
+    }
+
+    volatile int64_t sink = 0;
+    uint8_t flags = 0;
+    int64_t start = bench_now();
+    for (int i = 0; i < BENCH_READS; i++) {
+        sink += linc_clock_ticks(&flags);
+    }
+    int64_t read = bench_now() - start;
+
+    int64_t ticks = linc_clock_ticks(&flags);
+    start = bench_now();
+    for (int i = 0; i < BENCH_READS; i++) {
+        sink += linc_clock_nanoseconds(ticks + i, flags);
+    }
+    int64_t convert = bench_now() - start;
+    (void)sink;
+
+    printf("%-10s %16.1f %16.1f\n", name, (double)read / BENCH_READS, (double)convert / BENCH_READS);
+}
+
+int main(void) {
+    printf("%-10s %16s %16s\n", "clock", "read ns", "convert ns");
+    bench_run("monotonic", LINC_CLOCK_MONOTONIC);
+    bench_run("coarse", LINC_CLOCK_COARSE);
+    bench_run("tsc", LINC_CLOCK_TSC);
+    return 0;
+}
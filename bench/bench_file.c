@@ -0,0 +1,141 @@
+#include "linc.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// Time to get lines into a file with the file sinks, and with a hand-rolled fprintf of a similar line, flushed or not
+// after each line. Sinks are timed until every line is in the file, so the time of their sink thread counts too.
+
+#define BENCH_LINES 1000000
+
+static const struct timespec bench_poll = {.tv_sec = 0, .tv_nsec = 1000000};  // Pause between two checks of the file
+
+enum bench_writer {
+    BENCH_FPRINTF_FLUSH = 0,  // fprintf and fflush for each line, so lines reach the file right away
+    BENCH_FPRINTF = 1,        // fprintf for each line, written when the stdio buffer is full
+    BENCH_FILE = 2,           // Logs written by a file sink
+    BENCH_FILE_ASYNC = 3,     // Logs submitted to io_uring by an asynchronous file sink
+    BENCH_MMAP = 4,           // Logs copied into the mapping of a memory-mapped sink
+};
+
+static int64_t bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000L + (int64_t)ts.tv_nsec;
+}
+
+// Length of the first line of the file, every line of a run has the same length.
+static size_t bench_line_length(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return 0;
+    }
+    char line[1024];
+    size_t length = fgets(line, sizeof(line), file) != NULL ? strlen(line) : 0;
+    fclose(file);
+    return length;
+}
+
+// The file is complete once the last line ends, memory-mapped files are preallocated so their size tells nothing.
+static bool bench_is_complete(const char *path) {
+    size_t length = bench_line_length(path);
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return false;
+    }
+    bool is_complete = length > 0 && fseek(file, (long)(length * BENCH_LINES - 1), SEEK_SET) == 0;
+    is_complete = is_complete && fgetc(file) == '\n';
+    fclose(file);
+    return is_complete;
+}
+
+static double bench_fprintf(const char *path, bool is_flushed) {
+    FILE *file = fopen(path, "a");
+    if (file == NULL) {
+        return 0;
+    }
+    int64_t start = bench_now();
+    for (int i = 0; i < BENCH_LINES; i++) {
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        struct tm tm;
+        gmtime_r(&now.tv_sec, &tm);
+        char timestamp[32];
+        strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", &tm);
+        fprintf(file,
+                "[ %s.%03ld ] [ INFO  ] [ %016lx ] [ %-16s ] %s:%d %s: bench log %08d\n",
+                timestamp,
+                now.tv_nsec / 1000000,
+                (unsigned long)pthread_self(),
+                "default",
+                __FILE__,
+                __LINE__,
+                __func__,
+                i);
+        if (is_flushed) {
+            fflush(file);
+        }
+    }
+    fclose(file);
+    return (double)(bench_now() - start) / BENCH_LINES;
+}
+
+static double bench_sink(const char *path, const char *name, struct linc_sink_funcs funcs) {
+    linc_sink sink = linc_register_sink(name, LINC_LEVEL_TRACE, true, funcs);
+    if (sink == NULL) {
+        return 0;
+    }
+    int64_t start = bench_now();
+    for (int i = 0; i < BENCH_LINES; i++) {
+        INFO("bench log %08d", i);
+    }
+    while (!bench_is_complete(path)) {
+        nanosleep(&bench_poll, NULL);
+    }
+    int64_t elapsed = bench_now() - start;
+    linc_set_sink_enabled(sink, false);
+    return (double)elapsed / BENCH_LINES;
+}
+
+static void bench_run(const char *name, enum bench_writer writer) {
+    char path[] = "/tmp/linc_bench_file_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        return;
+    }
+    close(fd);
+    // A short flush delay, so the last lines are not kept in the buffer of the file sink for long.
+    struct linc_sink_file_options options = {
+        .buffer_size = 0, .flush_delay_us = 1000, .layout = NULL, .is_async = writer == BENCH_FILE_ASYNC};
+    double result = 0;
+    switch (writer) {
+        case BENCH_FPRINTF_FLUSH:
+        case BENCH_FPRINTF:
+            result = bench_fprintf(path, writer == BENCH_FPRINTF_FLUSH);
+            break;
+        case BENCH_FILE:
+        case BENCH_FILE_ASYNC:
+            result = bench_sink(path, name, linc_sink_file_funcs(path, &options));
+            break;
+        case BENCH_MMAP:
+            result = bench_sink(path, name, linc_sink_mmap_funcs(path, NULL));
+            break;
+    }
+    printf("%-16s %16.1f %16zu\n", name, result, bench_line_length(path));
+    unlink(path);
+}
+
+int main(void) {
+    linc_set_sink_enabled(linc_default_sink, false);
+    printf("%-16s %16s %16s\n", "writer", "ns/line", "bytes/line");
+    bench_run("fprintf+fflush", BENCH_FPRINTF_FLUSH);
+    bench_run("fprintf", BENCH_FPRINTF);
+    bench_run("file sink", BENCH_FILE);
+    bench_run("file sink async", BENCH_FILE_ASYNC);
+    bench_run("mmap sink", BENCH_MMAP);
+    return 0;
+}
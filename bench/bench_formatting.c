@@ -0,0 +1,69 @@
+#include "linc.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// Producer latency of linc_log with eager and deferred formatting. Logs are written in bursts that fit in the ring
+// buffer, so the time measured is the time spent by the calling thread and never the time spent waiting for space.
+
+#define BENCH_BURSTS 50
+#define BENCH_BURST_RECORDS 2000
+
+static int bench_sink_open(void *data) {
+    (void)data;
+    return 0;
+}
+
+static int bench_sink_close(void *data) {
+    (void)data;
+    return 0;
+}
+
+static int bench_sink_write(void *data, struct linc_metadata *metadata) {
+    (void)data;
+    (void)metadata;
+    return 0;
+}
+
+static int bench_sink_flush(void *data) {
+    (void)data;
+    return 0;
+}
+
+static int64_t bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000L + (int64_t)ts.tv_nsec;
+}
+
+static double bench_run(enum linc_formatting formatting) {
+    linc_set_formatting(formatting);
+    struct timespec drain = {.tv_sec = 0, .tv_nsec = 50000000};
+    int64_t elapsed = 0;
+    for (int burst = 0; burst < BENCH_BURSTS; burst++) {
+        int64_t start = bench_now();
+        for (int i = 0; i < BENCH_BURST_RECORDS; i++) {
+            INFO("request %d from %s took %.3f ms, %zu bytes", i, "10.0.0.1", 1.25, (size_t)4096);
+        }
+        elapsed += bench_now() - start;
+        nanosleep(&drain, NULL);
+    }
+    return (double)elapsed / (BENCH_BURSTS * BENCH_BURST_RECORDS);
+}
+
+int main(void) {
+    linc_set_sink_enabled(linc_default_sink, false);
+    struct linc_sink_funcs funcs;
+    memset(&funcs, 0, sizeof(funcs));
+    funcs.open = bench_sink_open;
+    funcs.close = bench_sink_close;
+    funcs.write = bench_sink_write;
+    funcs.flush = bench_sink_flush;
+    linc_register_sink("null", LINC_LEVEL_TRACE, true, funcs);
+
+    printf("%-10s %16s\n", "formatting", "ns/log");
+    printf("%-10s %16.1f\n", "eager", bench_run(LINC_FORMATTING_EAGER));
+    printf("%-10s %16.1f\n", "deferred", bench_run(LINC_FORMATTING_DEFERRED));
+    return 0;
+}
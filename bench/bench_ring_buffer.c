@@ -0,0 +1,167 @@
+#include "internal/shared.h"
+#include "linc.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// Throughput comparison between the lock-free ring buffer and the mutex + condition variables queue it replaced.
+// Every run moves the same number of records from N producer threads to a single consumer thread. Both queues get
+// the same amount of memory: the mutex queue stores fixed-size entries, the lock-free one variable-length records.
+
+#define BENCH_RECORDS 128000
+#define BENCH_RING_SIZE 1024
+
+// ==================================================
+// Mutex Ring Buffer (previous implementation)
+// ==================================================
+
+struct mutex_ring_buffer {
+    struct linc_metadata buffer[BENCH_RING_SIZE + 1];
+    size_t head;
+    size_t tail;
+    size_t size;
+    bool shutdown;
+    pthread_mutex_t mutex;
+    pthread_cond_t produce, consume;
+};
+
+static struct mutex_ring_buffer mutex_ring;
+
+static void mutex_ring_init(void) {
+    mutex_ring.size = BENCH_RING_SIZE + 1;
+    mutex_ring.head = 0;
+    mutex_ring.tail = 0;
+    mutex_ring.shutdown = false;
+    pthread_mutex_init(&mutex_ring.mutex, NULL);
+    pthread_cond_init(&mutex_ring.produce, NULL);
+    pthread_cond_init(&mutex_ring.consume, NULL);
+}
+
+static int mutex_ring_push(const struct linc_metadata *metadata) {
+    pthread_mutex_lock(&mutex_ring.mutex);
+    size_t entries = (mutex_ring.head + mutex_ring.size - mutex_ring.tail) % mutex_ring.size;
+    while (entries == BENCH_RING_SIZE) {
+        pthread_cond_wait(&mutex_ring.produce, &mutex_ring.mutex);
+        entries = (mutex_ring.head + mutex_ring.size - mutex_ring.tail) % mutex_ring.size;
+    }
+    mutex_ring.buffer[mutex_ring.head] = *metadata;
+    mutex_ring.head = (mutex_ring.head + 1) % mutex_ring.size;
+    pthread_cond_broadcast(&mutex_ring.consume);
+    pthread_mutex_unlock(&mutex_ring.mutex);
+    return 0;
+}
+
+static int mutex_ring_pop(struct linc_metadata *metadata) {
+    pthread_mutex_lock(&mutex_ring.mutex);
+    size_t entries = (mutex_ring.head + mutex_ring.size - mutex_ring.tail) % mutex_ring.size;
+    while (entries == 0) {
+        pthread_cond_wait(&mutex_ring.consume, &mutex_ring.mutex);
+        entries = (mutex_ring.head + mutex_ring.size - mutex_ring.tail) % mutex_ring.size;
+    }
+    *metadata = mutex_ring.buffer[mutex_ring.tail];
+    memset(&mutex_ring.buffer[mutex_ring.tail], 0, sizeof(struct linc_metadata));
+    mutex_ring.tail = (mutex_ring.tail + 1) % mutex_ring.size;
+    pthread_cond_broadcast(&mutex_ring.produce);
+    pthread_mutex_unlock(&mutex_ring.mutex);
+    return 0;
+}
+
+// ==================================================
+// Lock-free Ring Buffer
+// ==================================================
+
+static LINC_CACHE_ALIGNED unsigned char lock_free_bytes[BENCH_RING_SIZE * sizeof(struct linc_metadata)];
+static struct linc_ring_buffer lock_free_ring;
+static struct linc_signal lock_free_consume;
+
+static void lock_free_ring_init(void) {
+    linc_signal_init(&lock_free_consume);
+    linc_ring_buffer_init(&lock_free_ring, lock_free_bytes, sizeof(lock_free_bytes), false, &lock_free_consume);
+}
+
+static int lock_free_ring_push(const struct linc_metadata *metadata) {
+    return linc_ring_buffer_push(&lock_free_ring, metadata, strlen(metadata->message), 0, LINC_BACKPRESSURE_BLOCK, 0);
+}
+
+static int lock_free_ring_pop(struct linc_metadata *metadata) {
+    return linc_ring_buffer_pop(&lock_free_ring, metadata);
+}
+
+// ==================================================
+// Harness
+// ==================================================
+
+struct bench_queue {
+    const char *name;
+    void (*init)(void);
+    int (*push)(const struct linc_metadata *metadata);
+    int (*pop)(struct linc_metadata *metadata);
+};
+
+struct bench_producer {
+    const struct bench_queue *queue;
+    size_t records;
+};
+
+static int64_t bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000L + (int64_t)ts.tv_nsec;
+}
+
+static void *bench_producer(void *arg) {
+    struct bench_producer *producer = (struct bench_producer *)arg;
+    struct linc_metadata metadata;
+    memset(&metadata, 0, sizeof(metadata));
+    metadata.level = LINC_LEVEL_INFO;
+    strcpy(metadata.message, "connection closed");
+    for (size_t i = 0; i < producer->records; i++) {
+        metadata.line = (uint32_t)i;
+        producer->queue->push(&metadata);
+    }
+    return NULL;
+}
+
+static double bench_run(const struct bench_queue *queue, size_t producers_count) {
+    pthread_t producers[64];
+    struct bench_producer producer = {
+        .queue = queue,
+        .records = BENCH_RECORDS / producers_count,
+    };
+    size_t total = producer.records * producers_count;
+
+    queue->init();
+    int64_t start = bench_now();
+    for (size_t i = 0; i < producers_count; i++) {
+        pthread_create(&producers[i], NULL, bench_producer, &producer);
+    }
+    struct linc_metadata metadata;
+    for (size_t i = 0; i < total; i++) {
+        queue->pop(&metadata);
+    }
+    for (size_t i = 0; i < producers_count; i++) {
+        pthread_join(producers[i], NULL);
+    }
+    int64_t elapsed = bench_now() - start;
+
+    return (double)total / ((double)elapsed / 1e9);
+}
+
+int main(void) {
+    const struct bench_queue queues[] = {
+        {"mutex", mutex_ring_init, mutex_ring_push, mutex_ring_pop},
+        {"lock-free", lock_free_ring_init, lock_free_ring_push, lock_free_ring_pop},
+    };
+    const size_t producers[] = {1, 4, 16, 64};
+
+    printf("%-10s %10s %16s\n", "queue", "producers", "records/s");
+    for (size_t p = 0; p < sizeof(producers) / sizeof(producers[0]); p++) {
+        for (size_t q = 0; q < sizeof(queues) / sizeof(queues[0]); q++) {
+            double throughput = bench_run(&queues[q], producers[p]);
+            printf("%-10s %10zu %16.0f\n", queues[q].name, producers[p], throughput);
+        }
+    }
+    return 0;
+}
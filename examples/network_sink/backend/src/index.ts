@@ -36,28 +36,42 @@ app.get('/api/logs', (context) => {
     });
 });
 
-const parseLog = (rawLog: string): Log => {
-    const jsonLog = JSON.parse(rawLog);
+const parseLog = (jsonLog: Record<string, unknown>): Log => {
     return {
-        timestamp: new Date(jsonLog.timestamp).toISOString(),
-        level: jsonLog.level,
-        thread_id: jsonLog.thread_id,
-        module_name: jsonLog.module_name,
-        filename: jsonLog.filename,
+        timestamp: new Date(String(jsonLog.timestamp)).toISOString(),
+        level: String(jsonLog.level),
+        thread_id: String(jsonLog.thread_id),
+        module_name: String(jsonLog.module ?? jsonLog.module_name),
+        filename: String(jsonLog.file ?? jsonLog.filename),
         line: Number(jsonLog.line),
-        func: jsonLog.func,
-        message: jsonLog.message,
-        raw: rawLog,
+        func: String(jsonLog.func),
+        message: String(jsonLog.message),
+        raw: JSON.stringify(jsonLog),
     };
 };
 
+// Bodies hold a single log, a JSON array of logs, or one log per line (application/x-ndjson).
+const parseBody = (raw: string, contentType: string | undefined): Record<string, unknown>[] => {
+    const body = raw.trim();
+    if (contentType?.includes('ndjson')) {
+        return body.split('\n').filter((line) => line.length > 0).map((line) => JSON.parse(line));
+    }
+    const parsed = JSON.parse(body);
+    return Array.isArray(parsed) ? parsed : [parsed];
+};
+
 app.post('/api/logs', async (context) => {
     const raw = await context.req.text();
 
-    const log = parseLog(raw);
-    inMemory.push(log);
+    let logs: Log[];
+    try {
+        logs = parseBody(raw, context.req.header('content-type')).map(parseLog);
+    } catch {
+        return context.json({ error: 'invalid logs' }, 400);
+    }
+    inMemory.push(...logs);
 
-    return context.json({ log });
+    return context.json({ received: logs.length, total: inMemory.length });
 });
 
 export default {
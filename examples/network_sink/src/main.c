@@ -1,4 +1,3 @@
-#include "http_sink.h"
 #include "linc.h"
 
 #include <pthread.h>
@@ -8,20 +7,8 @@
 
 #define THREAD_LOGS 10
 
-struct sink_network sink_network_data = {
-    .sockfd = -1,
-    .host = "0.0.0.0",
-    .port = "3000",
+struct linc_sink_http_options http_options = {
     .path = "/api/logs",
-    .keep_alive = 1,
-};
-
-struct linc_sink_funcs funcs = {
-    .data = &sink_network_data,
-    .open = sink_network_open,
-    .close = sink_network_close,
-    .write = sink_network_write,
-    .flush = sink_network_flush,
 };
 
 linc_module app_module;
@@ -67,7 +54,7 @@ void *service_thread(void *arg) {
 int main(void) {
     srand(time(NULL));
 
-    linc_register_sink("network", LINC_LEVEL_TRACE, true, funcs);
+    linc_register_sink("network", LINC_LEVEL_TRACE, true, linc_sink_http_funcs("127.0.0.1", "3000", &http_options));
     linc_set_sink_level(linc_default_sink, LINC_LEVEL_TRACE);
     linc_set_module_enabled(linc_default_module, false);
     app_module = linc_register_module("app", LINC_LEVEL_DEBUG, true);
@@ -77,8 +64,8 @@ int main(void) {
     pthread_t threads[3];
 
     pthread_create(&threads[0], NULL, app_thread, NULL);
-    pthread_create(&threads[0], NULL, db_thread, NULL);
-    pthread_create(&threads[0], NULL, service_thread, NULL);
+    pthread_create(&threads[1], NULL, db_thread, NULL);
+    pthread_create(&threads[2], NULL, service_thread, NULL);
 
     for (int i = 0; i < 3; i++) {
         pthread_join(threads[i], NULL);
@@ -0,0 +1,29 @@
+#ifndef LINC_INCLUDE_INTERNAL_ATOMICS_H
+#define LINC_INCLUDE_INTERNAL_ATOMICS_H
+
+// ==================================================
+// Macros
+// ==================================================
+
+#define LINC_CACHE_LINE_SIZE 64  // Size of a cache line, used to keep hot shared fields apart
+
+#if defined(__GNUC__)
+#define LINC_CACHE_ALIGNED __attribute__((aligned(LINC_CACHE_LINE_SIZE)))  // Places a field on its own cache line
+#define LINC_THREAD_LOCAL __thread                                         // Thread-local storage class
+#define LINC_RELAXED __ATOMIC_RELAXED
+#define LINC_ACQUIRE __ATOMIC_ACQUIRE
+#define LINC_RELEASE __ATOMIC_RELEASE
+#define LINC_ACQ_REL __ATOMIC_ACQ_REL
+#define LINC_SEQ_CST __ATOMIC_SEQ_CST
+#define LINC_ATOMIC_LOAD(ptr, order) __atomic_load_n((ptr), (order))
+#define LINC_ATOMIC_STORE(ptr, value, order) __atomic_store_n((ptr), (value), (order))
+#define LINC_ATOMIC_FETCH_ADD(ptr, value, order) __atomic_fetch_add((ptr), (value), (order))
+#define LINC_ATOMIC_EXCHANGE(ptr, value, order) __atomic_exchange_n((ptr), (value), (order))
+#define LINC_ATOMIC_CAS(ptr, expected, desired, order) \
+    __atomic_compare_exchange_n((ptr), (expected), (desired), true, (order), LINC_RELAXED)
+#define LINC_ATOMIC_FENCE(order) __atomic_thread_fence(order)
+#else
+#error "LINC requires a compiler providing the GCC __atomic builtins"
+#endif
+
+#endif  // LINC_INCLUDE_INTERNAL_ATOMICS_H
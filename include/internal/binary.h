@@ -0,0 +1,73 @@
+#ifndef LINC_INCLUDE_INTERNAL_BINARY_H
+#define LINC_INCLUDE_INTERNAL_BINARY_H
+
+#include "linc.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// ==================================================
+// Macros
+// ==================================================
+
+#define LINC_BINARY_VERSION 1          // Version of the format, written in the header of each segment
+#define LINC_BINARY_ENTRIES 1024       // Identifiers of a segment, a new segment starts once they are used
+#define LINC_BINARY_SLOTS 2048         // Slots of the hash table of the identifiers of a segment, a power of 2
+#define LINC_BINARY_STRING_LENGTH 255  // Maximum length of an interned string, longer strings are truncated
+
+// Maximum length of an encoded log, with the header of a new segment and the definitions it needs
+#define LINC_BINARY_RECORD_LENGTH (1024 + LINC_DEFAULT_MAX_MESSAGE_LENGTH)
+
+// ==================================================
+// Structures and Enums
+// ==================================================
+
+enum linc_binary_tag {
+    LINC_BINARY_SEGMENT = 'L',  // "LINC", version and first timestamp, starts a segment with no identifiers
+    LINC_BINARY_STRING = 'S',   // Identifier, length and bytes of a module, file or function name
+    LINC_BINARY_THREAD = 'T',   // Identifier and thread ID
+    LINC_BINARY_LOG = 'R',      // Timestamp delta, level, identifiers, line and message of a log
+};
+
+enum linc_binary_status {
+    LINC_BINARY_INVALID = -1,    // Bytes are not a valid entry
+    LINC_BINARY_PARTIAL = 0,     // Bytes end before the entry, more are needed
+    LINC_BINARY_DEFINITION = 1,  // A segment header or a definition was read
+    LINC_BINARY_RECORD = 2,      // A log was read into the metadata
+};
+
+struct linc_binary_entry {
+    uintptr_t key;  // Address of the string, or thread ID
+    uint32_t id;    // Identifier in the segment, 0 if the slot is free
+    uint8_t tag;    // Definition of the identifier (enum linc_binary_tag)
+};
+
+struct linc_binary_writer {
+    struct linc_binary_entry slots[LINC_BINARY_SLOTS];  // Identifiers of the segment, by address or thread ID
+    uint32_t count;                                     // Next identifier, 0 before the header of the segment
+    int64_t timestamp;                                  // Timestamp of the previous log of the segment
+};
+
+struct linc_binary_reader {
+    uint8_t tags[LINC_BINARY_ENTRIES];                                    // Definition of each identifier
+    uint64_t values[LINC_BINARY_ENTRIES];                                 // Thread ID, or offset of the string
+    char strings[LINC_BINARY_ENTRIES * (LINC_BINARY_STRING_LENGTH + 1)];  // Strings of the segment
+    size_t strings_used;                                                  // Bytes used by the strings
+    uint32_t count;                                                       // Next identifier, 0 before a segment
+    int64_t timestamp;                                                    // Timestamp of the previous log
+};
+
+// ==================================================
+// Internal Functions
+// ==================================================
+
+void linc_binary_reset(struct linc_binary_writer *writer);
+size_t linc_binary_encode(struct linc_binary_writer *writer, const struct linc_metadata *metadata, char *buffer);
+enum linc_binary_status linc_binary_decode(struct linc_binary_reader *reader,
+                                           const char *data,
+                                           size_t length,
+                                           struct linc_metadata *metadata,
+                                           size_t *used);
+
+#endif  // LINC_INCLUDE_INTERNAL_BINARY_H
@@ -0,0 +1,82 @@
+#ifndef LINC_INCLUDE_INTERNAL_LAYOUTS_H
+#define LINC_INCLUDE_INTERNAL_LAYOUTS_H
+
+#include "linc.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// ==================================================
+// Structures and Enums
+// ==================================================
+
+enum linc_layout_field {
+    LINC_LAYOUT_LITERAL = 0,       // Constant text of the pattern
+    LINC_LAYOUT_TIMESTAMP = 1,     // %t, timestamp string
+    LINC_LAYOUT_EPOCH = 2,         // %T, nanoseconds since epoch
+    LINC_LAYOUT_LEVEL = 3,         // %l, level string
+    LINC_LAYOUT_LEVEL_COLOR = 4,   // %{level}, ANSI color of the level
+    LINC_LAYOUT_THREAD_ID = 5,     // %i, thread ID in hexadecimal
+    LINC_LAYOUT_MODULE = 6,        // %M, module name
+    LINC_LAYOUT_FILE = 7,          // %f, source file name
+    LINC_LAYOUT_LINE = 8,          // %n, line number
+    LINC_LAYOUT_FUNC = 9,          // %F, function name
+    LINC_LAYOUT_MESSAGE = 10,      // %m, log message
+    LINC_LAYOUT_TID = 11,          // %I, kernel thread ID
+    LINC_LAYOUT_THREAD_NAME = 12,  // %N, thread name
+};
+
+enum linc_layout_escape {
+    LINC_LAYOUT_ESCAPE_NONE = 0,    // Field is copied as is
+    LINC_LAYOUT_ESCAPE_JSON = 1,    // %j, field is escaped for a JSON string
+    LINC_LAYOUT_ESCAPE_LOGFMT = 2,  // %q, field is quoted and escaped for logfmt when needed
+};
+
+enum linc_layout_builtin {
+    LINC_LAYOUT_BUILTIN_TEXT = 0,        // Default line format
+    LINC_LAYOUT_BUILTIN_TEXT_COLOR = 1,  // Default line format with ANSI colors
+    LINC_LAYOUT_BUILTIN_JSON = 2,        // One JSON object per line
+    LINC_LAYOUT_BUILTIN_LOGFMT = 3,      // One logfmt record per line
+    LINC_LAYOUT_BUILTIN_COUNT = 4,       // Number of built-in layouts
+};
+
+struct linc_layout_op {
+    uint8_t field;         // Field rendered by the operation (enum linc_layout_field)
+    uint8_t escape;        // Escaping of the field (enum linc_layout_escape)
+    bool is_left_aligned;  // Field is padded on the right
+    uint16_t width;        // Minimum width of the field, padded with spaces
+    uint16_t offset;       // Offset of the constant text in the literals of the layout
+    uint16_t length;       // Length of the constant text
+};
+
+struct linc_layout {
+    struct linc_layout_op ops[LINC_DEFAULT_LAYOUT_OPS];  // Operations run in order to render a record
+    size_t count;                                        // Number of operations
+    char literals[LINC_DEFAULT_LAYOUT_LITERALS_LENGTH];  // Constant text of every literal operation
+    size_t literals_length;                              // Length of the constant text
+    unsigned int fields;                                 // Bit mask of the fields used by the operations
+};
+
+struct linc_layout_list {
+    struct linc_layout list[LINC_LAYOUT_BUILTIN_COUNT + LINC_DEFAULT_MAX_LAYOUTS];  // Built-in and compiled layouts
+    size_t count;                                                                   // Number of layouts
+    pthread_mutex_t mutex;                                                          // Mutex for thread safety
+};
+
+// ==================================================
+// Internal Functions
+// ==================================================
+
+void linc_layouts_init(void);
+
+// ==================================================
+// Public Functions (linc.h)
+// ==================================================
+
+// linc_layout linc_layout_compile(const char *pattern);
+// int linc_layout_render(linc_layout layout, const struct linc_metadata *metadata, char *buffer, size_t length);
+// int linc_stringify_metadata(struct linc_metadata *metadata, char *buffer, size_t length, bool use_colors);
+// const char *linc_layout_view(linc_layout layout, const struct linc_metadata *metadata, size_t *length);
+
+#endif  // LINC_INCLUDE_INTERNAL_LAYOUTS_H
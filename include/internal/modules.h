@@ -1,6 +1,7 @@
 #ifndef LINC_INCLUDE_INTERNAL_MODULES_H
 #define LINC_INCLUDE_INTERNAL_MODULES_H
 
+#include "internal/atomics.h"
 #include "linc.h"
 
 #include <pthread.h>
@@ -10,10 +11,12 @@
 // ==================================================
 
 struct linc_module {
+    int state;                                                           // Packed level and enabled flag, kept first
     char name[LINC_DEFAULT_MODULE_NAME_LENGTH + LINC_ZERO_CHAR_LENGTH];  // Module name
-    enum linc_level level;                                               // Minimum log level for this module
-    bool enabled;                                                        // Is module enabled
-    pthread_rwlock_t lock;                                               // Lock for thread safety
+    int backpressure[LINC_LEVEL_FATAL + 1];                              // Policy on a full buffer for each level
+    uint32_t backpressure_timeout[LINC_LEVEL_FATAL + 1];                 // Time in microseconds to wait for each level
+    LINC_CACHE_ALIGNED size_t dropped;                                   // Number of logs dropped on a full buffer
+    size_t reported;                                                     // Dropped logs already reported by the worker
 };
 
 struct linc_module_list {
@@ -27,6 +30,7 @@ struct linc_module_list {
 // ==================================================
 
 struct linc_module *linc_register_default_module(struct linc_module_list *modules);
+struct linc_module *linc_module_of_name(const char *module_name);
 
 // ==================================================
 // Public Functions (linc.h)
@@ -35,5 +39,10 @@ struct linc_module *linc_register_default_module(struct linc_module_list *module
 // linc_module linc_register_module(const char *name, enum linc_level level, bool enabled);
 // int linc_set_module_level(linc_module module, enum linc_level level);
 // int linc_set_module_enabled(linc_module module, bool enabled);
+// int linc_set_module_backpressure(linc_module module,
+//                                  enum linc_level level,
+//                                  enum linc_backpressure backpressure,
+//                                  uint32_t timeout_us);
+// size_t linc_get_module_dropped(linc_module module);
 
 #endif  // LINC_INCLUDE_INTERNAL_MODULES_H
@@ -0,0 +1,64 @@
+#ifndef LINC_INCLUDE_INTERNAL_RECOVERY_H
+#define LINC_INCLUDE_INTERNAL_RECOVERY_H
+
+#include "linc.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// ==================================================
+// Macros
+// ==================================================
+
+#define LINC_RECOVERY_VARIABLE "LINC_RING_FILE"      // Environment variable with the path of the ring file
+#define LINC_RECOVERY_MAGIC "LINCRING"               // First bytes of a ring file
+#define LINC_RECOVERY_VERSION 1                      // Version of the ring file, written in its header
+#define LINC_RECOVERY_HEADER_BYTES 4096              // Bytes of the header, the ring bytes start on the next page
+#define LINC_RECOVERY_NAME_LENGTH 255                // Longest name copied into a record, longer ones are cut
+#define LINC_RECOVERY_PATH_LENGTH 1024               // Longest path a ring file holding records is moved aside to
+#define LINC_RECOVERY_DEFERRED "(deferred message)"  // Message of a record holding arguments of another process
+
+// ==================================================
+// Structures and Enums
+// ==================================================
+
+struct linc_record;
+struct linc_recovery_line;
+struct linc_ring_buffer;
+struct linc_signal;
+
+struct linc_recovery_header {
+    char magic[8];           // LINC_RECOVERY_MAGIC, without the zero character
+    uint32_t version;        // LINC_RECOVERY_VERSION
+    uint32_t record_header;  // Bytes of a record before its message, files of other builds are rejected
+    uint64_t size;           // Bytes of the ring after the header
+    int64_t pid;             // Process that wrote the file
+    uint64_t tail;           // Copy of the tail of the ring, the position of its oldest record
+};
+
+struct linc_recovery_reader {
+    const struct linc_recovery_header *header;  // Header of the ring file
+    const unsigned char *bytes;                 // Bytes of the ring
+    uint64_t position;                          // Position of the next record
+    uint64_t end;                               // Position after the last byte the ring can hold from the tail
+};
+
+// ==================================================
+// Internal Functions
+// ==================================================
+
+int linc_recovery_map(struct linc_ring_buffer *ring, const char *path, size_t size, struct linc_signal *consume);
+size_t linc_recovery_length(const struct linc_metadata *metadata);
+void linc_recovery_encode(struct linc_record *record, const struct linc_metadata *metadata, uint8_t flags);
+int linc_recovery_open(struct linc_recovery_reader *reader, const void *data, size_t length);
+int linc_recovery_next(struct linc_recovery_reader *reader, struct linc_metadata *metadata);
+void linc_recovery_format(struct linc_recovery_line *line, const struct linc_metadata *metadata);
+
+// ==================================================
+// Public Functions (linc.h)
+// ==================================================
+
+// int linc_set_crash_handler(int fd);
+
+#endif  // LINC_INCLUDE_INTERNAL_RECOVERY_H
@@ -1,10 +1,17 @@
 #ifndef LINC_INCLUDE_INTERNAL_SHARED_H
 #define LINC_INCLUDE_INTERNAL_SHARED_H
 
+#include "internal/atomics.h"
+#include "internal/layouts.h"
 #include "internal/modules.h"
+#include "internal/recovery.h"
 #include "internal/sinks.h"
+#include "internal/threads.h"
 #include "linc.h"
 
+#include <stdarg.h>
+#include <time.h>
+
 // ==================================================
 // Macros
 // ==================================================
@@ -26,12 +33,13 @@
 // [ -- ] [ -- ] [ -- ] [ -- ] --:-- --: --     -> LINC_LOG_EXTRA_FMT_LENGTH
 // 5 [ 10 ] [ 15 ] [ 10 ] [ 10 ] 10:10 10: --   -> LINC_LOG_COLORS_FMT_LENGTH
 
-#define LINC_LOG_TIMESTAMP_LENGTH 23  // Length of timestamp string "YYYY-MM-DD HH:MM:SS.mmm"
-#define LINC_LOG_LEVEL_LENGTH 5       // Length of log level string
-#define LINC_LOG_THREAD_ID_LENGTH 16  // Length of thread ID string
-#define LINC_LOG_FILE_LENGTH 64       // Length of file name string
-#define LINC_LOG_LINE_LENGTH 10       // Length of line number string
-#define LINC_LOG_FUNC_LENGTH 64       // Length of function name string
+#define LINC_LOG_TIMESTAMP_LENGTH (20 + LINC_DEFAULT_TIMESTAMP_PRECISION)  // Length of "YYYY-MM-DD HH:MM:SS.mmm"
+#define LINC_LOG_TIMESTAMP_PREFIX_LENGTH 19                                // Length of the date "YYYY-MM-DD HH:MM:SS"
+#define LINC_LOG_LEVEL_LENGTH 5                                            // Length of log level string
+#define LINC_LOG_THREAD_ID_LENGTH 16                                       // Length of thread ID string
+#define LINC_LOG_FILE_LENGTH 64                                            // Length of file name string
+#define LINC_LOG_LINE_LENGTH 10                                            // Length of line number string
+#define LINC_LOG_FUNC_LENGTH 64                                            // Length of function name string
 
 #define LINC_LOG_EXTRA_FMT_LENGTH 24   // Extra characters for formatting, e.g., [ ], spaces, etc.
 #define LINC_LOG_COLORS_FMT_LENGTH 80  // Extra characters for ANSI color codes
@@ -53,34 +61,132 @@
 #define LINC_COLOR_CYAN "\x1b[96m"
 #define LINC_COLOR_WHITE "\x1b[97m"
 
+#define LINC_SPIN_ATTEMPTS 64  // Number of polling attempts before a thread goes to sleep
+
+#define LINC_RECORD_ALIGNMENT 8          // Alignment of records in ring buffers
+#define LINC_RECORD_PADDING 0x80000000U  // Length flag of the filler record placed before wrapping around
+#define LINC_RECORD_DEFERRED 0x01U       // Record flag of a message holding captured arguments, not text
+#define LINC_RECORD_CLOCK_SHIFT 1        // Position of the clock of the timestamp in the record flags
+#define LINC_RECORD_CLOCK_MASK 0x06U     // Record flags holding the clock of the timestamp (enum linc_clock)
+#define LINC_RECORD_THREAD_ID 0x08U      // Record flag of a record ending with the thread ID, its thread has no entry
+
+#define LINC_CLOCK_TSC_UNIT (INT64_C(1) << 24)  // Fixed point unit of the nanoseconds per TSC tick
+
 // ==================================================
 // Structures and Enums
 // ==================================================
 
+struct linc_signal {
+    LINC_CACHE_ALIGNED size_t waiting;  // Number of threads sleeping on the condition variable
+    pthread_mutex_t mutex;              // Mutex only taken by threads going to sleep or waking sleepers
+    pthread_cond_t cond;                // Condition variable for signaling
+};
+
+struct linc_record {
+    uint32_t length;          // Record size in bytes, zero until the record is published
+    uint32_t line;            // Line number in the source file
+    int64_t timestamp;        // Timestamp in nanoseconds since epoch
+    const char *module_name;  // Module name where the log was generated
+    const char *filename;     // Source file where the log was generated
+    const char *func;         // Function name where the log was generated
+    uint32_t thread;          // Index of the thread in the thread registry, 0 if unknown
+    uint32_t message_length;  // Length of the message, without the zero character
+    uint8_t level;            // Level of the log
+    uint8_t flags;            // Record variant flags, e.g., LINC_RECORD_DEFERRED
+    char message[];           // Message content, only the written bytes and the zero character
+};
+
 struct linc_ring_buffer {
-    struct linc_metadata buffer[LINC_DEFAULT_RING_BUFFER_SIZE + 1];  // Ring buffer (+1 to distinguish full vs empty)
-    size_t head;                                                     // Points to the next position to write
-    size_t tail;                                                     // Points to the next position to read
-    size_t size;                                                     // Maximum number of elements in the buffer
-    bool shutdown;                                                   // Indicates if the worker thread should shut down
-    pthread_t worker;                                                // Worker thread handle
-    pthread_mutex_t mutex;                                           // Mutex for synchronizing access
-    pthread_cond_t produce, consume;                                 // Condition variables for signaling
+    unsigned char *buffer;            // Bytes storage, records are variable-length and 8-byte aligned
+    size_t size;                      // Capacity of the buffer in bytes
+    bool single_producer;             // Only one thread reserves, so the head is advanced without a CAS
+    LINC_CACHE_ALIGNED size_t head;   // Next byte position to reserve, claimed by producers
+    LINC_CACHE_ALIGNED size_t tail;   // Next byte position to read, owned by the single consumer
+    bool shutdown;                    // Indicates if the worker thread should shut down
+    LINC_CACHE_ALIGNED size_t evict;  // Tail position a producer asks the worker to reach by dropping records
+    struct linc_signal produce;       // Producers sleeping on a full buffer
+    struct linc_signal *consume;      // Consumer sleeping on an empty buffer, shared by buffers merged together
+    uint64_t *recovery_tail;          // Copy of the tail in the ring file, NULL if the ring is not in a file
 };
 
-struct linc_task_sync {
-    pthread_mutex_t mutex;                   // Mutex for synchronizing access
-    pthread_cond_t wait_worker, wait_sinks;  // Condition variables for signaling
-    size_t worker_ready, sinks_ready;        // Number of worker/sinks ready
-    size_t worker_ended, sinks_ended;        // Number of worker/sinks ended
-    struct linc_metadata *metadata;          // Pointer to the current metadata being processed
+enum linc_thread_buffer_state {
+    LINC_THREAD_BUFFER_FREE = 0,     // Buffer not owned by any thread
+    LINC_THREAD_BUFFER_ACTIVE = 1,   // Buffer owned by a running thread
+    LINC_THREAD_BUFFER_RETIRED = 2,  // Owner thread exited, buffer is freed once drained by the worker
+};
+
+struct linc_thread_buffer {
+    struct linc_ring_buffer ring;                                              // Single-producer ring buffer of the thread
+    LINC_CACHE_ALIGNED unsigned char bytes[LINC_DEFAULT_THREAD_BUFFER_BYTES];  // Storage of the ring buffer
+    int state;                                                                 // State of the buffer (enum linc_thread_buffer_state)
+    LINC_CACHE_ALIGNED bool pending;                                           // Owner thread is producing a log right now
+};
+
+struct linc_thread_buffer_list {
+    struct linc_thread_buffer list[LINC_DEFAULT_MAX_THREAD_BUFFERS];  // Per-thread buffers
+    size_t count;                                                     // High-water mark of buffers ever claimed
+    pthread_key_t key;                                                // Key whose destructor retires the buffer
+};
+
+enum linc_dispatch_text_state {
+    LINC_DISPATCH_TEXT_EMPTY = 0,      // Text not rendered yet
+    LINC_DISPATCH_TEXT_RENDERING = 1,  // Text being rendered by the first sink that asked for it
+    LINC_DISPATCH_TEXT_READY = 2,      // Text rendered and shared by every sink
+    LINC_DISPATCH_TEXT_FAILED = 3,     // Record could not be rendered with the layout
+};
+
+struct linc_dispatch_text {
+    size_t length;                                                                      // Length of the rendered text
+    char text[LINC_LOG_MAX_LENGTH + LINC_NEWLINE_CHAR_LENGTH + LINC_ZERO_CHAR_LENGTH];  // Rendered text
+};
+
+// Line of a record printed by the crash handler or linc-recover, see linc_recovery_format.
+struct linc_recovery_line {
+    char text[LINC_LOG_MAX_LENGTH + LINC_NEWLINE_CHAR_LENGTH];  // Line being formatted, not zero terminated
+    size_t length;                                              // Bytes of the line
+};
+
+struct linc_dispatch {
+    struct linc_metadata slots[LINC_DEFAULT_DISPATCH_SIZE];  // Records decoded by the worker, read by every sink
+    // Texts of each slot rendered with the shared layouts, and their state (enum linc_dispatch_text_state)
+    struct linc_dispatch_text texts[LINC_DEFAULT_DISPATCH_SIZE][LINC_DEFAULT_SHARED_LAYOUTS];
+    int states[LINC_DEFAULT_DISPATCH_SIZE][LINC_DEFAULT_SHARED_LAYOUTS];
+    linc_layout layouts[LINC_DEFAULT_SHARED_LAYOUTS];        // Layouts whose texts are shared, assigned on first use
+    LINC_CACHE_ALIGNED size_t published;                     // Number of records published by the worker
+    bool shutdown;                                           // Worker has published its last record
+    struct linc_signal produce;                              // Worker sleeping on the slowest sink
+    struct linc_signal consume;                              // Sinks sleeping on new records
+};
+
+struct linc_clock_state {
+    int source;                                // Clock read by producers (enum linc_clock)
+    LINC_CACHE_ALIGNED unsigned int sequence;  // Sequence lock of the conversion, odd while it is updated
+    int64_t offset[LINC_CLOCK_COARSE + 1];     // Realtime minus clock in nanoseconds, for each POSIX clock
+    int64_t tsc_base;                          // TSC ticks at the last resync
+    int64_t tsc_realtime;                      // Realtime in nanoseconds at the last resync
+    int64_t tsc_mult;                          // Nanoseconds per tick in units of LINC_CLOCK_TSC_UNIT
+    int64_t calibration_ticks;                 // TSC ticks of the first sample, zero if not calibrated
+    int64_t calibration_ns;                    // Raw monotonic time of the first sample
+    int64_t resync_at;                         // Monotonic time of the next resync, owned by the worker
+    size_t records;                            // Records decoded since the last resync check, owned by the worker
+    pthread_mutex_t mutex;                     // Serializes calibrations and resyncs
 };
 
 struct linc {
-    struct linc_module_list modules;      // List of registered modules
-    struct linc_sink_list sinks;          // List of registered sinks
-    struct linc_ring_buffer ring_buffer;  // Ring buffer for log messages
-    struct linc_task_sync task_sync;      // Synchronization for sinking tasks
+    struct linc_module_list modules;                                              // List of registered modules
+    struct linc_sink_list sinks;                                                  // List of registered sinks
+    struct linc_layout_list layouts;                                              // Built-in and compiled layouts
+    struct linc_ring_buffer ring_buffer;                                          // Ring buffer for log messages
+    LINC_CACHE_ALIGNED unsigned char ring_bytes[LINC_DEFAULT_RING_BUFFER_BYTES];  // Storage of the ring buffer
+    struct linc_thread_buffer_list thread_buffers;                                // Per-thread buffers for log messages
+    struct linc_thread_list threads;                                              // Identity of the threads that logged
+    int pipeline;                                                                 // Pipeline used by producers (enum linc_pipeline)
+    int formatting;                                                               // Formatting of messages (enum linc_formatting)
+    struct linc_clock_state clock;                                                // Clock read by producers and its conversion
+    struct linc_signal worker_signal;                                             // Worker sleeping on empty buffers
+    LINC_CACHE_ALIGNED bool eviction_requested;                                   // Some buffer has a pending eviction
+    struct linc_dispatch dispatch;                                                // Records handed from the worker to the sinks
+    pthread_t worker;                                                             // Worker thread handle
 };
 
 extern struct linc linc;
@@ -90,15 +196,85 @@ extern struct linc linc;
 // ==================================================
 
 void linc_init(void);
-void linc_timestamp_offset(void);
 
-int linc_ring_buffer_enqueue(struct linc_metadata *metadata);
+void linc_clock_init(void);
+int64_t linc_clock_ticks(uint8_t *flags);
+int64_t linc_clock_nanoseconds(int64_t ticks, uint8_t flags);
+int64_t linc_clock_nanoseconds_bounded(int64_t ticks, uint8_t flags);
+void linc_clock_resync(bool is_idle);
+
+int linc_state_pack(enum linc_level level, bool enabled);
+bool linc_state_accepts(const int *state, enum linc_level level);
+void linc_state_set_level(int *state, enum linc_level level);
+void linc_state_set_enabled(int *state, bool enabled);
+
+void linc_signal_init(struct linc_signal *signal);
+void linc_signal_destroy(struct linc_signal *signal);
+void linc_signal_wake(struct linc_signal *signal);
+void linc_signal_wait(struct linc_signal *signal, bool (*is_ready)(void *arg), void *arg);
+bool linc_signal_wait_until(struct linc_signal *signal,
+                            bool (*is_ready)(void *arg),
+                            void *arg,
+                            const struct timespec *deadline);
+void linc_deadline(struct timespec *deadline, uint64_t timeout_us);
+
+size_t linc_record_size(size_t message_length);
+void linc_record_encode(struct linc_record *record,
+                        const struct linc_metadata *metadata,
+                        size_t message_length,
+                        uint8_t flags);
+void linc_record_decode(const struct linc_record *record, struct linc_metadata *metadata);
+uintptr_t linc_record_thread_id(const struct linc_record *record);
+
+void linc_ring_buffer_init(struct linc_ring_buffer *ring,
+                           unsigned char *bytes,
+                           size_t size,
+                           bool single_producer,
+                           struct linc_signal *consume);
+void linc_ring_buffer_destroy(struct linc_ring_buffer *ring);
+void linc_ring_buffer_shutdown(struct linc_ring_buffer *ring);
+struct linc_record *linc_ring_buffer_reserve(struct linc_ring_buffer *ring,
+                                             size_t size,
+                                             enum linc_backpressure backpressure,
+                                             uint32_t timeout_us);
+void linc_ring_buffer_commit(struct linc_ring_buffer *ring, struct linc_record *record, size_t size);
+struct linc_record *linc_ring_buffer_peek(struct linc_ring_buffer *ring);
+void linc_ring_buffer_release(struct linc_ring_buffer *ring);
+bool linc_ring_buffer_is_empty(struct linc_ring_buffer *ring);
+bool linc_ring_buffer_is_drained(struct linc_ring_buffer *ring);
+int linc_ring_buffer_push(struct linc_ring_buffer *ring,
+                          const struct linc_metadata *metadata,
+                          size_t message_length,
+                          uint8_t flags,
+                          enum linc_backpressure backpressure,
+                          uint32_t timeout_us);
+int linc_ring_buffer_pop(struct linc_ring_buffer *ring, struct linc_metadata *metadata);
+
+int linc_ring_buffer_enqueue(struct linc_metadata *metadata,
+                             size_t message_length,
+                             uint8_t flags,
+                             enum linc_backpressure backpressure,
+                             uint32_t timeout_us);
+void linc_ring_buffer_evict(struct linc_ring_buffer *ring, void (*drop)(struct linc_record *record));
 int linc_ring_buffer_dequeue(struct linc_metadata *metadata);
 
-void linc_task_sync_wait_tasks(void);
-void linc_task_sync_wait_worker(void);
-void linc_task_sync_signal_tasks(void);
-void linc_task_sync_signal_worker(void);
+int linc_format_capture(char *payload, size_t size, const char *format, va_list args);
+int linc_format_render(const char *payload, char *buffer, size_t size);
+
+struct linc_thread_buffer *linc_thread_buffer_acquire(void);
+void linc_thread_buffer_begin(struct linc_thread_buffer *buffer);
+void linc_thread_buffer_end(struct linc_thread_buffer *buffer);
+
+bool linc_dispatch_has_space(void *arg);
+bool linc_dispatch_is_drained(void);
+bool linc_dispatch_is_past(size_t position);
+struct linc_metadata *linc_dispatch_claim(void);
+void linc_dispatch_publish(void);
+void linc_dispatch_shutdown(void);
+size_t linc_dispatch_wait(size_t cursor);
+size_t linc_dispatch_wait_until(size_t cursor, const struct timespec *deadline);
+size_t linc_dispatch_wait_batch(size_t cursor, size_t count, uint32_t latency_us);
+void linc_dispatch_advance(struct linc_sink *sink, size_t cursor);
 
 void *linc_worker(void *arg);
 void *linc_task(void *arg);
@@ -110,6 +286,5 @@ void *linc_task(void *arg);
 // int64_t linc_timestamp(void);
 // int linc_timestamp_string(int64_t timestamp, char *buffer, size_t size);
 // const char *linc_level_string(enum linc_level level);
-// int linc_stringify_metadata(struct linc_metadata *metadata, char *buffer, size_t length, bool use_colors);
 
 #endif  // LINC_INCLUDE_INTERNAL_SHARED_H
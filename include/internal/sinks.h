@@ -1,9 +1,45 @@
 #ifndef LINC_INCLUDE_INTERNAL_SINKS_H
 #define LINC_INCLUDE_INTERNAL_SINKS_H
 
+#include "internal/atomics.h"
+#include "internal/binary.h"
+#include "internal/uring.h"
 #include "linc.h"
 
 #include <pthread.h>
+#include <stddef.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+// ==================================================
+// Macros
+// ==================================================
+
+#define LINC_SINK_STREAM_BUFFER_LENGTH 65536  // Size of the buffer stream sinks gather the texts of a batch into
+#define LINC_SINK_STREAM_IOVECS 64            // Maximum number of pieces of a batch written by one writev
+#define LINC_SINK_FILE_ALIGNMENT 4096         // Alignment of the buffers of file sinks, the size of a memory page
+#define LINC_SINK_FILE_PATH_LENGTH 1024       // Maximum length of the path of a file sink
+#define LINC_SINK_FILE_SLICES 4               // Slices of the buffer of an asynchronous file sink, written in turn
+#define LINC_SINK_ROTATION_JOBS 16            // Rotated files waiting for the rotation helper
+#define LINC_SINK_ROTATION_NICE 19            // Nice value of the rotation helper thread and of its compressions
+#define LINC_SINK_HTTP_HOST_LENGTH 255        // Maximum length of the host of an HTTP sink
+#define LINC_SINK_HTTP_PORT_LENGTH 31         // Maximum length of the port or service of an HTTP sink
+#define LINC_SINK_HTTP_PATH_LENGTH 1024       // Maximum length of the path of an HTTP sink
+#define LINC_SINK_HTTP_MIN_BATCH_BYTES 4096   // Smallest body size of an HTTP sink
+#define LINC_SINK_HTTP_HEADER_LENGTH 1536     // Room for the request line and headers, written right before the body
+#define LINC_SINK_HTTP_RESPONSE_LENGTH 4096   // Maximum length of the status line and headers of a response
+#define LINC_SINK_HTTP_TIMEOUT_MS 1000        // Time to connect, or for the server to make progress, before giving up
+#define LINC_SINK_HTTP_MIN_BACKOFF_MS 100     // Time between the first two connection attempts after a failure
+#define LINC_SINK_SYSLOG_MIN_DATAGRAM 480     // Smallest datagram every syslog receiver accepts
+#define LINC_SINK_SYSLOG_MAX_DATAGRAM 65507   // Largest UDP datagram over IPv4
+#define LINC_SINK_SYSLOG_DATAGRAMS 256        // Maximum number of datagrams sent by one sendmmsg
+#define LINC_SINK_SYSLOG_HOSTNAME_LENGTH 255  // Maximum length of the HOSTNAME field
+#define LINC_SINK_SYSLOG_APP_NAME_LENGTH 48   // Maximum length of the APP-NAME field
+#define LINC_SINK_SYSLOG_MSGID_LENGTH 32      // Maximum length of the MSGID field, the module name
+#define LINC_SINK_SYSLOG_TIMEOUT_MS 1000      // Time a full socket may block the sink thread before a send fails
+
+#define LINC_SINK_FILE_ALIGNED __attribute__((aligned(LINC_SINK_FILE_ALIGNMENT)))  // Places a buffer on its own pages
 
 // ==================================================
 // Structures and Enums
@@ -11,11 +47,173 @@
 
 struct linc_sink {
     char name[LINC_DEFAULT_SINK_NAME_LENGTH + LINC_ZERO_CHAR_LENGTH];  // Sink name
-    enum linc_level level;                                             // Minimum log level for this sink
-    bool enabled;                                                      // Is sink enabled
+    int state;                                                         // Minimum level and enabled flag (packed)
     struct linc_sink_funcs funcs;                                      // Function pointers for sink operations
     pthread_t thread_id;                                               // Thread ID for async operations
-    pthread_rwlock_t lock;                                             // Lock for thread safety
+    size_t batch_size;                                                 // Maximum number of records in a batch
+    uint32_t batch_latency;                                            // Time in microseconds to wait for a full batch
+    LINC_CACHE_ALIGNED size_t cursor;                                  // Sequence of the next record read by the sink
+};
+
+struct linc_sink_stream {
+    int fd;                                        // File descriptor written to
+    linc_layout layout;                            // Layout of the lines, colored on terminals
+    struct iovec iovecs[LINC_SINK_STREAM_IOVECS];  // Pieces of the batch written by the next writev
+    int count;                                     // Number of pieces
+    char buffer[LINC_SINK_STREAM_BUFFER_LENGTH];   // Copies of the texts that are not shared by the dispatch ring
+    size_t used;                                   // Bytes used in the buffer
+    bool is_open;                                  // Registered as a sink, a stream is written by one sink only
+};
+
+struct linc_sink_binary {
+    struct linc_binary_writer writer;        // Identifiers of the current segment
+    char record[LINC_BINARY_RECORD_LENGTH];  // Encoded log being written
+};
+
+#if LINC_DEFAULT_MAX_FILE_SINKS > 0
+struct linc_sink_binary_list {
+    struct linc_sink_binary list[LINC_DEFAULT_MAX_FILE_SINKS];  // Encoders of binary sinks, indexed like file sinks
+};
+#endif
+
+struct linc_sink_file_slice {
+    bool is_pending;  // Slice was submitted and its completion was not reaped yet
+    off_t offset;     // Offset of the write in the file
+    size_t length;    // Bytes of the write
+};
+
+struct linc_sink_file {
+    LINC_SINK_FILE_ALIGNED char buffer[LINC_DEFAULT_FILE_BUFFER_BYTES];  // Lines not written yet
+    int fd;                                                              // File descriptor of the current file
+    linc_layout layout;                                                  // Layout of the lines
+    struct linc_sink_binary *binary;                                     // Encoder of the logs, NULL for text lines
+    size_t length;                                                       // Size of the buffer used by the sink
+    size_t used;                                                         // Bytes used in the buffer
+    char path[LINC_SINK_FILE_PATH_LENGTH + LINC_ZERO_CHAR_LENGTH];       // Path of the file
+    size_t size;                                                         // Bytes in the current file
+    size_t max_size;                                                     // Size that starts a new file, 0 if never
+    uint32_t interval;                                                   // Seconds between new files, 0 if never
+    int64_t rotate_at;                                                   // Monotonic second of the next new file
+    unsigned int max_files;                                              // Rotated files kept, 0 if all
+    bool is_async;                                                       // Writes go through io_uring if available
+    bool is_rotating;                                                    // Rotated files are handed to the helper
+    bool is_compressed;                                                  // Rotated files are compressed with gzip
+    unsigned long sequence;                                              // Sequence number of the next rotated file
+    struct linc_uring uring;                                             // Ring of asynchronous writes, fd -1 if none
+    off_t offset;                                                        // Offset of the next asynchronous write
+    size_t slice;                                                        // Slice of the buffer being filled
+    struct linc_sink_file_slice slices[LINC_SINK_FILE_SLICES];           // Writes of the slices
+    bool is_used;                                                        // Slot claimed by linc_sink_file_funcs
+    bool is_open;                                                        // File opened by a registered sink
+};
+
+#if LINC_DEFAULT_MAX_FILE_SINKS > 0
+struct linc_sink_file_list {
+    struct linc_sink_file list[LINC_DEFAULT_MAX_FILE_SINKS];  // File sinks, a slot is reused once its sink closed
+    pthread_mutex_t mutex;                                    // Mutex for thread safety
+};
+#endif
+
+struct linc_sink_mmap {
+    int fd;                                                         // File descriptor of the file
+    linc_layout layout;                                             // Layout of the lines
+    char *mapping;                                                  // Segment mapped in memory, NULL if mapping failed
+    size_t segment;                                                 // Size of the segments, a multiple of the page size
+    off_t base;                                                     // Offset of the mapped segment in the file
+    size_t used;                                                    // Bytes written in the mapped segment
+    char path[LINC_SINK_FILE_PATH_LENGTH + LINC_ZERO_CHAR_LENGTH];  // Path of the file
+    dev_t device;                                                   // Device of the file, while it is open
+    ino_t inode;                                                    // Inode of the file, while it is open
+    bool is_used;                                                   // Slot claimed by linc_sink_mmap_funcs
+    bool is_open;                                                   // File mapped by a registered sink
+};
+
+#if LINC_DEFAULT_MAX_FILE_SINKS > 0
+struct linc_sink_mmap_list {
+    struct linc_sink_mmap list[LINC_DEFAULT_MAX_FILE_SINKS];  // Memory-mapped sinks, a slot is reused once closed
+    pthread_mutex_t mutex;                                    // Mutex for thread safety
+};
+#endif
+
+struct linc_sink_http_request {
+    char bytes[LINC_SINK_HTTP_HEADER_LENGTH + LINC_DEFAULT_HTTP_BATCH_BYTES];  // Headers, then the body
+    size_t start;                                                              // Offset of the request line
+    size_t length;                                                             // Bytes of the whole request
+};
+
+struct linc_sink_http {
+    struct linc_sink_http_request requests[LINC_DEFAULT_HTTP_PIPELINE];  // Body being filled and unanswered requests
+    char host[LINC_SINK_HTTP_HOST_LENGTH + LINC_ZERO_CHAR_LENGTH];       // Host of the server
+    char port[LINC_SINK_HTTP_PORT_LENGTH + LINC_ZERO_CHAR_LENGTH];       // Port or service of the server
+    char path[LINC_SINK_HTTP_PATH_LENGTH + LINC_ZERO_CHAR_LENGTH];       // Path of the requests
+    bool is_ndjson;                                                      // Bodies are JSON lines, not arrays
+    size_t batch_size;                                                   // Size of the bodies used by the sink
+    size_t pipeline;                                                     // Requests used by the sink
+    int fd;                                                              // Socket, -1 while not connected
+    size_t used;                                                         // Bytes of the body being filled
+    size_t count;                                                        // Logs in the body being filled
+    size_t queued;                                                       // Requests completed since the start
+    size_t sent;                                                         // Requests sent on the connection
+    size_t sent_bytes;                                                   // Bytes sent of the next request
+    size_t answered;                                                     // Requests answered or dropped
+    char response[LINC_SINK_HTTP_RESPONSE_LENGTH];                       // Response bytes not parsed yet
+    size_t response_used;                                                // Bytes in the response buffer
+    size_t skip;                                                         // Bytes of a response body left to skip
+    int64_t retry_at;                                                    // Monotonic millisecond of the next attempt
+    uint32_t backoff;                                                    // Milliseconds to wait after a failure
+    bool is_used;                                                        // Slot claimed by linc_sink_http_funcs
+    bool is_open;                                                        // Opened by a registered sink
+};
+
+#if LINC_DEFAULT_MAX_NETWORK_SINKS > 0
+struct linc_sink_http_list {
+    struct linc_sink_http list[LINC_DEFAULT_MAX_NETWORK_SINKS];  // HTTP sinks, a slot is reused once its sink closed
+    pthread_mutex_t mutex;                                       // Mutex for thread safety
+};
+#endif
+
+struct linc_sink_syslog {
+    char buffer[LINC_DEFAULT_SYSLOG_BUFFER_BYTES];                            // Datagrams waiting to be sent
+    struct iovec datagrams[LINC_SINK_SYSLOG_DATAGRAMS];                       // Datagrams in the buffer
+    size_t count;                                                             // Number of datagrams in the buffer
+    size_t used;                                                              // Bytes used of the buffer
+    int fd;                                                                   // Connected datagram socket
+    struct sockaddr_storage address;                                          // Address of the receiver
+    socklen_t address_length;                                                 // Length of the address
+    size_t max_datagram;                                                      // Size of the largest datagram
+    unsigned int facility;                                                    // Facility of the logs
+    linc_layout layout;                                                       // Layout of the MSG part, or NULL
+    char hostname[LINC_SINK_SYSLOG_HOSTNAME_LENGTH + LINC_ZERO_CHAR_LENGTH];  // HOSTNAME field
+    char app_name[LINC_SINK_SYSLOG_APP_NAME_LENGTH + LINC_ZERO_CHAR_LENGTH];  // APP-NAME field
+    long pid;                                                                 // PROCID field
+    bool is_used;                                                             // Slot claimed by linc_sink_syslog_funcs
+    bool is_open;                                                             // Connected by a registered sink
+};
+
+#if LINC_DEFAULT_MAX_NETWORK_SINKS > 0
+struct linc_sink_syslog_list {
+    struct linc_sink_syslog list[LINC_DEFAULT_MAX_NETWORK_SINKS];  // Syslog sinks, a slot is reused once closed
+    pthread_mutex_t mutex;                                         // Mutex for thread safety
+};
+#endif
+
+struct linc_sink_rotation_job {
+    int fd;                       // Descriptor of the rotated file, closed by the helper
+    struct linc_sink_file *file;  // Sink that rotated the file
+    unsigned long sequence;       // Sequence number of the rotated file
+};
+
+struct linc_sink_rotation_queue {
+    struct linc_sink_rotation_job jobs[LINC_SINK_ROTATION_JOBS];  // Rotated files, in order of rotation
+    size_t head;                                                  // Number of jobs pushed by the sinks
+    size_t tail;                                                  // Number of jobs taken by the helper
+    size_t done;                                                  // Number of jobs finished by the helper
+    size_t users;                                                 // Rotating sinks that hand files over to the helper
+    bool is_started;                                              // Helper thread is running
+    bool is_stopping;                                             // Helper thread exits once the queue is empty
+    pthread_t thread;                                             // Helper thread, joined by the last sink to close
+    pthread_mutex_t mutex;                                        // Mutex for thread safety
+    pthread_cond_t cond;                                          // Condition of new jobs, finished jobs and stops
 };
 
 struct linc_sink_list {
@@ -34,8 +232,23 @@ struct linc_sink *linc_register_default_sink(struct linc_sink_list *sinks);
 // Public Functions (linc.h)
 // ==================================================
 
+// struct linc_sink_funcs linc_sink_stdout_funcs(void);
+// struct linc_sink_funcs linc_sink_file_funcs(const char *path, const struct linc_sink_file_options *options);
+// struct linc_sink_funcs linc_sink_rotating_funcs(const char *path,
+//                                                 const struct linc_sink_file_options *options,
+//                                                 const struct linc_sink_rotation_options *rotation);
+// struct linc_sink_funcs linc_sink_mmap_funcs(const char *path, const struct linc_sink_mmap_options *options);
+// struct linc_sink_funcs linc_sink_binary_funcs(const char *path, const struct linc_sink_file_options *options);
+// struct linc_sink_funcs linc_sink_http_funcs(const char *host,
+//                                             const char *port,
+//                                             const struct linc_sink_http_options *options);
+// struct linc_sink_funcs linc_sink_syslog_funcs(const char *address,
+//                                               const char *port,
+//                                               const struct linc_sink_syslog_options *options);
 // linc_sink linc_register_sink(const char *name, enum linc_level level, bool enabled, struct linc_sink_funcs funcs);
+// void linc_release_sink_funcs(struct linc_sink_funcs funcs);
 // int linc_set_sink_level(linc_sink sink, enum linc_level level);
 // int linc_set_sink_enabled(linc_sink sink, bool enabled);
+// int linc_set_sink_batch(linc_sink sink, size_t size, uint32_t latency_us);
 
 #endif  // LINC_INCLUDE_INTERNAL_SINKS_H
@@ -0,0 +1,59 @@
+#ifndef LINC_INCLUDE_INTERNAL_THREADS_H
+#define LINC_INCLUDE_INTERNAL_THREADS_H
+
+#include "internal/atomics.h"
+#include "linc.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// ==================================================
+// Structures and Enums
+// ==================================================
+
+#define LINC_THREAD_ID_TEXT_LENGTH (sizeof(uintptr_t) * 2 > 16 ? sizeof(uintptr_t) * 2 : 16)  // Thread ID digits
+#define LINC_THREAD_TID_TEXT_LENGTH 20                                                        // Kernel thread ID digits
+
+enum linc_thread_state {
+    LINC_THREAD_FREE = 0,        // Entry not owned by any thread
+    LINC_THREAD_ACTIVE = 1,      // Entry owned by a running thread
+    LINC_THREAD_RETIRED = 2,     // Owner thread exited or renamed itself, entry is freed once its records are written
+    LINC_THREAD_COLLECTING = 3,  // Retired entry whose records are dispatched, freed once the sinks wrote them
+};
+
+struct linc_thread {
+    int state;                                                           // State of the entry (enum linc_thread_state)
+    uintptr_t id;                                                        // POSIX thread ID
+    long tid;                                                            // Kernel thread ID, as shown by top -H or perf
+    size_t tid_length;                                                   // Length of the kernel thread ID text
+    size_t name_length;                                                  // Length of the thread name
+    char id_text[LINC_THREAD_ID_TEXT_LENGTH];                            // Thread ID in hexadecimal, rendered once
+    char tid_text[LINC_THREAD_TID_TEXT_LENGTH];                          // Kernel thread ID in decimal, rendered once
+    char name[LINC_DEFAULT_THREAD_NAME_LENGTH + LINC_ZERO_CHAR_LENGTH];  // Thread name
+};
+
+struct linc_thread_list {
+    struct linc_thread list[LINC_DEFAULT_MAX_THREADS];  // Threads that logged, indexed from 1 by the records
+    pthread_key_t key;                                  // Key whose destructor retires the entry
+    size_t epoch;                                       // Incremented each time the worker frees retired entries
+    size_t collect_position;                            // Dispatch position the sinks pass before entries are freed
+    bool is_collecting;                                 // Some entries wait for the sinks to pass the position
+};
+
+// ==================================================
+// Internal Functions
+// ==================================================
+
+void linc_threads_init(void);
+uint32_t linc_thread_current(void);
+const struct linc_thread *linc_thread_of(uint32_t thread);
+void linc_thread_collect(bool (*is_empty)(void));
+
+// ==================================================
+// Public Functions (linc.h)
+// ==================================================
+
+// int linc_set_thread_name(const char *name);
+
+#endif  // LINC_INCLUDE_INTERNAL_THREADS_H
@@ -0,0 +1,41 @@
+#ifndef LINC_INCLUDE_INTERNAL_URING_H
+#define LINC_INCLUDE_INTERNAL_URING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+// ==================================================
+// Structures and Enums
+// ==================================================
+
+struct linc_uring {
+    int fd;                  // Descriptor of the io_uring instance, -1 if io_uring is not available
+    unsigned int entries;    // Number of submission queue entries
+    unsigned int *sq_head;   // Head of the submission queue, moved by the kernel
+    unsigned int *sq_tail;   // Tail of the submission queue, moved by the sink thread
+    unsigned int *sq_mask;   // Mask of the indexes of the submission queue
+    unsigned int *sq_array;  // Indexes of the submission queue entries
+    void *sqes;              // Submission queue entries
+    unsigned int *cq_head;   // Head of the completion queue, moved by the sink thread
+    unsigned int *cq_tail;   // Tail of the completion queue, moved by the kernel
+    unsigned int *cq_mask;   // Mask of the indexes of the completion queue
+    void *cqes;              // Completion queue entries
+    void *sq_ring;           // Mapping of the submission queue
+    size_t sq_ring_size;     // Size of the mapping of the submission queue
+    void *cq_ring;           // Mapping of the completion queue, the same as the submission queue on recent kernels
+    size_t cq_ring_size;     // Size of the mapping of the completion queue
+    size_t sqes_size;        // Size of the mapping of the submission queue entries
+};
+
+// ==================================================
+// Internal Functions
+// ==================================================
+
+int linc_uring_init(struct linc_uring *ring, unsigned int entries);
+void linc_uring_exit(struct linc_uring *ring);
+int linc_uring_write(struct linc_uring *ring, int fd, const void *buffer, size_t length, off_t offset, uint64_t tag);
+int linc_uring_reap(struct linc_uring *ring, bool is_waiting, uint64_t *tag, int *result);
+
+#endif  // LINC_INCLUDE_INTERNAL_URING_H
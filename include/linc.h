@@ -22,6 +22,14 @@
 #error "LINC_DEFAULT_LEVEL must be between LINC_LEVEL_TRACE and LINC_LEVEL_FATAL"
 #endif
 
+#define LINC_STATE_DISABLED 0x08  // Added to the packed level of disabled modules and sinks, above every level
+
+#if !defined(LINC_COMPILE_LEVEL)
+#define LINC_COMPILE_LEVEL LINC_LEVEL_TRACE  // Logs below this level are removed at compile time
+#elif (LINC_COMPILE_LEVEL < 0) || (LINC_COMPILE_LEVEL > 6)  // LINC_LEVEL_TRACE and LINC_LEVEL_FATAL + 1
+#error "LINC_COMPILE_LEVEL must be between LINC_LEVEL_TRACE and LINC_LEVEL_FATAL + 1"
+#endif
+
 #if !defined(LINC_DEFAULT_MODULE_NAME_LENGTH)
 #define LINC_DEFAULT_MODULE_NAME_LENGTH 16  // Maximum length for module names
 #elif (LINC_DEFAULT_MODULE_NAME_LENGTH < 1)
@@ -64,10 +72,199 @@
 #error "LINC_DEFAULT_MAX_MESSAGE_LENGTH must be at least 1"
 #endif
 
-#if !defined(LINC_DEFAULT_RING_BUFFER_SIZE)
-#define LINC_DEFAULT_RING_BUFFER_SIZE 1024  // Default size for the ring buffer
-#elif (LINC_DEFAULT_RING_BUFFER_SIZE < 1)
-#error "LINC_DEFAULT_RING_BUFFER_SIZE must be at least 1"
+#if defined(LINC_DEFAULT_RING_BUFFER_SIZE)
+#error "LINC_DEFAULT_RING_BUFFER_SIZE has been replaced by LINC_DEFAULT_RING_BUFFER_BYTES"
+#endif
+
+#if !defined(LINC_DEFAULT_RING_BUFFER_BYTES)
+#define LINC_DEFAULT_RING_BUFFER_BYTES 524288  // Default size in bytes for the ring buffer
+#elif (LINC_DEFAULT_RING_BUFFER_BYTES % 8 != 0)
+#error "LINC_DEFAULT_RING_BUFFER_BYTES must be a multiple of 8"
+#elif (LINC_DEFAULT_RING_BUFFER_BYTES < 2 * (LINC_DEFAULT_MAX_MESSAGE_LENGTH + 128))
+#error "LINC_DEFAULT_RING_BUFFER_BYTES must hold at least two messages of LINC_DEFAULT_MAX_MESSAGE_LENGTH"
+#endif
+
+#if !defined(LINC_DEFAULT_DISPATCH_SIZE)
+#define LINC_DEFAULT_DISPATCH_SIZE 256  // Number of decoded records sinks may lag behind the worker
+#elif (LINC_DEFAULT_DISPATCH_SIZE < 1)
+#error "LINC_DEFAULT_DISPATCH_SIZE must be at least 1"
+#endif
+
+#if !defined(LINC_DEFAULT_BATCH_SIZE)
+#define LINC_DEFAULT_BATCH_SIZE 64  // Maximum number of records passed to write_batch at once
+#elif (LINC_DEFAULT_BATCH_SIZE < 1 || LINC_DEFAULT_BATCH_SIZE > LINC_DEFAULT_DISPATCH_SIZE)
+#error "LINC_DEFAULT_BATCH_SIZE must be between 1 and LINC_DEFAULT_DISPATCH_SIZE"
+#endif
+
+#if !defined(LINC_DEFAULT_BATCH_LATENCY_US)
+#define LINC_DEFAULT_BATCH_LATENCY_US 0  // Time in microseconds a sink waits for a partial batch to fill
+#endif
+
+#if !defined(LINC_DEFAULT_STREAM_LATENCY_US)
+#define LINC_DEFAULT_STREAM_LATENCY_US 1000  // Time in microseconds the default sink waits for a batch off terminals
+#endif
+
+#if !defined(LINC_DEFAULT_MAX_FILE_SINKS)
+#define LINC_DEFAULT_MAX_FILE_SINKS 4  // Maximum number of file sinks, and of memory-mapped sinks, 0 compiles them out
+#elif (LINC_DEFAULT_MAX_FILE_SINKS < 0)
+#error "LINC_DEFAULT_MAX_FILE_SINKS must be at least 0"
+#endif
+
+#if !defined(LINC_DEFAULT_FILE_BUFFER_BYTES)
+#define LINC_DEFAULT_FILE_BUFFER_BYTES 65536  // Default and maximum size in bytes for the buffer of a file sink
+#elif (LINC_DEFAULT_FILE_BUFFER_BYTES < 1)
+#error "LINC_DEFAULT_FILE_BUFFER_BYTES must be at least 1"
+#endif
+
+#if !defined(LINC_DEFAULT_FILE_FLUSH_DELAY_US)
+#define LINC_DEFAULT_FILE_FLUSH_DELAY_US 100000  // Time in microseconds a file sink may keep logs in its buffer
+#elif (LINC_DEFAULT_FILE_FLUSH_DELAY_US < 1)
+#error "LINC_DEFAULT_FILE_FLUSH_DELAY_US must be at least 1"
+#endif
+
+#if !defined(LINC_DEFAULT_MMAP_SEGMENT_BYTES)
+#define LINC_DEFAULT_MMAP_SEGMENT_BYTES 4194304  // Default size in bytes for the segments mapped by memory-mapped sinks
+#elif (LINC_DEFAULT_MMAP_SEGMENT_BYTES < 1)
+#error "LINC_DEFAULT_MMAP_SEGMENT_BYTES must be at least 1"
+#endif
+
+#if !defined(LINC_DEFAULT_MAX_NETWORK_SINKS)
+#define LINC_DEFAULT_MAX_NETWORK_SINKS 4  // Maximum number of HTTP sinks, and of syslog sinks, 0 compiles them out
+#elif (LINC_DEFAULT_MAX_NETWORK_SINKS < 0)
+#error "LINC_DEFAULT_MAX_NETWORK_SINKS must be at least 0"
+#endif
+
+#if !defined(LINC_DEFAULT_HTTP_BATCH_BYTES)
+#define LINC_DEFAULT_HTTP_BATCH_BYTES 16384  // Default and maximum size in bytes for the body of an HTTP request
+#elif (LINC_DEFAULT_HTTP_BATCH_BYTES < 4096)
+#error "LINC_DEFAULT_HTTP_BATCH_BYTES must be at least 4096"
+#endif
+
+#if !defined(LINC_DEFAULT_HTTP_FLUSH_DELAY_US)
+#define LINC_DEFAULT_HTTP_FLUSH_DELAY_US 100000  // Time in microseconds an HTTP sink may keep logs before sending them
+#elif (LINC_DEFAULT_HTTP_FLUSH_DELAY_US < 1)
+#error "LINC_DEFAULT_HTTP_FLUSH_DELAY_US must be at least 1"
+#endif
+
+#if !defined(LINC_DEFAULT_HTTP_PIPELINE)
+#define LINC_DEFAULT_HTTP_PIPELINE 4  // Default and maximum number of HTTP requests sent before their responses
+#elif (LINC_DEFAULT_HTTP_PIPELINE < 1)
+#error "LINC_DEFAULT_HTTP_PIPELINE must be at least 1"
+#endif
+
+#if !defined(LINC_DEFAULT_HTTP_MAX_BACKOFF_MS)
+#define LINC_DEFAULT_HTTP_MAX_BACKOFF_MS 30000  // Longest time in milliseconds between two connection attempts
+#elif (LINC_DEFAULT_HTTP_MAX_BACKOFF_MS < 100)
+#error "LINC_DEFAULT_HTTP_MAX_BACKOFF_MS must be at least 100"
+#endif
+
+#if !defined(LINC_DEFAULT_SYSLOG_DATAGRAM_BYTES)
+#define LINC_DEFAULT_SYSLOG_DATAGRAM_BYTES 2048  // Default size in bytes of the largest syslog datagram
+#elif (LINC_DEFAULT_SYSLOG_DATAGRAM_BYTES < 480) || (LINC_DEFAULT_SYSLOG_DATAGRAM_BYTES > 65507)
+#error "LINC_DEFAULT_SYSLOG_DATAGRAM_BYTES must be between 480 and 65507"
+#endif
+
+#if !defined(LINC_DEFAULT_SYSLOG_BUFFER_BYTES)
+#define LINC_DEFAULT_SYSLOG_BUFFER_BYTES 32768  // Size in bytes of the buffer a syslog sink frames its datagrams into
+#endif
+#if (LINC_DEFAULT_SYSLOG_BUFFER_BYTES < LINC_DEFAULT_SYSLOG_DATAGRAM_BYTES)
+#error "LINC_DEFAULT_SYSLOG_BUFFER_BYTES must be at least LINC_DEFAULT_SYSLOG_DATAGRAM_BYTES"
+#endif
+
+#if !defined(LINC_DEFAULT_SYSLOG_FLUSH_DELAY_US)
+#define LINC_DEFAULT_SYSLOG_FLUSH_DELAY_US 10000  // Time in microseconds a syslog sink may keep logs before sending
+#elif (LINC_DEFAULT_SYSLOG_FLUSH_DELAY_US < 1)
+#error "LINC_DEFAULT_SYSLOG_FLUSH_DELAY_US must be at least 1"
+#endif
+
+#if !defined(LINC_DEFAULT_SYSLOG_FACILITY)
+#define LINC_DEFAULT_SYSLOG_FACILITY 1  // Default syslog facility of the logs, user-level messages
+#elif (LINC_DEFAULT_SYSLOG_FACILITY < 1) || (LINC_DEFAULT_SYSLOG_FACILITY > 23)
+#error "LINC_DEFAULT_SYSLOG_FACILITY must be between 1 and 23"
+#endif
+
+#if !defined(LINC_DEFAULT_BACKPRESSURE)
+#define LINC_DEFAULT_BACKPRESSURE LINC_BACKPRESSURE_BLOCK  // Default policy of producers on a full buffer
+#endif
+
+#if !defined(LINC_DEFAULT_BACKPRESSURE_TIMEOUT_US)
+#define LINC_DEFAULT_BACKPRESSURE_TIMEOUT_US 1000  // Default time in microseconds to wait for space before dropping
+#endif
+
+#if !defined(LINC_DEFAULT_CLOCK)
+#define LINC_DEFAULT_CLOCK LINC_CLOCK_MONOTONIC  // Default clock read by producer threads
+#endif
+
+#if !defined(LINC_DEFAULT_CLOCK_RESYNC_MS)
+#define LINC_DEFAULT_CLOCK_RESYNC_MS 1000  // Interval in milliseconds between two resyncs with the realtime clock
+#elif (LINC_DEFAULT_CLOCK_RESYNC_MS < 1)
+#error "LINC_DEFAULT_CLOCK_RESYNC_MS must be at least 1"
+#endif
+
+#if !defined(LINC_DEFAULT_TIMESTAMP_PRECISION)
+#define LINC_DEFAULT_TIMESTAMP_PRECISION LINC_TIMESTAMP_MILLISECONDS  // Digits of the fraction of second in log lines
+#endif
+
+#if !defined(LINC_DEFAULT_TIMEZONE)
+#define LINC_DEFAULT_TIMEZONE LINC_TIMEZONE_UTC  // Timezone of the timestamps in log lines
+#endif
+
+#if !defined(LINC_DEFAULT_PIPELINE)
+#define LINC_DEFAULT_PIPELINE LINC_PIPELINE_SHARED  // Default pipeline used by producer threads
+#endif
+
+#if !defined(LINC_DEFAULT_FORMATTING)
+#define LINC_DEFAULT_FORMATTING LINC_FORMATTING_EAGER  // Default formatting of log messages
+#endif
+
+#if !defined(LINC_DEFAULT_MAX_THREAD_BUFFERS)
+#define LINC_DEFAULT_MAX_THREAD_BUFFERS 16  // Maximum number of per-thread buffers
+#elif (LINC_DEFAULT_MAX_THREAD_BUFFERS < 1)
+#error "LINC_DEFAULT_MAX_THREAD_BUFFERS must be at least 1"
+#endif
+
+#if !defined(LINC_DEFAULT_MAX_THREADS)
+#define LINC_DEFAULT_MAX_THREADS 256  // Maximum number of threads alive at once with their own identity in logs
+#elif (LINC_DEFAULT_MAX_THREADS < 1)
+#error "LINC_DEFAULT_MAX_THREADS must be at least 1"
+#endif
+
+#if !defined(LINC_DEFAULT_THREAD_NAME_LENGTH)
+#define LINC_DEFAULT_THREAD_NAME_LENGTH 15  // Maximum length of thread names, the one of Linux thread names
+#elif (LINC_DEFAULT_THREAD_NAME_LENGTH < 1)
+#error "LINC_DEFAULT_THREAD_NAME_LENGTH must be at least 1"
+#endif
+
+#if !defined(LINC_DEFAULT_THREAD_BUFFER_BYTES)
+#define LINC_DEFAULT_THREAD_BUFFER_BYTES 16384  // Default size in bytes for each per-thread buffer
+#elif (LINC_DEFAULT_THREAD_BUFFER_BYTES % 8 != 0)
+#error "LINC_DEFAULT_THREAD_BUFFER_BYTES must be a multiple of 8"
+#elif (LINC_DEFAULT_THREAD_BUFFER_BYTES < 2 * (LINC_DEFAULT_MAX_MESSAGE_LENGTH + 128))
+#error "LINC_DEFAULT_THREAD_BUFFER_BYTES must hold at least two messages of LINC_DEFAULT_MAX_MESSAGE_LENGTH"
+#endif
+
+#if !defined(LINC_DEFAULT_MAX_LAYOUTS)
+#define LINC_DEFAULT_MAX_LAYOUTS 8  // Maximum number of compiled layouts, besides the built-in ones
+#elif (LINC_DEFAULT_MAX_LAYOUTS < 1)
+#error "LINC_DEFAULT_MAX_LAYOUTS must be at least 1"
+#endif
+
+#if !defined(LINC_DEFAULT_LAYOUT_OPS)
+#define LINC_DEFAULT_LAYOUT_OPS 32  // Maximum number of fields and constant texts in a layout
+#elif (LINC_DEFAULT_LAYOUT_OPS < 24)
+#error "LINC_DEFAULT_LAYOUT_OPS must be at least 24 to hold the built-in layouts"
+#endif
+
+#if !defined(LINC_DEFAULT_LAYOUT_LITERALS_LENGTH)
+#define LINC_DEFAULT_LAYOUT_LITERALS_LENGTH 256  // Maximum length of the constant text of a layout
+#elif (LINC_DEFAULT_LAYOUT_LITERALS_LENGTH < 128)
+#error "LINC_DEFAULT_LAYOUT_LITERALS_LENGTH must be at least 128 to hold the built-in layouts"
+#endif
+
+#if !defined(LINC_DEFAULT_SHARED_LAYOUTS)
+#define LINC_DEFAULT_SHARED_LAYOUTS 2  // Number of layouts rendered once per record and shared by every sink
+#elif (LINC_DEFAULT_SHARED_LAYOUTS < 1)
+#error "LINC_DEFAULT_SHARED_LAYOUTS must be at least 1"
 #endif
 
 #define LINC_ZERO_CHAR_LENGTH 1     // Zero character length
@@ -86,10 +283,45 @@ enum linc_level {
     LINC_LEVEL_FATAL = 5,  // Critical errors that cause the application to terminate
 };
 
+enum linc_backpressure {
+    LINC_BACKPRESSURE_BLOCK = 0,             // Wait for space, never drop a log
+    LINC_BACKPRESSURE_BLOCK_TIMEOUT = 1,     // Wait for space up to a timeout, then drop the new log
+    LINC_BACKPRESSURE_DROP_NEWEST = 2,       // Drop the new log right away
+    LINC_BACKPRESSURE_OVERWRITE_OLDEST = 3,  // Drop the oldest logs of the buffer to make space for the new one
+};
+
+enum linc_pipeline {
+    LINC_PIPELINE_SHARED = 0,      // All threads share a single lock-free ring buffer
+    LINC_PIPELINE_PER_THREAD = 1,  // Each thread owns a buffer, merged by timestamp in the worker
+};
+
+enum linc_formatting {
+    LINC_FORMATTING_EAGER = 0,     // Producer threads format messages before enqueuing them
+    LINC_FORMATTING_DEFERRED = 1,  // Producer threads capture the arguments, the worker formats messages
+};
+
+enum linc_clock {
+    LINC_CLOCK_MONOTONIC = 0,  // Raw monotonic clock, a vDSO call or a system call on some virtual machines
+    LINC_CLOCK_COARSE = 1,     // Coarse monotonic clock, a cheap vDSO read with a resolution of a few milliseconds
+    LINC_CLOCK_TSC = 2,        // Invariant time stamp counter of x86 CPUs, a single instruction
+};
+
+enum linc_timestamp_precision {
+    LINC_TIMESTAMP_MILLISECONDS = 3,  // "YYYY-MM-DD HH:MM:SS.mmm"
+    LINC_TIMESTAMP_MICROSECONDS = 6,  // "YYYY-MM-DD HH:MM:SS.uuuuuu"
+    LINC_TIMESTAMP_NANOSECONDS = 9,   // "YYYY-MM-DD HH:MM:SS.nnnnnnnnn"
+};
+
+enum linc_timezone {
+    LINC_TIMEZONE_UTC = 0,    // Coordinated universal time
+    LINC_TIMEZONE_LOCAL = 1,  // Local time of the process, see tzset
+};
+
 struct linc_metadata {
     int64_t timestamp;                                                      // Timestamp in nanoseconds since epoch
     enum linc_level level;                                                  // Level of the log
     uintptr_t thread_id;                                                    // Thread ID where the log was generated
+    uint32_t thread;                                                        // Index of the thread, 0 if unknown
     const char *module_name;                                                // Module name where the log was generated
     const char *filename;                                                   // Source file where the log was generated
     uint32_t line;                                                          // Line number in the source file
@@ -103,14 +335,73 @@ struct linc_sink_funcs {
     int (*close)(void *data);                                  // Function to close/deinit the sink
     int (*write)(void *data, struct linc_metadata *metadata);  // Function to write a log message
     int (*flush)(void *data);                                  // Function to flush the sink (if applicable)
+    // Function to write many log messages at once (optional, write is called for each message if missing)
+    int (*write_batch)(void *data, struct linc_metadata *const *records, size_t count);
+    // Time in microseconds the sink may keep written logs before flush is called (optional, 0 if never)
+    uint32_t flush_latency;
+    // Function to give back what the builder of the functions claimed, if they are never opened (optional)
+    void (*release)(void *data);
+};
+
+struct linc_sink_file_options {
+    size_t buffer_size;          // Size in bytes of the buffer, 0 for LINC_DEFAULT_FILE_BUFFER_BYTES
+    uint32_t flush_delay_us;     // Time in microseconds logs may stay buffered, 0 for LINC_DEFAULT_FILE_FLUSH_DELAY_US
+    struct linc_layout *layout;  // Layout of the lines, NULL for linc_layout_text
+    bool is_async;               // Writes are submitted with io_uring where available, written synchronously otherwise
+};
+
+struct linc_sink_mmap_options {
+    size_t segment_size;         // Size in bytes of each segment, 0 for LINC_DEFAULT_MMAP_SEGMENT_BYTES
+    struct linc_layout *layout;  // Layout of the lines, NULL for linc_layout_text
+};
+
+struct linc_sink_http_options {
+    const char *path;         // Path of the requests, NULL for "/"
+    size_t batch_size;        // Size in bytes of the body of a request, 0 for LINC_DEFAULT_HTTP_BATCH_BYTES
+    uint32_t flush_delay_us;  // Time in microseconds logs may wait for a fuller body, 0 for the default delay
+    unsigned int pipeline;    // Requests sent before waiting for a response, 0 for LINC_DEFAULT_HTTP_PIPELINE
+    bool is_ndjson;           // Bodies hold one JSON object per line, instead of a JSON array
+};
+
+struct linc_sink_syslog_options {
+    const char *app_name;        // APP-NAME of the logs, NULL for the nil value "-"
+    unsigned int facility;       // Facility from 1 to 23, 0 for LINC_DEFAULT_SYSLOG_FACILITY
+    size_t max_datagram;         // Size in bytes of the largest datagram, 0 for LINC_DEFAULT_SYSLOG_DATAGRAM_BYTES
+    uint32_t flush_delay_us;     // Time in microseconds logs may wait for a fuller batch, 0 for the default delay
+    struct linc_layout *layout;  // Layout of the MSG part, NULL for the message alone
+};
+
+struct linc_sink_rotation_options {
+    size_t max_size;         // Size in bytes that starts a new file, 0 for no limit
+    uint32_t interval_s;     // Time in seconds after which a new file is started, 0 for no limit
+    unsigned int max_files;  // Number of rotated files kept, 0 to keep them all
+    bool is_compressed;      // Rotated files are compressed with gzip, found in the PATH
 };
 
 typedef struct linc_module *linc_module;  // Opaque pointer to a module
 typedef struct linc_sink *linc_sink;      // Opaque pointer to a sink
+typedef struct linc_layout *linc_layout;  // Opaque pointer to a compiled layout
 
 extern linc_module linc_default_module;  // Default module
 extern linc_sink linc_default_sink;      // Default sink
 
+extern linc_layout linc_layout_text;        // Default line format, as printed by the default sink
+extern linc_layout linc_layout_text_color;  // Default line format with ANSI colors
+extern linc_layout linc_layout_json;        // One JSON object per line
+extern linc_layout linc_layout_logfmt;      // One logfmt record per line
+
+// Tells whether a module accepts a level with a single lock-free load, so the logging macros skip the call and the
+// evaluation of its arguments for filtered logs. A module starts with its packed state, its minimum level plus
+// LINC_STATE_DISABLED when it is disabled.
+static inline bool linc_is_enabled(linc_module module, enum linc_level level) {
+#if defined(__GNUC__)
+    return module != NULL && (int)level >= __atomic_load_n((const int *)(const void *)module, __ATOMIC_RELAXED);
+#else
+    (void)level;
+    return module != NULL;
+#endif
+}
+
 // ==================================================
 // Functions
 // ==================================================
@@ -123,31 +414,74 @@ void linc_log(linc_module module,
               const char *format,
               ...) LINC_PRINT_FMT(6, 7);
 
-#define TRACE(...) linc_log(linc_default_module, LINC_LEVEL_TRACE, __FILE__, __LINE__, __func__, __VA_ARGS__)
-#define DEBUG(...) linc_log(linc_default_module, LINC_LEVEL_DEBUG, __FILE__, __LINE__, __func__, __VA_ARGS__)
-#define INFO(...) linc_log(linc_default_module, LINC_LEVEL_INFO, __FILE__, __LINE__, __func__, __VA_ARGS__)
-#define WARN(...) linc_log(linc_default_module, LINC_LEVEL_WARN, __FILE__, __LINE__, __func__, __VA_ARGS__)
-#define ERROR(...) linc_log(linc_default_module, LINC_LEVEL_ERROR, __FILE__, __LINE__, __func__, __VA_ARGS__)
-#define FATAL(...) linc_log(linc_default_module, LINC_LEVEL_FATAL, __FILE__, __LINE__, __func__, __VA_ARGS__)
+// Logs below LINC_COMPILE_LEVEL are folded away by the compiler, so their arguments are never evaluated, but the
+// call is still compiled and its arguments type-checked against the format string. Logs filtered out by their module
+// at runtime skip the call and their arguments too.
+#define LINC_LOG(module, level, ...)                                              \
+    ((level) >= LINC_COMPILE_LEVEL && linc_is_enabled((module), (level))          \
+         ? linc_log((module), (level), __FILE__, __LINE__, __func__, __VA_ARGS__) \
+         : (void)0)
 
-#define TRACE_M(module, ...) linc_log(module, LINC_LEVEL_TRACE, __FILE__, __LINE__, __func__, __VA_ARGS__)
-#define DEBUG_M(module, ...) linc_log(module, LINC_LEVEL_DEBUG, __FILE__, __LINE__, __func__, __VA_ARGS__)
-#define INFO_M(module, ...) linc_log(module, LINC_LEVEL_INFO, __FILE__, __LINE__, __func__, __VA_ARGS__)
-#define WARN_M(module, ...) linc_log(module, LINC_LEVEL_WARN, __FILE__, __LINE__, __func__, __VA_ARGS__)
-#define ERROR_M(module, ...) linc_log(module, LINC_LEVEL_ERROR, __FILE__, __LINE__, __func__, __VA_ARGS__)
-#define FATAL_M(module, ...) linc_log(module, LINC_LEVEL_FATAL, __FILE__, __LINE__, __func__, __VA_ARGS__)
+#define TRACE(...) LINC_LOG(linc_default_module, LINC_LEVEL_TRACE, __VA_ARGS__)
+#define DEBUG(...) LINC_LOG(linc_default_module, LINC_LEVEL_DEBUG, __VA_ARGS__)
+#define INFO(...) LINC_LOG(linc_default_module, LINC_LEVEL_INFO, __VA_ARGS__)
+#define WARN(...) LINC_LOG(linc_default_module, LINC_LEVEL_WARN, __VA_ARGS__)
+#define ERROR(...) LINC_LOG(linc_default_module, LINC_LEVEL_ERROR, __VA_ARGS__)
+#define FATAL(...) LINC_LOG(linc_default_module, LINC_LEVEL_FATAL, __VA_ARGS__)
+
+#define TRACE_M(module, ...) LINC_LOG(module, LINC_LEVEL_TRACE, __VA_ARGS__)
+#define DEBUG_M(module, ...) LINC_LOG(module, LINC_LEVEL_DEBUG, __VA_ARGS__)
+#define INFO_M(module, ...) LINC_LOG(module, LINC_LEVEL_INFO, __VA_ARGS__)
+#define WARN_M(module, ...) LINC_LOG(module, LINC_LEVEL_WARN, __VA_ARGS__)
+#define ERROR_M(module, ...) LINC_LOG(module, LINC_LEVEL_ERROR, __VA_ARGS__)
+#define FATAL_M(module, ...) LINC_LOG(module, LINC_LEVEL_FATAL, __VA_ARGS__)
 
 linc_module linc_register_module(const char *name, enum linc_level level, bool enabled);
 linc_sink linc_register_sink(const char *name, enum linc_level level, bool enabled, struct linc_sink_funcs funcs);
+void linc_release_sink_funcs(struct linc_sink_funcs funcs);
+struct linc_sink_funcs linc_sink_stdout_funcs(void);
+struct linc_sink_funcs linc_sink_file_funcs(const char *path, const struct linc_sink_file_options *options);
+struct linc_sink_funcs linc_sink_rotating_funcs(const char *path,
+                                                const struct linc_sink_file_options *options,
+                                                const struct linc_sink_rotation_options *rotation);
+struct linc_sink_funcs linc_sink_mmap_funcs(const char *path, const struct linc_sink_mmap_options *options);
+struct linc_sink_funcs linc_sink_binary_funcs(const char *path, const struct linc_sink_file_options *options);
+struct linc_sink_funcs linc_sink_http_funcs(const char *host,
+                                            const char *port,
+                                            const struct linc_sink_http_options *options);
+struct linc_sink_funcs linc_sink_syslog_funcs(const char *address,
+                                              const char *port,
+                                              const struct linc_sink_syslog_options *options);
 
 int linc_set_module_level(linc_module module, enum linc_level level);
 int linc_set_module_enabled(linc_module module, bool enabled);
+int linc_set_module_backpressure(linc_module module,
+                                 enum linc_level level,
+                                 enum linc_backpressure backpressure,
+                                 uint32_t timeout_us);
+size_t linc_get_module_dropped(linc_module module);
 
 int linc_set_sink_level(linc_sink sink, enum linc_level level);
 int linc_set_sink_enabled(linc_sink sink, bool enabled);
+int linc_set_sink_batch(linc_sink sink, size_t size, uint32_t latency_us);
+
+int linc_set_pipeline(enum linc_pipeline pipeline);
+int linc_set_formatting(enum linc_formatting formatting);
+int linc_set_clock(enum linc_clock clock);
+int linc_set_thread_name(const char *name);
+int linc_set_crash_handler(int fd);
+
+linc_layout linc_layout_compile(const char *pattern);
+int linc_layout_render(linc_layout layout, const struct linc_metadata *metadata, char *buffer, size_t length);
+const char *linc_layout_view(linc_layout layout, const struct linc_metadata *metadata, size_t *length);
 
 int64_t linc_timestamp(void);
 int linc_timestamp_string(int64_t timestamp, char *buffer, size_t size);
+int linc_format_timestamp(int64_t timestamp,
+                          char *buffer,
+                          size_t size,
+                          enum linc_timestamp_precision precision,
+                          enum linc_timezone timezone);
 const char *linc_level_string(enum linc_level level);
 int linc_stringify_metadata(struct linc_metadata *metadata, char *buffer, size_t length, bool use_colors);
 
@@ -0,0 +1,323 @@
+#include "internal/binary.h"
+
+#include <string.h>
+
+// ==================================================
+// Binary Log Format
+// ==================================================
+//
+// Binary sinks write each log as a few bytes instead of a line of text. Numbers are unsigned LEB128 varints, so small
+// values take a single byte. A file is a sequence of segments, each starting with a header:
+//
+//   'L' 'I' 'N' 'C', version byte, timestamp of the first log as 8 bytes in little-endian order
+//
+// Module, file and function names, as well as thread IDs, are interned: the first log of a segment that uses one is
+// preceded by its definition, and every log refers to them by identifier. Identifiers start at 1, 0 stands for a
+// missing name.
+//
+//   'S', identifier, length, bytes of the string
+//   'T', identifier, thread ID
+//   'R', timestamp delta (zigzag), level byte, thread, module, file and function identifiers, line, length, message
+//
+// Strings are interned by address, since the names of modules, files and functions never move. A new segment starts
+// once the identifiers run out, and the sink starts one for each new file, so every segment decodes on its own.
+
+#define LINC_BINARY_VARINT_LENGTH 10  // Maximum bytes of a 64-bit varint
+#define LINC_BINARY_MAGIC "LINC"      // First bytes of the header of a segment
+#define LINC_BINARY_MAGIC_LENGTH 4    // Length of the magic
+#define LINC_BINARY_BASE_LENGTH 8     // Bytes of the first timestamp of a segment
+
+// Bytes of the header of a segment
+#define LINC_BINARY_HEADER_LENGTH (LINC_BINARY_MAGIC_LENGTH + 1 + LINC_BINARY_BASE_LENGTH)
+
+static size_t linc_binary_put_varint(unsigned char *out, uint64_t value) {
+    size_t length = 0;
+    while (value >= 0x80) {
+        out[length++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    out[length++] = (unsigned char)value;
+    return length;
+}
+
+// Maps signed deltas to small unsigned numbers: 0, -1, 1, -2, 2, ...
+static uint64_t linc_binary_zigzag(int64_t value) {
+    return value < 0 ? ((uint64_t)(-(value + 1)) << 1) | 1 : (uint64_t)value << 1;
+}
+
+static int64_t linc_binary_unzigzag(uint64_t value) {
+    return (value & 1) != 0 ? -(int64_t)(value >> 1) - 1 : (int64_t)(value >> 1);
+}
+
+// ==================================================
+// Encoding
+// ==================================================
+
+// Starts a new segment with the next log, so it does not depend on the logs written before.
+void linc_binary_reset(struct linc_binary_writer *writer) {
+    writer->count = 0;
+}
+
+static size_t linc_binary_segment(struct linc_binary_writer *writer, int64_t timestamp, unsigned char *out) {
+    memset(writer->slots, 0, sizeof(writer->slots));
+    writer->count = 1;
+    writer->timestamp = timestamp;
+    memcpy(out, LINC_BINARY_MAGIC, LINC_BINARY_MAGIC_LENGTH);
+    out[LINC_BINARY_MAGIC_LENGTH] = LINC_BINARY_VERSION;
+    uint64_t base = (uint64_t)timestamp;
+    for (size_t i = 0; i < LINC_BINARY_BASE_LENGTH; i++) {
+        out[LINC_BINARY_MAGIC_LENGTH + 1 + i] = (unsigned char)(base >> (i * 8));
+    }
+    return LINC_BINARY_HEADER_LENGTH;
+}
+
+// Returns the identifier of the string or thread ID, after writing its definition if the segment has none yet.
+static uint32_t linc_binary_intern(struct linc_binary_writer *writer,
+                                   enum linc_binary_tag tag,
+                                   uintptr_t key,
+                                   unsigned char *out,
+                                   size_t *used) {
+    if (tag == LINC_BINARY_STRING && key == 0) {
+        return 0;
+    }
+    size_t slot = (size_t)(((uint64_t)key ^ (uint64_t)tag) * UINT64_C(0x9e3779b97f4a7c15) >> 32);
+    while (true) {
+        slot &= LINC_BINARY_SLOTS - 1;
+        struct linc_binary_entry *entry = &writer->slots[slot];
+        if (entry->id == 0) {
+            break;
+        }
+        if (entry->key == key && entry->tag == tag) {
+            return entry->id;
+        }
+        slot++;
+    }
+
+    struct linc_binary_entry *entry = &writer->slots[slot];
+    entry->key = key;
+    entry->id = writer->count++;
+    entry->tag = (uint8_t)tag;
+    out += *used;
+    size_t length = 0;
+    out[length++] = (unsigned char)tag;
+    length += linc_binary_put_varint(out + length, entry->id);
+    if (tag == LINC_BINARY_STRING) {
+        const char *string = (const char *)key;
+        size_t string_length = strnlen(string, LINC_BINARY_STRING_LENGTH);
+        length += linc_binary_put_varint(out + length, string_length);
+        memcpy(out + length, string, string_length);
+        length += string_length;
+    } else {
+        length += linc_binary_put_varint(out + length, (uint64_t)key);
+    }
+    *used += length;
+    return entry->id;
+}
+
+// Encodes the log into the buffer, which holds at least LINC_BINARY_RECORD_LENGTH bytes, and returns its length.
+size_t linc_binary_encode(struct linc_binary_writer *writer, const struct linc_metadata *metadata, char *buffer) {
+    unsigned char *out = (unsigned char *)buffer;
+    size_t used = 0;
+    // A log defines at most 4 identifiers.
+    if (writer->count == 0 || writer->count + 4 > LINC_BINARY_ENTRIES) {
+        used = linc_binary_segment(writer, metadata->timestamp, out);
+    }
+    uint32_t thread = linc_binary_intern(writer, LINC_BINARY_THREAD, metadata->thread_id, out, &used);
+    uint32_t module = linc_binary_intern(writer, LINC_BINARY_STRING, (uintptr_t)metadata->module_name, out, &used);
+    uint32_t file = linc_binary_intern(writer, LINC_BINARY_STRING, (uintptr_t)metadata->filename, out, &used);
+    uint32_t func = linc_binary_intern(writer, LINC_BINARY_STRING, (uintptr_t)metadata->func, out, &used);
+
+    size_t message_length = strnlen(metadata->message, LINC_DEFAULT_MAX_MESSAGE_LENGTH);
+    out[used++] = LINC_BINARY_LOG;
+    used += linc_binary_put_varint(out + used, linc_binary_zigzag(metadata->timestamp - writer->timestamp));
+    out[used++] = (unsigned char)metadata->level;
+    used += linc_binary_put_varint(out + used, thread);
+    used += linc_binary_put_varint(out + used, module);
+    used += linc_binary_put_varint(out + used, file);
+    used += linc_binary_put_varint(out + used, func);
+    used += linc_binary_put_varint(out + used, metadata->line);
+    used += linc_binary_put_varint(out + used, message_length);
+    memcpy(out + used, metadata->message, message_length);
+    used += message_length;
+    writer->timestamp = metadata->timestamp;
+    return used;
+}
+
+// ==================================================
+// Decoding
+// ==================================================
+//
+// Decoding reads one entry at a time from a buffer, so a decoder can stream a file of any size through a buffer of
+// LINC_BINARY_RECORD_LENGTH bytes. An entry is only applied once it was read whole and checked.
+
+struct linc_binary_cursor {
+    const unsigned char *data;  // Bytes being decoded
+    size_t length;              // Number of bytes
+    size_t position;            // Bytes already read
+    bool is_partial;            // An entry went past the end of the bytes
+    bool is_invalid;            // An entry is malformed
+};
+
+static const unsigned char *linc_binary_get_bytes(struct linc_binary_cursor *cursor, size_t length) {
+    if (cursor->length - cursor->position < length) {
+        cursor->is_partial = true;
+        return NULL;
+    }
+    const unsigned char *bytes = cursor->data + cursor->position;
+    cursor->position += length;
+    return bytes;
+}
+
+static uint64_t linc_binary_get_varint(struct linc_binary_cursor *cursor) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < LINC_BINARY_VARINT_LENGTH; i++) {
+        const unsigned char *byte = linc_binary_get_bytes(cursor, 1);
+        if (byte == NULL) {
+            return 0;
+        }
+        value |= (uint64_t)(*byte & 0x7f) << (i * 7);
+        if ((*byte & 0x80) == 0) {
+            return value;
+        }
+    }
+    cursor->is_invalid = true;
+    return 0;
+}
+
+// Checks that the identifier was defined with the tag in the current segment, 0 is a missing string.
+static bool linc_binary_is_defined(const struct linc_binary_reader *reader, uint64_t id, enum linc_binary_tag tag) {
+    if (id == 0) {
+        return tag == LINC_BINARY_STRING;
+    }
+    return id < reader->count && reader->tags[id] == tag;
+}
+
+static const char *linc_binary_string(const struct linc_binary_reader *reader, uint64_t id) {
+    return id != 0 ? reader->strings + reader->values[id] : NULL;
+}
+
+static enum linc_binary_status linc_binary_decode_segment(struct linc_binary_reader *reader,
+                                                          struct linc_binary_cursor *cursor) {
+    const unsigned char *header = linc_binary_get_bytes(cursor, LINC_BINARY_HEADER_LENGTH);
+    if (header == NULL) {
+        return LINC_BINARY_PARTIAL;
+    }
+    if (memcmp(header, LINC_BINARY_MAGIC, LINC_BINARY_MAGIC_LENGTH) != 0
+        || header[LINC_BINARY_MAGIC_LENGTH] != LINC_BINARY_VERSION) {
+        return LINC_BINARY_INVALID;
+    }
+    uint64_t base = 0;
+    for (size_t i = 0; i < LINC_BINARY_BASE_LENGTH; i++) {
+        base |= (uint64_t)header[LINC_BINARY_MAGIC_LENGTH + 1 + i] << (i * 8);
+    }
+    reader->count = 1;
+    reader->strings_used = 0;
+    reader->timestamp = (int64_t)base;
+    return LINC_BINARY_DEFINITION;
+}
+
+static enum linc_binary_status linc_binary_decode_definition(struct linc_binary_reader *reader,
+                                                             struct linc_binary_cursor *cursor,
+                                                             enum linc_binary_tag tag) {
+    uint64_t id = linc_binary_get_varint(cursor);
+    uint64_t value = linc_binary_get_varint(cursor);
+    const unsigned char *string = NULL;
+    if (tag == LINC_BINARY_STRING && value <= LINC_BINARY_STRING_LENGTH) {
+        string = linc_binary_get_bytes(cursor, (size_t)value);
+    }
+    if (cursor->is_invalid) {
+        return LINC_BINARY_INVALID;
+    }
+    if (cursor->is_partial) {
+        return LINC_BINARY_PARTIAL;
+    }
+    // Identifiers are defined in order, once per segment.
+    if (reader->count == 0 || id != reader->count || id >= LINC_BINARY_ENTRIES
+        || (tag == LINC_BINARY_STRING && string == NULL)) {
+        return LINC_BINARY_INVALID;
+    }
+
+    reader->tags[id] = (uint8_t)tag;
+    reader->values[id] = value;
+    if (tag == LINC_BINARY_STRING) {
+        reader->values[id] = reader->strings_used;
+        memcpy(reader->strings + reader->strings_used, string, (size_t)value);
+        reader->strings[reader->strings_used + value] = '\0';
+        reader->strings_used += (size_t)value + LINC_ZERO_CHAR_LENGTH;
+    }
+    reader->count++;
+    return LINC_BINARY_DEFINITION;
+}
+
+static enum linc_binary_status linc_binary_decode_log(struct linc_binary_reader *reader,
+                                                      struct linc_binary_cursor *cursor,
+                                                      struct linc_metadata *metadata) {
+    uint64_t delta = linc_binary_get_varint(cursor);
+    const unsigned char *level = linc_binary_get_bytes(cursor, 1);
+    uint64_t thread = linc_binary_get_varint(cursor);
+    uint64_t module = linc_binary_get_varint(cursor);
+    uint64_t file = linc_binary_get_varint(cursor);
+    uint64_t func = linc_binary_get_varint(cursor);
+    uint64_t line = linc_binary_get_varint(cursor);
+    uint64_t message_length = linc_binary_get_varint(cursor);
+    const unsigned char *message = NULL;
+    if (message_length <= LINC_DEFAULT_MAX_MESSAGE_LENGTH) {
+        message = linc_binary_get_bytes(cursor, (size_t)message_length);
+    }
+    if (cursor->is_invalid) {
+        return LINC_BINARY_INVALID;
+    }
+    if (cursor->is_partial) {
+        return LINC_BINARY_PARTIAL;
+    }
+    if (reader->count == 0 || message == NULL || line > UINT32_MAX
+        || !linc_binary_is_defined(reader, thread, LINC_BINARY_THREAD)
+        || !linc_binary_is_defined(reader, module, LINC_BINARY_STRING)
+        || !linc_binary_is_defined(reader, file, LINC_BINARY_STRING)
+        || !linc_binary_is_defined(reader, func, LINC_BINARY_STRING)) {
+        return LINC_BINARY_INVALID;
+    }
+
+    reader->timestamp += linc_binary_unzigzag(delta);
+    metadata->timestamp = reader->timestamp;
+    metadata->level = (enum linc_level)*level;
+    metadata->thread_id = (uintptr_t)reader->values[thread];
+    metadata->thread = 0;
+    metadata->module_name = linc_binary_string(reader, module);
+    metadata->filename = linc_binary_string(reader, file);
+    metadata->line = (uint32_t)line;
+    metadata->func = linc_binary_string(reader, func);
+    memcpy(metadata->message, message, (size_t)message_length);
+    metadata->message[message_length] = '\0';
+    return LINC_BINARY_RECORD;
+}
+
+// Reads the next entry of the bytes. Logs fill the metadata, whose strings stay valid until the next segment.
+enum linc_binary_status linc_binary_decode(struct linc_binary_reader *reader,
+                                           const char *data,
+                                           size_t length,
+                                           struct linc_metadata *metadata,
+                                           size_t *used) {
+    struct linc_binary_cursor cursor = {
+        .data = (const unsigned char *)data, .length = length, .position = 0, .is_partial = false, .is_invalid = false};
+    const unsigned char *tag = linc_binary_get_bytes(&cursor, 1);
+    if (tag == NULL) {
+        return LINC_BINARY_PARTIAL;
+    }
+    enum linc_binary_status status = LINC_BINARY_INVALID;
+    switch (*tag) {
+        case LINC_BINARY_SEGMENT:
+            cursor.position = 0;
+            status = linc_binary_decode_segment(reader, &cursor);
+            break;
+        case LINC_BINARY_STRING:
+        case LINC_BINARY_THREAD:
+            status = linc_binary_decode_definition(reader, &cursor, (enum linc_binary_tag)*tag);
+            break;
+        case LINC_BINARY_LOG:
+            status = linc_binary_decode_log(reader, &cursor, metadata);
+            break;
+    }
+    *used = status > LINC_BINARY_PARTIAL ? cursor.position : 0;
+    return status;
+}
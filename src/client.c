@@ -10,19 +10,19 @@
 // Internal Functions
 // ==================================================
 
-static int linc_check_module(struct linc_module *module, enum linc_level level) {
+static int linc_check_module(struct linc_module *module,
+                             enum linc_level level,
+                             enum linc_backpressure *backpressure,
+                             uint32_t *timeout_us) {
     if (module == NULL || level < LINC_LEVEL_TRACE || level > LINC_LEVEL_FATAL) {
         return -1;
     }
 
-    pthread_rwlock_rdlock(&module->lock);
-    bool is_module_enabled = module->enabled == true;
-    bool is_level_valid = level >= module->level;
-    pthread_rwlock_unlock(&module->lock);
-
-    if (!is_module_enabled || !is_level_valid) {
+    if (!linc_state_accepts(&module->state, level)) {
         return -1;
     }
+    *backpressure = LINC_ATOMIC_LOAD(&module->backpressure[level], LINC_RELAXED);
+    *timeout_us = LINC_ATOMIC_LOAD(&module->backpressure_timeout[level], LINC_RELAXED);
     return 0;
 }
 
@@ -41,27 +41,68 @@ void linc_log(struct linc_module *module,
     if (module == NULL) {
         return;
     }
-    int module_check = linc_check_module(module, level);
+    enum linc_backpressure backpressure;
+    uint32_t timeout_us;
+    int module_check = linc_check_module(module, level, &backpressure, &timeout_us);
     if (module_check < 0) {
         return;
     }
 
-    struct linc_metadata metadata = {
-        .timestamp = linc_timestamp(),
-        .level = level,
-        .thread_id = (uintptr_t)pthread_self(),
-        .module_name = module->name,
-        .filename = filename,
-        .line = line,
-        .func = func,
-    };
+    struct linc_thread_buffer *buffer = NULL;
+    if (LINC_ATOMIC_LOAD(&linc.pipeline, LINC_RELAXED) == LINC_PIPELINE_PER_THREAD) {
+        buffer = linc_thread_buffer_acquire();
+    }
+    if (buffer != NULL) {
+        linc_thread_buffer_begin(buffer);
+    }
+
+    // Only the written bytes of the message are copied into the ring buffer, so the metadata is not zeroed. The
+    // timestamp holds raw ticks of the clock, tagged in the flags, until the worker converts it.
+    uint8_t flags = 0;
+    struct linc_metadata metadata;
+    metadata.timestamp = linc_clock_ticks(&flags);
+    metadata.level = level;
+    metadata.thread = linc_thread_current();
+    metadata.thread_id = metadata.thread == 0 ? (uintptr_t)pthread_self() : 0;
+    metadata.module_name = module->name;
+    metadata.filename = filename;
+    metadata.line = line;
+    metadata.func = func;
 
+    size_t message_length = 0;
     if (format != NULL) {
         va_list args;
         va_start(args, format);
-        vsnprintf(metadata.message, sizeof(metadata.message), format, args);
+        int captured = -1;
+        // Captured arguments point into this process, so records of a ring kept in a file are always formatted.
+        if (LINC_ATOMIC_LOAD(&linc.formatting, LINC_RELAXED) == LINC_FORMATTING_DEFERRED
+            && (buffer != NULL || linc.ring_buffer.recovery_tail == NULL)) {
+            va_list capture;
+            va_copy(capture, args);
+            captured = linc_format_capture(metadata.message, sizeof(metadata.message), format, capture);
+            va_end(capture);
+        }
+        if (captured >= 0) {
+            message_length = (size_t)captured;
+            flags |= LINC_RECORD_DEFERRED;
+        } else {
+            int written = vsnprintf(metadata.message, sizeof(metadata.message), format, args);
+            if (written > 0) {
+                message_length = (size_t)written < sizeof(metadata.message) ? (size_t)written
+                                                                             : sizeof(metadata.message) - 1;
+            }
+        }
         va_end(args);
     }
 
-    linc_ring_buffer_enqueue(&metadata);
+    int result;
+    if (buffer != NULL) {
+        result = linc_ring_buffer_push(&buffer->ring, &metadata, message_length, flags, backpressure, timeout_us);
+        linc_thread_buffer_end(buffer);
+    } else {
+        result = linc_ring_buffer_enqueue(&metadata, message_length, flags, backpressure, timeout_us);
+    }
+    if (result < 0) {
+        LINC_ATOMIC_FETCH_ADD(&module->dropped, 1, LINC_RELAXED);
+    }
 }
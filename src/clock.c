@@ -0,0 +1,235 @@
+#include "internal/shared.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#define LINC_CLOCK_HAS_TSC 1
+#else
+#define LINC_CLOCK_HAS_TSC 0
+#endif
+
+// ==================================================
+// Clock Sources
+// ==================================================
+//
+// Producers only read the raw ticks of the selected clock and tag their record with it, the worker converts the
+// ticks to nanoseconds since epoch when it decodes the record. POSIX clocks count nanoseconds already and only need
+// their offset to the realtime clock. The time stamp counter counts cycles at a constant rate on CPUs with an
+// invariant TSC, its rate is calibrated against the raw monotonic clock over the whole uptime of the library. The
+// worker resyncs offsets and rate periodically, so timestamps follow NTP corrections of the realtime clock. The
+// conversion is published with a sequence lock, since any thread may read the time with linc_timestamp.
+
+#if defined(CLOCK_MONOTONIC_RAW)
+#define CLOCK_GETTIME(ts) clock_gettime(CLOCK_MONOTONIC_RAW, ts)
+#else
+#define CLOCK_GETTIME(ts) clock_gettime(CLOCK_MONOTONIC, ts)
+#endif
+
+#define LINC_CLOCK_CALIBRATION_NS 10000000  // Length of the first measure of the TSC rate
+#define LINC_CLOCK_RESYNC_RECORDS 1024      // Records decoded by a busy worker between two resync checks
+
+static int64_t linc_clock_ns(const struct timespec *ts) {
+    return (int64_t)ts->tv_sec * 1000000000L + (int64_t)ts->tv_nsec;
+}
+
+static bool linc_clock_has_tsc(void) {
+#if LINC_CLOCK_HAS_TSC
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) == 0) {
+        return false;
+    }
+    return (edx & (1U << 8)) != 0;
+#else
+    return false;
+#endif
+}
+
+static int64_t linc_clock_tsc(void) {
+#if LINC_CLOCK_HAS_TSC
+    uint32_t low, high;
+    __asm__ __volatile__("rdtsc" : "=a"(low), "=d"(high));
+    return (int64_t)(((uint64_t)high << 32) | low);
+#else
+    return 0;
+#endif
+}
+
+// Samples every clock as close together as possible and publishes the new conversion. Called with the clock lock.
+static void linc_clock_update(void) {
+    struct linc_clock_state *clock = &linc.clock;
+    struct timespec raw, real;
+    CLOCK_GETTIME(&raw);
+    int64_t ticks = clock->calibration_ticks != 0 ? linc_clock_tsc() : 0;
+    clock_gettime(CLOCK_REALTIME, &real);
+    int64_t real_ns = linc_clock_ns(&real);
+    int64_t raw_ns = linc_clock_ns(&raw);
+
+    int64_t coarse_offset = clock->offset[LINC_CLOCK_COARSE];
+#if defined(CLOCK_MONOTONIC_COARSE) && defined(CLOCK_REALTIME_COARSE)
+    struct timespec coarse, real_coarse;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &coarse);
+    clock_gettime(CLOCK_REALTIME_COARSE, &real_coarse);
+    coarse_offset = linc_clock_ns(&real_coarse) - linc_clock_ns(&coarse);
+#endif
+
+    int64_t tsc_mult = clock->tsc_mult;
+    if (clock->calibration_ticks != 0 && ticks > clock->calibration_ticks) {
+        double rate = (double)(raw_ns - clock->calibration_ns) / (double)(ticks - clock->calibration_ticks);
+        tsc_mult = (int64_t)(rate * (double)LINC_CLOCK_TSC_UNIT);
+    }
+
+    unsigned int sequence = LINC_ATOMIC_LOAD(&clock->sequence, LINC_RELAXED);
+    LINC_ATOMIC_STORE(&clock->sequence, sequence + 1, LINC_RELAXED);
+    LINC_ATOMIC_FENCE(LINC_RELEASE);
+    LINC_ATOMIC_STORE(&clock->offset[LINC_CLOCK_MONOTONIC], real_ns - raw_ns, LINC_RELAXED);
+    LINC_ATOMIC_STORE(&clock->offset[LINC_CLOCK_COARSE], coarse_offset, LINC_RELAXED);
+    LINC_ATOMIC_STORE(&clock->tsc_base, ticks, LINC_RELAXED);
+    LINC_ATOMIC_STORE(&clock->tsc_realtime, real_ns, LINC_RELAXED);
+    LINC_ATOMIC_STORE(&clock->tsc_mult, tsc_mult, LINC_RELAXED);
+    LINC_ATOMIC_STORE(&clock->sequence, sequence + 2, LINC_RELEASE);
+}
+
+// Measures the TSC rate once, over a short sleep, before the first record uses it. Called with the clock lock.
+static int linc_clock_calibrate(void) {
+    struct linc_clock_state *clock = &linc.clock;
+    if (clock->calibration_ticks != 0) {
+        return 0;
+    }
+    if (!linc_clock_has_tsc()) {
+        return -1;
+    }
+
+    struct timespec raw;
+    CLOCK_GETTIME(&raw);
+    clock->calibration_ticks = linc_clock_tsc();
+    clock->calibration_ns = linc_clock_ns(&raw);
+    struct timespec pause = {.tv_sec = 0, .tv_nsec = LINC_CLOCK_CALIBRATION_NS};
+    nanosleep(&pause, NULL);
+    linc_clock_update();
+    return 0;
+}
+
+static int linc_clock_select(enum linc_clock source) {
+    struct linc_clock_state *clock = &linc.clock;
+    pthread_mutex_lock(&clock->mutex);
+    int result = source == LINC_CLOCK_TSC ? linc_clock_calibrate() : 0;
+    if (result == 0) {
+        LINC_ATOMIC_STORE(&clock->source, source, LINC_RELEASE);
+    }
+    pthread_mutex_unlock(&clock->mutex);
+    return result;
+}
+
+void linc_clock_init(void) {
+    struct linc_clock_state *clock = &linc.clock;
+    pthread_mutex_init(&clock->mutex, NULL);
+    clock->source = LINC_CLOCK_MONOTONIC;
+    clock->sequence = 0;
+    clock->calibration_ticks = 0;
+    clock->calibration_ns = 0;
+    clock->tsc_mult = 0;
+    clock->resync_at = 0;
+    clock->records = 0;
+    linc_clock_update();
+    linc_clock_select(LINC_DEFAULT_CLOCK);
+}
+
+int64_t linc_clock_ticks(uint8_t *flags) {
+    int source = LINC_ATOMIC_LOAD(&linc.clock.source, LINC_ACQUIRE);
+    *flags |= (uint8_t)(source << LINC_RECORD_CLOCK_SHIFT);
+    struct timespec ts;
+    switch (source) {
+        case LINC_CLOCK_TSC:
+            return linc_clock_tsc();
+#if defined(CLOCK_MONOTONIC_COARSE)
+        case LINC_CLOCK_COARSE:
+            clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+            return linc_clock_ns(&ts);
+#endif
+        default:
+            CLOCK_GETTIME(&ts);
+            return linc_clock_ns(&ts);
+    }
+}
+
+// Converts the ticks with the conversion published at the sequence, returns false if a resync overwrote it meanwhile.
+static bool linc_clock_convert(int64_t ticks, uint8_t flags, int64_t *nanoseconds) {
+    struct linc_clock_state *clock = &linc.clock;
+    int source = (flags & LINC_RECORD_CLOCK_MASK) >> LINC_RECORD_CLOCK_SHIFT;
+    unsigned int sequence = LINC_ATOMIC_LOAD(&clock->sequence, LINC_ACQUIRE);
+    if (source == LINC_CLOCK_TSC) {
+        // Split the ticks, so records far from the last resync do not overflow the fixed point product.
+        int64_t elapsed = ticks - LINC_ATOMIC_LOAD(&clock->tsc_base, LINC_RELAXED);
+        int64_t mult = LINC_ATOMIC_LOAD(&clock->tsc_mult, LINC_RELAXED);
+        *nanoseconds = LINC_ATOMIC_LOAD(&clock->tsc_realtime, LINC_RELAXED)
+                       + elapsed / LINC_CLOCK_TSC_UNIT * mult
+                       + elapsed % LINC_CLOCK_TSC_UNIT * mult / LINC_CLOCK_TSC_UNIT;
+    } else {
+        int offset = source == LINC_CLOCK_COARSE ? LINC_CLOCK_COARSE : LINC_CLOCK_MONOTONIC;
+        *nanoseconds = ticks + LINC_ATOMIC_LOAD(&clock->offset[offset], LINC_RELAXED);
+    }
+    LINC_ATOMIC_FENCE(LINC_ACQUIRE);
+    return (sequence & 1U) == 0 && sequence == LINC_ATOMIC_LOAD(&clock->sequence, LINC_RELAXED);
+}
+
+int64_t linc_clock_nanoseconds(int64_t ticks, uint8_t flags) {
+    int64_t nanoseconds = 0;
+    while (!linc_clock_convert(ticks, flags, &nanoseconds)) {
+    }
+    return nanoseconds;
+}
+
+// Same as linc_clock_nanoseconds, but gives up after a few attempts and keeps the last conversion, for signal handlers
+// that may have interrupted a resync which never completes.
+int64_t linc_clock_nanoseconds_bounded(int64_t ticks, uint8_t flags) {
+    int64_t nanoseconds = 0;
+    for (int attempt = 0; attempt < LINC_SPIN_ATTEMPTS && !linc_clock_convert(ticks, flags, &nanoseconds); attempt++) {
+    }
+    return nanoseconds;
+}
+
+// Called by the worker when idle and every LINC_CLOCK_RESYNC_RECORDS records, resyncs once the interval elapsed.
+void linc_clock_resync(bool is_idle) {
+    struct linc_clock_state *clock = &linc.clock;
+    if (is_idle == false && ++clock->records < LINC_CLOCK_RESYNC_RECORDS) {
+        return;
+    }
+    clock->records = 0;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (linc_clock_ns(&now) < clock->resync_at) {
+        return;
+    }
+    clock->resync_at = linc_clock_ns(&now) + (int64_t)LINC_DEFAULT_CLOCK_RESYNC_MS * 1000000L;
+    pthread_mutex_lock(&clock->mutex);
+    linc_clock_update();
+    pthread_mutex_unlock(&clock->mutex);
+}
+
+// ==================================================
+// Public Functions
+// ==================================================
+
+int64_t linc_timestamp(void) {
+    uint8_t flags = 0;
+    int64_t ticks = linc_clock_ticks(&flags);
+    return linc_clock_nanoseconds(ticks, flags);
+}
+
+int linc_set_clock(enum linc_clock source) {
+    linc_init();
+    if (source < LINC_CLOCK_MONOTONIC || source > LINC_CLOCK_TSC) {
+        return -1;
+    }
+#if !defined(CLOCK_MONOTONIC_COARSE) || !defined(CLOCK_REALTIME_COARSE)
+    if (source == LINC_CLOCK_COARSE) {
+        return -1;
+    }
+#endif
+    return linc_clock_select(source);
+}
@@ -1,6 +1,9 @@
 #include "internal/shared.h"
 
+#include <errno.h>
 #include <pthread.h>
+#include <sched.h>
+#include <stddef.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -29,184 +32,681 @@ static pthread_once_t linc_once_init = PTHREAD_ONCE_INIT;
 #endif
 
 static void linc_shutdown(void) {
-    pthread_mutex_lock(&linc.ring_buffer.mutex);
-    linc.ring_buffer.shutdown = true;
-    pthread_mutex_unlock(&linc.ring_buffer.mutex);
-
-    pthread_cond_broadcast(&linc.ring_buffer.produce);
-    pthread_cond_broadcast(&linc.ring_buffer.consume);
-
-    pthread_join(linc.ring_buffer.worker, NULL);
+    for (size_t i = 0; i < LINC_DEFAULT_MAX_THREAD_BUFFERS; i++) {
+        linc_ring_buffer_shutdown(&linc.thread_buffers.list[i].ring);
+    }
+    linc_ring_buffer_shutdown(&linc.ring_buffer);
+    pthread_join(linc.worker, NULL);
 }
 
-static void linc_ring_buffer_init(void) {
-    linc.ring_buffer.size = LINC_DEFAULT_RING_BUFFER_SIZE + 1;
-    linc.ring_buffer.head = 0;
-    linc.ring_buffer.tail = 0;
-    linc.ring_buffer.shutdown = false;
-
-    pthread_mutexattr_t mutex_attr;
-    pthread_condattr_t cond_attr;
-    pthread_mutexattr_init(&mutex_attr);
-    pthread_condattr_init(&cond_attr);
-
-    pthread_mutex_init(&linc.ring_buffer.mutex, &mutex_attr);
-    pthread_cond_init(&linc.ring_buffer.produce, &cond_attr);
-    pthread_cond_init(&linc.ring_buffer.consume, &cond_attr);
+static void linc_thread_buffer_retire(void *arg);
+
+static void linc_worker_init(void) {
+    linc.pipeline = LINC_DEFAULT_PIPELINE;
+    linc.formatting = LINC_DEFAULT_FORMATTING;
+    linc.eviction_requested = false;
+    linc_signal_init(&linc.worker_signal);
+    const char *ring_file = getenv(LINC_RECOVERY_VARIABLE);
+    if (ring_file == NULL || ring_file[0] == '\0'
+        || linc_recovery_map(&linc.ring_buffer, ring_file, LINC_DEFAULT_RING_BUFFER_BYTES, &linc.worker_signal) < 0) {
+        linc_ring_buffer_init(
+            &linc.ring_buffer, linc.ring_bytes, LINC_DEFAULT_RING_BUFFER_BYTES, false, &linc.worker_signal);
+    }
 
-    pthread_mutexattr_destroy(&mutex_attr);
-    pthread_condattr_destroy(&cond_attr);
+    linc.thread_buffers.count = 0;
+    pthread_key_create(&linc.thread_buffers.key, linc_thread_buffer_retire);
+    for (size_t i = 0; i < LINC_DEFAULT_MAX_THREAD_BUFFERS; i++) {
+        struct linc_thread_buffer *buffer = &linc.thread_buffers.list[i];
+        linc_ring_buffer_init(
+            &buffer->ring, buffer->bytes, LINC_DEFAULT_THREAD_BUFFER_BYTES, true, &linc.worker_signal);
+        buffer->state = LINC_THREAD_BUFFER_FREE;
+        buffer->pending = false;
+    }
 
     pthread_attr_t worker_attr;
     pthread_attr_init(&worker_attr);
     pthread_attr_setdetachstate(&worker_attr, PTHREAD_CREATE_JOINABLE);
-    pthread_create(&linc.ring_buffer.worker, &worker_attr, linc_worker, NULL);
+    pthread_create(&linc.worker, &worker_attr, linc_worker, NULL);
     pthread_attr_destroy(&worker_attr);
 }
 
-static void linc_task_sync_init(void) {
-    linc.task_sync.worker_ready = 0;
-    linc.task_sync.sinks_ready = 0;
-    linc.task_sync.worker_ended = 0;
-    linc.task_sync.sinks_ended = 0;
-    linc.task_sync.metadata = NULL;
+static void linc_dispatch_init(void) {
+    linc.dispatch.published = 0;
+    linc.dispatch.shutdown = false;
+    linc_signal_init(&linc.dispatch.produce);
+    linc_signal_init(&linc.dispatch.consume);
+}
+
+LINC_AT_START
+static void linc_bootstrap(void) {
+    memset(&linc, 0, sizeof(linc));
+
+    linc_clock_init();
+    linc_threads_init();
+    linc_layouts_init();
+    linc_dispatch_init();
+    linc_worker_init();
+    linc_default_module = linc_register_default_module(&linc.modules);
+    linc_default_sink = linc_register_default_sink(&linc.sinks);
+
+    atexit(linc_shutdown);
+}
+
+void linc_init(void) {
+    LINC_BOOTSTRAP(&linc_once_init, linc_bootstrap);
+}
+
+// ==================================================
+// Packed State
+// ==================================================
+//
+// Modules and sinks pack their minimum level and their enabled flag in a single integer, a disabled one adds
+// LINC_STATE_DISABLED to its level. Logging reads both with one load and a comparison, setters update their own part
+// with a CAS, so concurrent setters never undo each other.
+
+int linc_state_pack(enum linc_level level, bool enabled) {
+    return (int)level | (enabled == true ? 0 : LINC_STATE_DISABLED);
+}
+
+bool linc_state_accepts(const int *state, enum linc_level level) {
+    return (int)level >= LINC_ATOMIC_LOAD(state, LINC_ACQUIRE);
+}
+
+void linc_state_set_level(int *state, enum linc_level level) {
+    int current = LINC_ATOMIC_LOAD(state, LINC_RELAXED);
+    while (!LINC_ATOMIC_CAS(state, &current, (current & LINC_STATE_DISABLED) | (int)level, LINC_RELEASE)) {
+    }
+}
+
+void linc_state_set_enabled(int *state, bool enabled) {
+    int current = LINC_ATOMIC_LOAD(state, LINC_RELAXED);
+    while (!LINC_ATOMIC_CAS(state, &current, (current & ~LINC_STATE_DISABLED) | (enabled ? 0 : LINC_STATE_DISABLED),
+                            LINC_RELEASE)) {
+    }
+}
+
+// ==================================================
+// Signal
+// ==================================================
+//
+// Wakes up sleeping threads without taking a lock when nobody sleeps. A sleeper registers itself in `waiting` before
+// checking its condition one last time, and a waker publishes its change before reading `waiting`: the full fences
+// on both sides guarantee that either the sleeper sees the change or the waker sees the sleeper.
+
+void linc_signal_init(struct linc_signal *signal) {
+    signal->waiting = 0;
 
     pthread_mutexattr_t mutex_attr;
     pthread_condattr_t cond_attr;
     pthread_mutexattr_init(&mutex_attr);
     pthread_condattr_init(&cond_attr);
+    pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
 
-    pthread_mutex_init(&linc.task_sync.mutex, &mutex_attr);
-    pthread_cond_init(&linc.task_sync.wait_worker, &cond_attr);
-    pthread_cond_init(&linc.task_sync.wait_sinks, &cond_attr);
+    pthread_mutex_init(&signal->mutex, &mutex_attr);
+    pthread_cond_init(&signal->cond, &cond_attr);
 
     pthread_mutexattr_destroy(&mutex_attr);
     pthread_condattr_destroy(&cond_attr);
 }
 
-LINC_AT_START
-static void linc_bootstrap(void) {
-    memset(&linc, 0, sizeof(linc));
+void linc_signal_destroy(struct linc_signal *signal) {
+    pthread_mutex_destroy(&signal->mutex);
+    pthread_cond_destroy(&signal->cond);
+}
 
-    linc_timestamp_offset();
-    linc_ring_buffer_init();
-    linc_task_sync_init();
-    linc_default_module = linc_register_default_module(&linc.modules);
-    linc_default_sink = linc_register_default_sink(&linc.sinks);
+void linc_signal_wake(struct linc_signal *signal) {
+    LINC_ATOMIC_FENCE(LINC_SEQ_CST);
+    if (LINC_ATOMIC_LOAD(&signal->waiting, LINC_RELAXED) == 0) {
+        return;
+    }
+    pthread_mutex_lock(&signal->mutex);
+    pthread_cond_broadcast(&signal->cond);
+    pthread_mutex_unlock(&signal->mutex);
+}
 
-    atexit(linc_shutdown);
+void linc_signal_wait(struct linc_signal *signal, bool (*is_ready)(void *arg), void *arg) {
+    linc_signal_wait_until(signal, is_ready, arg, NULL);
 }
 
-void linc_init(void) {
-    LINC_BOOTSTRAP(&linc_once_init, linc_bootstrap);
+// Same as linc_signal_wait, but gives up at the deadline on the monotonic clock, if any. Returns whether the condition
+// is ready.
+bool linc_signal_wait_until(struct linc_signal *signal,
+                            bool (*is_ready)(void *arg),
+                            void *arg,
+                            const struct timespec *deadline) {
+    for (int attempt = 0; attempt < LINC_SPIN_ATTEMPTS; attempt++) {
+        if (is_ready(arg)) {
+            return true;
+        }
+        sched_yield();
+    }
+
+    pthread_mutex_lock(&signal->mutex);
+    LINC_ATOMIC_FETCH_ADD(&signal->waiting, 1, LINC_SEQ_CST);
+    LINC_ATOMIC_FENCE(LINC_SEQ_CST);
+    bool is_timed_out = false;
+    while (!is_ready(arg) && !is_timed_out) {
+        if (deadline == NULL) {
+            pthread_cond_wait(&signal->cond, &signal->mutex);
+        } else {
+            is_timed_out = pthread_cond_timedwait(&signal->cond, &signal->mutex, deadline) == ETIMEDOUT;
+        }
+    }
+    LINC_ATOMIC_FETCH_ADD(&signal->waiting, -1, LINC_SEQ_CST);
+    pthread_mutex_unlock(&signal->mutex);
+    return !is_timed_out || is_ready(arg);
+}
+
+void linc_deadline(struct timespec *deadline, uint64_t timeout_us) {
+    clock_gettime(CLOCK_MONOTONIC, deadline);
+    uint64_t nanoseconds = (uint64_t)deadline->tv_nsec + (timeout_us % 1000000) * 1000;
+    deadline->tv_sec += (time_t)(timeout_us / 1000000 + nanoseconds / 1000000000);
+    deadline->tv_nsec = (long)(nanoseconds % 1000000000);
+}
+
+// ==================================================
+// Records
+// ==================================================
+
+size_t linc_record_size(size_t message_length) {
+    size_t size = offsetof(struct linc_record, message) + message_length + LINC_ZERO_CHAR_LENGTH;
+    return (size + LINC_RECORD_ALIGNMENT - 1) & ~(size_t)(LINC_RECORD_ALIGNMENT - 1);
+}
+
+void linc_record_encode(struct linc_record *record,
+                        const struct linc_metadata *metadata,
+                        size_t message_length,
+                        uint8_t flags) {
+    record->line = metadata->line;
+    record->timestamp = metadata->timestamp;
+    record->thread = metadata->thread;
+    record->module_name = metadata->module_name;
+    record->filename = metadata->filename;
+    record->func = metadata->func;
+    record->message_length = (uint32_t)message_length;
+    record->level = (uint8_t)metadata->level;
+    record->flags = flags;
+    memcpy(record->message, metadata->message, message_length);
+    record->message[message_length] = '\0';
+}
+
+void linc_record_decode(const struct linc_record *record, struct linc_metadata *metadata) {
+    metadata->timestamp = linc_clock_nanoseconds(record->timestamp, record->flags);
+    metadata->level = (enum linc_level)record->level;
+    metadata->thread_id = linc_record_thread_id(record);
+    metadata->thread = record->thread;
+    metadata->module_name = record->module_name;
+    metadata->filename = record->filename;
+    metadata->line = record->line;
+    metadata->func = record->func;
+    if ((record->flags & LINC_RECORD_DEFERRED) != 0) {
+        linc_format_render(record->message, metadata->message, sizeof(metadata->message));
+    } else {
+        memcpy(metadata->message, record->message, record->message_length + LINC_ZERO_CHAR_LENGTH);
+    }
+}
+
+// Thread ID of the entry of the record, or the one stored in its last bytes by a thread that found the registry full.
+uintptr_t linc_record_thread_id(const struct linc_record *record) {
+    const struct linc_thread *thread = linc_thread_of(record->thread);
+    if (thread != NULL) {
+        return thread->id;
+    }
+    uintptr_t thread_id = 0;
+    if ((record->flags & LINC_RECORD_THREAD_ID) != 0) {
+        memcpy(&thread_id, (const char *)record + record->length - sizeof(uint64_t), sizeof(thread_id));
+    }
+    return thread_id;
 }
 
 // ==================================================
 // Ring Buffer
 // ==================================================
+//
+// Bounded multi-producer ring buffer of variable-length records. Producers reserve the bytes of a record with a CAS
+// on `head`, fill it and publish it by storing its length, which stays zero until then. The single consumer reads
+// the records in reservation order, zeroes their bytes and advances `tail`, so free bytes are always zero and an
+// unpublished record is never mistaken for a published one. A record that does not fit before the end of the buffer
+// is preceded by a padding record covering the remaining bytes. Threads only take a lock when they have to sleep, on
+// a full or an empty buffer. Per-thread buffers have a single producer and skip the CAS.
+//
+// On a full buffer producers follow the backpressure policy of their log: they wait for space, wait up to a deadline,
+// drop their own record or ask the worker, the only thread allowed to move `tail`, to drop the oldest records.
+//
+// A ring kept in a file for crash recovery also copies `tail` into the file before zeroing the bytes it frees, so a
+// reader of the file always starts at a published record or at zeroes.
+
+struct linc_ring_wait {
+    struct linc_ring_buffer *ring;  // Ring buffer the thread is waiting on
+    size_t position;                // Position the thread is waiting for
+};
+
+static uint32_t *linc_ring_buffer_length(struct linc_ring_buffer *ring, size_t position) {
+    return (uint32_t *)(ring->buffer + position % ring->size);
+}
 
-int linc_ring_buffer_enqueue(struct linc_metadata *metadata) {
-    pthread_mutex_lock(&linc.ring_buffer.mutex);
-    if (linc.ring_buffer.shutdown == true) {
-        pthread_mutex_unlock(&linc.ring_buffer.mutex);
-        return -1;
+static bool linc_ring_buffer_has_space(void *arg) {
+    struct linc_ring_wait *wait = (struct linc_ring_wait *)arg;
+    if (LINC_ATOMIC_LOAD(&wait->ring->shutdown, LINC_ACQUIRE) == true) {
+        return true;
     }
+    return LINC_ATOMIC_LOAD(&wait->ring->tail, LINC_ACQUIRE) >= wait->position;
+}
 
-    size_t entries = (linc.ring_buffer.head + linc.ring_buffer.size - linc.ring_buffer.tail) % linc.ring_buffer.size;
-    while (entries == LINC_DEFAULT_RING_BUFFER_SIZE) {
-        pthread_cond_wait(&linc.ring_buffer.produce, &linc.ring_buffer.mutex);
-        entries = (linc.ring_buffer.head + linc.ring_buffer.size - linc.ring_buffer.tail) % linc.ring_buffer.size;
+static bool linc_ring_buffer_is_evicted(void *arg) {
+    struct linc_ring_wait *wait = (struct linc_ring_wait *)arg;
+    return linc_ring_buffer_has_space(arg) || LINC_ATOMIC_LOAD(&wait->ring->evict, LINC_ACQUIRE) == 0;
+}
 
-        if (linc.ring_buffer.shutdown == true) {
-            pthread_mutex_unlock(&linc.ring_buffer.mutex);
-            return -1;
+static void linc_ring_buffer_request_eviction(struct linc_ring_buffer *ring, size_t position) {
+    size_t current = LINC_ATOMIC_LOAD(&ring->evict, LINC_RELAXED);
+    while (current < position && !LINC_ATOMIC_CAS(&ring->evict, &current, position, LINC_RELEASE)) {
+    }
+    LINC_ATOMIC_STORE(&linc.eviction_requested, true, LINC_RELEASE);
+    linc_signal_wake(ring->consume);
+    linc_signal_wake(&linc.dispatch.produce);
+}
+
+static bool linc_ring_buffer_has_entry(void *arg) {
+    struct linc_ring_wait *wait = (struct linc_ring_wait *)arg;
+    if (LINC_ATOMIC_LOAD(&wait->ring->shutdown, LINC_ACQUIRE) == true) {
+        return true;
+    }
+    return LINC_ATOMIC_LOAD(linc_ring_buffer_length(wait->ring, wait->position), LINC_ACQUIRE) != 0;
+}
+
+static void linc_ring_buffer_mirror(struct linc_ring_buffer *ring, size_t tail) {
+    if (ring->recovery_tail != NULL) {
+        LINC_ATOMIC_STORE(ring->recovery_tail, (uint64_t)tail, LINC_RELEASE);
+    }
+}
+
+void linc_ring_buffer_init(struct linc_ring_buffer *ring,
+                           unsigned char *bytes,
+                           size_t size,
+                           bool single_producer,
+                           struct linc_signal *consume) {
+    ring->buffer = bytes;
+    ring->size = size;
+    ring->single_producer = single_producer;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->shutdown = false;
+    ring->evict = 0;
+    ring->consume = consume;
+    ring->recovery_tail = NULL;
+    memset(ring->buffer, 0, size);
+    linc_signal_init(&ring->produce);
+}
+
+void linc_ring_buffer_destroy(struct linc_ring_buffer *ring) {
+    linc_signal_destroy(&ring->produce);
+}
+
+void linc_ring_buffer_shutdown(struct linc_ring_buffer *ring) {
+    LINC_ATOMIC_STORE(&ring->shutdown, true, LINC_SEQ_CST);
+
+    pthread_mutex_lock(&ring->produce.mutex);
+    pthread_cond_broadcast(&ring->produce.cond);
+    pthread_mutex_unlock(&ring->produce.mutex);
+
+    pthread_mutex_lock(&ring->consume->mutex);
+    pthread_cond_broadcast(&ring->consume->cond);
+    pthread_mutex_unlock(&ring->consume->mutex);
+}
+
+struct linc_record *linc_ring_buffer_reserve(struct linc_ring_buffer *ring,
+                                             size_t size,
+                                             enum linc_backpressure backpressure,
+                                             uint32_t timeout_us) {
+    struct timespec deadline;
+    bool has_deadline = false;
+    size_t position = LINC_ATOMIC_LOAD(&ring->head, LINC_RELAXED);
+    while (true) {
+        if (LINC_ATOMIC_LOAD(&ring->shutdown, LINC_ACQUIRE) == true) {
+            return NULL;
+        }
+
+        size_t offset = position % ring->size;
+        size_t padding = offset + size > ring->size ? ring->size - offset : 0;
+        size_t end = position + padding + size;
+        if (end - LINC_ATOMIC_LOAD(&ring->tail, LINC_ACQUIRE) > ring->size) {
+            struct linc_ring_wait wait = {.ring = ring, .position = end - ring->size};
+            if (backpressure == LINC_BACKPRESSURE_DROP_NEWEST) {
+                return NULL;
+            } else if (backpressure == LINC_BACKPRESSURE_BLOCK_TIMEOUT) {
+                if (has_deadline == false) {
+                    linc_deadline(&deadline, timeout_us);
+                    has_deadline = true;
+                }
+                if (!linc_signal_wait_until(&ring->produce, linc_ring_buffer_has_space, &wait, &deadline)) {
+                    return NULL;
+                }
+            } else if (backpressure == LINC_BACKPRESSURE_OVERWRITE_OLDEST) {
+                linc_ring_buffer_request_eviction(ring, wait.position);
+                linc_signal_wait(&ring->produce, linc_ring_buffer_is_evicted, &wait);
+            } else {
+                linc_signal_wait(&ring->produce, linc_ring_buffer_has_space, &wait);
+            }
+            position = LINC_ATOMIC_LOAD(&ring->head, LINC_RELAXED);
+            continue;
+        }
+
+        if (ring->single_producer) {
+            LINC_ATOMIC_STORE(&ring->head, end, LINC_RELAXED);
+        } else if (!LINC_ATOMIC_CAS(&ring->head, &position, end, LINC_RELAXED)) {
+            continue;
+        }
+
+        if (padding > 0) {
+            LINC_ATOMIC_STORE(
+                linc_ring_buffer_length(ring, position), (uint32_t)padding | LINC_RECORD_PADDING, LINC_RELEASE);
+            position += padding;
+        }
+        return (struct linc_record *)(ring->buffer + position % ring->size);
+    }
+}
+
+void linc_ring_buffer_commit(struct linc_ring_buffer *ring, struct linc_record *record, size_t size) {
+    LINC_ATOMIC_STORE(&record->length, (uint32_t)size, LINC_RELEASE);
+    linc_signal_wake(ring->consume);
+}
+
+struct linc_record *linc_ring_buffer_peek(struct linc_ring_buffer *ring) {
+    while (true) {
+        size_t position = ring->tail;
+        uint32_t *length = linc_ring_buffer_length(ring, position);
+        uint32_t value = LINC_ATOMIC_LOAD(length, LINC_ACQUIRE);
+        if (value == 0) {
+            return NULL;
+        }
+        if ((value & LINC_RECORD_PADDING) == 0) {
+            return (struct linc_record *)length;
+        }
+        size_t tail = position + (value & ~LINC_RECORD_PADDING);
+        linc_ring_buffer_mirror(ring, tail);
+        *length = 0;
+        LINC_ATOMIC_STORE(&ring->tail, tail, LINC_RELEASE);
+    }
+}
+
+void linc_ring_buffer_release(struct linc_ring_buffer *ring) {
+    size_t position = ring->tail;
+    struct linc_record *record = (struct linc_record *)linc_ring_buffer_length(ring, position);
+    size_t size = record->length;
+    linc_ring_buffer_mirror(ring, position + size);
+    memset(record, 0, size);
+    LINC_ATOMIC_STORE(&ring->tail, position + size, LINC_RELEASE);
+    linc_signal_wake(&ring->produce);
+}
+
+// Drops the oldest records until `tail` reaches the position requested by producers or no published record is left,
+// then lets the producers try again.
+void linc_ring_buffer_evict(struct linc_ring_buffer *ring, void (*drop)(struct linc_record *record)) {
+    size_t position = LINC_ATOMIC_LOAD(&ring->evict, LINC_ACQUIRE);
+    if (position == 0) {
+        return;
+    }
+    while (ring->tail < position) {
+        struct linc_record *record = linc_ring_buffer_peek(ring);
+        if (record == NULL) {
+            break;
         }
+        drop(record);
+        linc_ring_buffer_release(ring);
     }
+    LINC_ATOMIC_STORE(&ring->evict, 0, LINC_RELEASE);
+    linc_signal_wake(&ring->produce);
+}
+
+// Every position claimed by producers was consumed, including those still being published.
+bool linc_ring_buffer_is_empty(struct linc_ring_buffer *ring) {
+    return LINC_ATOMIC_LOAD(&ring->head, LINC_ACQUIRE) == ring->tail;
+}
 
-    linc.ring_buffer.buffer[linc.ring_buffer.head] = *metadata;
-    linc.ring_buffer.head = (linc.ring_buffer.head + 1) % linc.ring_buffer.size;
+bool linc_ring_buffer_is_drained(struct linc_ring_buffer *ring) {
+    bool is_shutdown = LINC_ATOMIC_LOAD(&ring->shutdown, LINC_ACQUIRE);
+    return is_shutdown == true && linc_ring_buffer_is_empty(ring);
+}
 
-    pthread_cond_broadcast(&linc.ring_buffer.consume);
-    pthread_mutex_unlock(&linc.ring_buffer.mutex);
+int linc_ring_buffer_push(struct linc_ring_buffer *ring,
+                          const struct linc_metadata *metadata,
+                          size_t message_length,
+                          uint8_t flags,
+                          enum linc_backpressure backpressure,
+                          uint32_t timeout_us) {
+    // A ring kept in a file also stores what another process needs to read the record after the message.
+    // A thread without an entry in the registry stores its thread ID in the last bytes of the record.
+    size_t recovery_length = ring->recovery_tail != NULL ? linc_recovery_length(metadata) : 0;
+    size_t size = linc_record_size(message_length + recovery_length);
+    if (metadata->thread == 0) {
+        flags |= LINC_RECORD_THREAD_ID;
+        size += sizeof(uint64_t);
+    }
+    struct linc_record *record = linc_ring_buffer_reserve(ring, size, backpressure, timeout_us);
+    if (record == NULL) {
+        return -1;
+    }
+    linc_record_encode(record, metadata, message_length, flags);
+    if (recovery_length > 0) {
+        linc_recovery_encode(record, metadata, flags);
+    }
+    if (metadata->thread == 0) {
+        uint64_t thread_id = (uint64_t)metadata->thread_id;
+        memcpy((char *)record + size - sizeof(thread_id), &thread_id, sizeof(thread_id));
+    }
+    linc_ring_buffer_commit(ring, record, size);
     return 0;
 }
 
+int linc_ring_buffer_pop(struct linc_ring_buffer *ring, struct linc_metadata *metadata) {
+    struct linc_record *record = linc_ring_buffer_peek(ring);
+    while (record == NULL) {
+        if (linc_ring_buffer_is_drained(ring)) {
+            return -1;
+        }
+        struct linc_ring_wait wait = {.ring = ring, .position = ring->tail};
+        linc_signal_wait(ring->consume, linc_ring_buffer_has_entry, &wait);
+        record = linc_ring_buffer_peek(ring);
+        if (record == NULL && LINC_ATOMIC_LOAD(&ring->shutdown, LINC_ACQUIRE) == true) {
+            // A producer reserved its record before the shutdown and is still publishing it.
+            sched_yield();
+        }
+    }
+
+    linc_record_decode(record, metadata);
+    linc_ring_buffer_release(ring);
+    return 0;
+}
+
+int linc_ring_buffer_enqueue(struct linc_metadata *metadata,
+                             size_t message_length,
+                             uint8_t flags,
+                             enum linc_backpressure backpressure,
+                             uint32_t timeout_us) {
+    return linc_ring_buffer_push(&linc.ring_buffer, metadata, message_length, flags, backpressure, timeout_us);
+}
+
 int linc_ring_buffer_dequeue(struct linc_metadata *metadata) {
-    pthread_mutex_lock(&linc.ring_buffer.mutex);
-    size_t entries = (linc.ring_buffer.head + linc.ring_buffer.size - linc.ring_buffer.tail) % linc.ring_buffer.size;
-    if (linc.ring_buffer.shutdown == true && entries == 0) {
-        pthread_mutex_unlock(&linc.ring_buffer.mutex);
-        return -1;
+    return linc_ring_buffer_pop(&linc.ring_buffer, metadata);
+}
+
+// ==================================================
+// Thread Buffers
+// ==================================================
+//
+// In the per-thread pipeline each producer thread lazily claims a single-producer buffer, so logging never writes a
+// cache line shared with other producers. The buffer is retired when the thread exits and freed by the worker once
+// it has been drained. Threads that find no free buffer fall back to the shared ring buffer.
+
+static LINC_THREAD_LOCAL struct linc_thread_buffer *linc_thread_buffer = NULL;
+static LINC_THREAD_LOCAL bool linc_thread_buffer_unavailable = false;
+
+static void linc_thread_buffer_retire(void *arg) {
+    struct linc_thread_buffer *buffer = (struct linc_thread_buffer *)arg;
+    linc_thread_buffer = NULL;
+    linc_thread_buffer_unavailable = true;
+    LINC_ATOMIC_STORE(&buffer->state, LINC_THREAD_BUFFER_RETIRED, LINC_RELEASE);
+    linc_signal_wake(&linc.worker_signal);
+}
+
+struct linc_thread_buffer *linc_thread_buffer_acquire(void) {
+    if (linc_thread_buffer != NULL || linc_thread_buffer_unavailable == true) {
+        return linc_thread_buffer;
     }
 
-    while (entries == 0) {
-        pthread_cond_wait(&linc.ring_buffer.consume, &linc.ring_buffer.mutex);
-        entries = (linc.ring_buffer.head + linc.ring_buffer.size - linc.ring_buffer.tail) % linc.ring_buffer.size;
+    for (size_t i = 0; i < LINC_DEFAULT_MAX_THREAD_BUFFERS; i++) {
+        struct linc_thread_buffer *buffer = &linc.thread_buffers.list[i];
+        int state = LINC_THREAD_BUFFER_FREE;
+        if (!LINC_ATOMIC_CAS(&buffer->state, &state, LINC_THREAD_BUFFER_ACTIVE, LINC_ACQUIRE)) {
+            continue;
+        }
 
-        if (linc.ring_buffer.shutdown == true && entries == 0) {
-            pthread_mutex_unlock(&linc.ring_buffer.mutex);
-            return -1;
+        size_t count = LINC_ATOMIC_LOAD(&linc.thread_buffers.count, LINC_RELAXED);
+        while (count < i + 1 && !LINC_ATOMIC_CAS(&linc.thread_buffers.count, &count, i + 1, LINC_RELEASE)) {
         }
+        pthread_setspecific(linc.thread_buffers.key, buffer);
+        linc_thread_buffer = buffer;
+        return buffer;
     }
 
-    *metadata = linc.ring_buffer.buffer[linc.ring_buffer.tail];
-    memset(&linc.ring_buffer.buffer[linc.ring_buffer.tail], 0, sizeof(struct linc_metadata));
-    linc.ring_buffer.tail = (linc.ring_buffer.tail + 1) % linc.ring_buffer.size;
+    linc_thread_buffer_unavailable = true;
+    return NULL;
+}
 
-    pthread_cond_broadcast(&linc.ring_buffer.produce);
-    pthread_mutex_unlock(&linc.ring_buffer.mutex);
-    return 0;
+void linc_thread_buffer_begin(struct linc_thread_buffer *buffer) {
+    LINC_ATOMIC_STORE(&buffer->pending, true, LINC_RELAXED);
+    LINC_ATOMIC_FENCE(LINC_SEQ_CST);
+}
+
+void linc_thread_buffer_end(struct linc_thread_buffer *buffer) {
+    LINC_ATOMIC_STORE(&buffer->pending, false, LINC_RELEASE);
 }
 
 // ==================================================
-// Task Synchronization
+// Dispatch Ring
 // ==================================================
+//
+// The worker decodes every record once into the dispatch ring, a single-producer ring read by every sink. Each sink
+// thread owns a cursor and runs at its own pace, the worker only waits when the slowest sink is a whole ring behind,
+// and producers only wait when the worker does and their own buffer is full too.
+
+static size_t linc_dispatch_slowest(void) {
+    size_t slowest = linc.dispatch.published;
+    size_t count = LINC_ATOMIC_LOAD(&linc.sinks.count, LINC_ACQUIRE);
+    for (size_t i = 0; i < count; i++) {
+        size_t cursor = LINC_ATOMIC_LOAD(&linc.sinks.list[i].cursor, LINC_ACQUIRE);
+        if (cursor < slowest) {
+            slowest = cursor;
+        }
+    }
+    return slowest;
+}
+
+bool linc_dispatch_has_space(void *arg) {
+    (void)arg;
+    return linc.dispatch.published - linc_dispatch_slowest() < LINC_DEFAULT_DISPATCH_SIZE;
+}
 
-void linc_task_sync_wait_tasks(void) {
-    pthread_mutex_lock(&linc.task_sync.mutex);
-    while (linc.task_sync.sinks_ready < linc.sinks.count) {
-        linc.task_sync.worker_ready++;
-        pthread_cond_wait(&linc.task_sync.wait_sinks, &linc.task_sync.mutex);
-        linc.task_sync.worker_ready--;
+bool linc_dispatch_is_drained(void) {
+    return linc_dispatch_slowest() == linc.dispatch.published;
+}
+
+// Every sink wrote the records published before the position.
+bool linc_dispatch_is_past(size_t position) {
+    return linc_dispatch_slowest() >= position;
+}
+
+static bool linc_dispatch_has_record(void *arg) {
+    size_t cursor = *(size_t *)arg;
+    if (LINC_ATOMIC_LOAD(&linc.dispatch.shutdown, LINC_ACQUIRE) == true) {
+        return true;
     }
-    linc.task_sync.sinks_ready = 0;
-    linc.task_sync.worker_ready = 0;
-    linc.task_sync.metadata = NULL;
-    pthread_mutex_unlock(&linc.task_sync.mutex);
+    return LINC_ATOMIC_LOAD(&linc.dispatch.published, LINC_ACQUIRE) != cursor;
 }
 
-void linc_task_sync_wait_worker(void) {
-    pthread_mutex_lock(&linc.task_sync.mutex);
-    linc.task_sync.sinks_ready++;
-    if (linc.task_sync.sinks_ready == linc.sinks.count && linc.task_sync.worker_ready == 1) {
-        pthread_cond_signal(&linc.task_sync.wait_sinks);
+struct linc_metadata *linc_dispatch_claim(void) {
+    if (!linc_dispatch_has_space(NULL)) {
+        linc_signal_wait(&linc.dispatch.produce, linc_dispatch_has_space, NULL);
+    }
+    // Every sink is done with the slot, its texts are rendered again for the new record.
+    size_t slot = linc.dispatch.published % LINC_DEFAULT_DISPATCH_SIZE;
+    for (size_t i = 0; i < LINC_DEFAULT_SHARED_LAYOUTS; i++) {
+        LINC_ATOMIC_STORE(&linc.dispatch.states[slot][i], LINC_DISPATCH_TEXT_EMPTY, LINC_RELAXED);
     }
-    pthread_cond_wait(&linc.task_sync.wait_worker, &linc.task_sync.mutex);
-    pthread_mutex_unlock(&linc.task_sync.mutex);
+    return &linc.dispatch.slots[slot];
 }
 
-void linc_task_sync_signal_tasks(void) {
-    pthread_mutex_lock(&linc.task_sync.mutex);
-    pthread_cond_broadcast(&linc.task_sync.wait_worker);
-    while (linc.task_sync.sinks_ended < linc.sinks.count) {
-        linc.task_sync.worker_ended++;
-        pthread_cond_wait(&linc.task_sync.wait_sinks, &linc.task_sync.mutex);
-        linc.task_sync.worker_ended--;
+void linc_dispatch_publish(void) {
+    LINC_ATOMIC_STORE(&linc.dispatch.published, linc.dispatch.published + 1, LINC_RELEASE);
+    linc_signal_wake(&linc.dispatch.consume);
+}
+
+void linc_dispatch_shutdown(void) {
+    LINC_ATOMIC_STORE(&linc.dispatch.shutdown, true, LINC_SEQ_CST);
+
+    pthread_mutex_lock(&linc.dispatch.consume.mutex);
+    pthread_cond_broadcast(&linc.dispatch.consume.cond);
+    pthread_mutex_unlock(&linc.dispatch.consume.mutex);
+}
+
+size_t linc_dispatch_wait(size_t cursor) {
+    while (true) {
+        size_t published = LINC_ATOMIC_LOAD(&linc.dispatch.published, LINC_ACQUIRE);
+        if (published != cursor) {
+            return published;
+        }
+        if (LINC_ATOMIC_LOAD(&linc.dispatch.shutdown, LINC_ACQUIRE) == true) {
+            return LINC_ATOMIC_LOAD(&linc.dispatch.published, LINC_ACQUIRE);
+        }
+        linc_signal_wait(&linc.dispatch.consume, linc_dispatch_has_record, &cursor);
+    }
+}
+
+// Same as linc_dispatch_wait, but gives up at the deadline on the monotonic clock and returns the cursor then.
+size_t linc_dispatch_wait_until(size_t cursor, const struct timespec *deadline) {
+    linc_signal_wait_until(&linc.dispatch.consume, linc_dispatch_has_record, &cursor, deadline);
+    return LINC_ATOMIC_LOAD(&linc.dispatch.published, LINC_ACQUIRE);
+}
+
+struct linc_dispatch_batch {
+    size_t cursor;  // Sequence of the next record read by the sink
+    size_t count;   // Number of records the sink is waiting for
+};
+
+static bool linc_dispatch_has_batch(void *arg) {
+    struct linc_dispatch_batch *batch = (struct linc_dispatch_batch *)arg;
+    if (LINC_ATOMIC_LOAD(&linc.dispatch.shutdown, LINC_ACQUIRE) == true) {
+        return true;
     }
-    linc.task_sync.sinks_ended = 0;
-    linc.task_sync.worker_ended = 0;
-    linc.task_sync.metadata = NULL;
-    pthread_cond_broadcast(&linc.task_sync.wait_worker);
-    pthread_mutex_unlock(&linc.task_sync.mutex);
+    return LINC_ATOMIC_LOAD(&linc.dispatch.published, LINC_ACQUIRE) - batch->cursor >= batch->count;
 }
 
-void linc_task_sync_signal_worker(void) {
-    pthread_mutex_lock(&linc.task_sync.mutex);
-    linc.task_sync.sinks_ended++;
-    if (linc.task_sync.sinks_ended == linc.sinks.count && linc.task_sync.worker_ended == 1) {
-        pthread_cond_signal(&linc.task_sync.wait_sinks);
+// Waits up to the given latency for a whole batch of records to be published, then returns what has been published.
+size_t linc_dispatch_wait_batch(size_t cursor, size_t count, uint32_t latency_us) {
+    struct linc_dispatch_batch batch = {.cursor = cursor, .count = count};
+    if (!linc_dispatch_has_batch(&batch)) {
+        struct timespec deadline;
+        linc_deadline(&deadline, latency_us);
+        linc_signal_wait_until(&linc.dispatch.consume, linc_dispatch_has_batch, &batch, &deadline);
     }
+    return LINC_ATOMIC_LOAD(&linc.dispatch.published, LINC_ACQUIRE);
+}
 
-    pthread_cond_wait(&linc.task_sync.wait_worker, &linc.task_sync.mutex);
-    pthread_mutex_unlock(&linc.task_sync.mutex);
+void linc_dispatch_advance(struct linc_sink *sink, size_t cursor) {
+    LINC_ATOMIC_STORE(&sink->cursor, cursor, LINC_RELEASE);
+    linc_signal_wake(&linc.dispatch.produce);
+}
+
+// ==================================================
+// Public Functions
+// ==================================================
+
+int linc_set_pipeline(enum linc_pipeline pipeline) {
+    linc_init();
+    if (pipeline != LINC_PIPELINE_SHARED && pipeline != LINC_PIPELINE_PER_THREAD) {
+        return -1;
+    }
+    LINC_ATOMIC_STORE(&linc.pipeline, pipeline, LINC_RELEASE);
+    return 0;
 }
@@ -0,0 +1,412 @@
+#include "internal/shared.h"
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// ==================================================
+// Deferred Formatting
+// ==================================================
+//
+// With deferred formatting the producer thread walks the format string once and copies the raw bytes of every
+// argument, the format pointer first, into the message of the record. The worker walks the format string again and
+// formats each conversion with snprintf, so the text is byte-identical to vsnprintf. Strings are copied, since the
+// caller may free or reuse them as soon as the log returns. Conversions that cannot be captured, e.g., %n, positional
+// or wide arguments, and arguments that do not fit in a message make the producer fall back to eager formatting.
+
+#define LINC_FORMAT_SPEC_LENGTH 32          // Maximum length of a single conversion specification
+#define LINC_FORMAT_NULL_STRING UINT32_MAX  // Length marking a NULL string argument
+
+enum linc_format_arg {
+    LINC_FORMAT_ARG_NONE,         // No argument, e.g., %%
+    LINC_FORMAT_ARG_INT,          // int, also char and short promoted to int
+    LINC_FORMAT_ARG_UINT,         // unsigned int
+    LINC_FORMAT_ARG_LONG,         // long
+    LINC_FORMAT_ARG_ULONG,        // unsigned long
+    LINC_FORMAT_ARG_LLONG,        // long long
+    LINC_FORMAT_ARG_ULLONG,       // unsigned long long
+    LINC_FORMAT_ARG_INTMAX,       // intmax_t
+    LINC_FORMAT_ARG_UINTMAX,      // uintmax_t
+    LINC_FORMAT_ARG_SIZE,         // size_t
+    LINC_FORMAT_ARG_PTRDIFF,      // ptrdiff_t
+    LINC_FORMAT_ARG_DOUBLE,       // double, also float promoted to double
+    LINC_FORMAT_ARG_LDOUBLE,      // long double
+    LINC_FORMAT_ARG_POINTER,      // void *
+    LINC_FORMAT_ARG_STRING,       // const char *, copied with its zero character
+    LINC_FORMAT_ARG_UNSUPPORTED,  // Conversion that cannot be deferred
+};
+
+struct linc_format_spec {
+    const char *start;         // Position of the % character in the format string
+    size_t length;             // Length of the conversion specification
+    bool star_width;           // Width is passed as an int argument
+    bool star_precision;       // Precision is passed as an int argument
+    long precision;            // Precision written in the format string, -1 if missing
+    enum linc_format_arg arg;  // Type of the converted argument
+};
+
+static enum linc_format_arg linc_format_integer(const char *length, bool is_signed) {
+    if (length[0] == '\0' || length[0] == 'h') {
+        return is_signed ? LINC_FORMAT_ARG_INT : LINC_FORMAT_ARG_UINT;
+    } else if (length[0] == 'l' && length[1] == 'l') {
+        return is_signed ? LINC_FORMAT_ARG_LLONG : LINC_FORMAT_ARG_ULLONG;
+    } else if (length[0] == 'l') {
+        return is_signed ? LINC_FORMAT_ARG_LONG : LINC_FORMAT_ARG_ULONG;
+    } else if (length[0] == 'j') {
+        return is_signed ? LINC_FORMAT_ARG_INTMAX : LINC_FORMAT_ARG_UINTMAX;
+    } else if (length[0] == 'z') {
+        return LINC_FORMAT_ARG_SIZE;
+    } else if (length[0] == 't') {
+        return LINC_FORMAT_ARG_PTRDIFF;
+    }
+    return LINC_FORMAT_ARG_UNSUPPORTED;
+}
+
+// Parses the conversion specification starting at the % character and returns the position right after it.
+static const char *linc_format_parse(const char *cursor, struct linc_format_spec *spec) {
+    const char *position = cursor + 1;
+    spec->start = cursor;
+    spec->star_width = false;
+    spec->star_precision = false;
+    spec->precision = -1;
+    spec->arg = LINC_FORMAT_ARG_UNSUPPORTED;
+
+    while (*position != '\0' && strchr("-+ #0'", *position) != NULL) {
+        position++;
+    }
+    if (*position == '*') {
+        spec->star_width = true;
+        position++;
+    } else {
+        while (*position >= '0' && *position <= '9') {
+            position++;
+        }
+        if (*position == '$') {
+            spec->length = (size_t)(position - cursor);
+            return position;
+        }
+    }
+    if (*position == '.') {
+        position++;
+        if (*position == '*') {
+            spec->star_precision = true;
+            position++;
+        } else {
+            spec->precision = 0;
+            while (*position >= '0' && *position <= '9') {
+                spec->precision = spec->precision * 10 + (*position - '0');
+                position++;
+            }
+        }
+    }
+
+    char length[3] = {0};
+    if (*position != '\0' && strchr("hljztL", *position) != NULL) {
+        length[0] = *position++;
+        if ((length[0] == 'h' || length[0] == 'l') && *position == length[0]) {
+            length[1] = *position++;
+        }
+    }
+
+    char conversion = *position;
+    if (conversion != '\0') {
+        position++;
+    }
+    spec->length = (size_t)(position - cursor);
+
+    switch (conversion) {
+        case 'd':
+        case 'i':
+            spec->arg = linc_format_integer(length, true);
+            break;
+        case 'o':
+        case 'u':
+        case 'x':
+        case 'X':
+            spec->arg = linc_format_integer(length, false);
+            break;
+        case 'c':
+            spec->arg = length[0] == '\0' ? LINC_FORMAT_ARG_INT : LINC_FORMAT_ARG_UNSUPPORTED;
+            break;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            if (length[0] == '\0' || (length[0] == 'l' && length[1] == '\0')) {
+                spec->arg = LINC_FORMAT_ARG_DOUBLE;
+            } else if (length[0] == 'L') {
+                spec->arg = LINC_FORMAT_ARG_LDOUBLE;
+            }
+            break;
+        case 's':
+            spec->arg = length[0] == '\0' ? LINC_FORMAT_ARG_STRING : LINC_FORMAT_ARG_UNSUPPORTED;
+            break;
+        case 'p':
+            spec->arg = length[0] == '\0' ? LINC_FORMAT_ARG_POINTER : LINC_FORMAT_ARG_UNSUPPORTED;
+            break;
+        case '%':
+            spec->arg = spec->length == 2 ? LINC_FORMAT_ARG_NONE : LINC_FORMAT_ARG_UNSUPPORTED;
+            break;
+        default:
+            break;
+    }
+
+    if (spec->length >= LINC_FORMAT_SPEC_LENGTH) {
+        spec->arg = LINC_FORMAT_ARG_UNSUPPORTED;
+    }
+    return position;
+}
+
+// ==================================================
+// Capture
+// ==================================================
+
+#define LINC_FORMAT_CAPTURE(type)                          \
+    {                                                      \
+        type value = va_arg(args, type);                   \
+        if (position + sizeof(value) > size) {             \
+            return -1;                                     \
+        }                                                  \
+        memcpy(payload + position, &value, sizeof(value)); \
+        position += sizeof(value);                         \
+        break;                                             \
+    }
+
+int linc_format_capture(char *payload, size_t size, const char *format, va_list args) {
+    size_t position = 0;
+    if (sizeof(format) > size) {
+        return -1;
+    }
+    memcpy(payload, &format, sizeof(format));
+    position += sizeof(format);
+
+    const char *cursor = strchr(format, '%');
+    while (cursor != NULL) {
+        struct linc_format_spec spec;
+        cursor = linc_format_parse(cursor, &spec);
+        if (spec.arg == LINC_FORMAT_ARG_UNSUPPORTED) {
+            return -1;
+        }
+
+        long precision = spec.precision;
+        if (spec.star_width) {
+            int width = va_arg(args, int);
+            if (position + sizeof(width) > size) {
+                return -1;
+            }
+            memcpy(payload + position, &width, sizeof(width));
+            position += sizeof(width);
+        }
+        if (spec.star_precision) {
+            int value = va_arg(args, int);
+            if (position + sizeof(value) > size) {
+                return -1;
+            }
+            memcpy(payload + position, &value, sizeof(value));
+            position += sizeof(value);
+            precision = value;
+        }
+
+        switch (spec.arg) {
+            case LINC_FORMAT_ARG_INT:
+                LINC_FORMAT_CAPTURE(int)
+            case LINC_FORMAT_ARG_UINT:
+                LINC_FORMAT_CAPTURE(unsigned int)
+            case LINC_FORMAT_ARG_LONG:
+                LINC_FORMAT_CAPTURE(long)
+            case LINC_FORMAT_ARG_ULONG:
+                LINC_FORMAT_CAPTURE(unsigned long)
+            case LINC_FORMAT_ARG_LLONG:
+                LINC_FORMAT_CAPTURE(long long)
+            case LINC_FORMAT_ARG_ULLONG:
+                LINC_FORMAT_CAPTURE(unsigned long long)
+            case LINC_FORMAT_ARG_INTMAX:
+                LINC_FORMAT_CAPTURE(intmax_t)
+            case LINC_FORMAT_ARG_UINTMAX:
+                LINC_FORMAT_CAPTURE(uintmax_t)
+            case LINC_FORMAT_ARG_SIZE:
+                LINC_FORMAT_CAPTURE(size_t)
+            case LINC_FORMAT_ARG_PTRDIFF:
+                LINC_FORMAT_CAPTURE(ptrdiff_t)
+            case LINC_FORMAT_ARG_DOUBLE:
+                LINC_FORMAT_CAPTURE(double)
+            case LINC_FORMAT_ARG_LDOUBLE:
+                LINC_FORMAT_CAPTURE(long double)
+            case LINC_FORMAT_ARG_POINTER:
+                LINC_FORMAT_CAPTURE(void *)
+            case LINC_FORMAT_ARG_STRING: {
+                const char *value = va_arg(args, const char *);
+                uint32_t length = LINC_FORMAT_NULL_STRING;
+                size_t available = size - position;
+                if (sizeof(length) > available) {
+                    return -1;
+                }
+                available -= sizeof(length);
+                if (value != NULL) {
+                    // Only the bytes the conversion can print are read, the string may not be terminated.
+                    size_t limit = precision >= 0 && (size_t)precision < available ? (size_t)precision : available;
+                    size_t bytes = strnlen(value, limit);
+                    if (bytes >= available) {
+                        return -1;
+                    }
+                    length = (uint32_t)bytes;
+                }
+                memcpy(payload + position, &length, sizeof(length));
+                position += sizeof(length);
+                if (value != NULL) {
+                    memcpy(payload + position, value, length);
+                    payload[position + length] = '\0';
+                    position += length + LINC_ZERO_CHAR_LENGTH;
+                }
+                break;
+            }
+            default:
+                break;
+        }
+        cursor = strchr(cursor, '%');
+    }
+    return (int)position;
+}
+
+// ==================================================
+// Render
+// ==================================================
+
+static void linc_format_append(char *buffer, size_t size, size_t *written, const char *text, size_t length) {
+    if (*written + 1 < size) {
+        size_t available = size - *written - 1;
+        memcpy(buffer + *written, text, length < available ? length : available);
+    }
+    *written += length;
+}
+
+#define LINC_FORMAT_EMIT(value)                                                   \
+    if (spec.star_width && spec.star_precision) {                                 \
+        result = snprintf(destination, available, text, width, precision, value); \
+    } else if (spec.star_width) {                                                 \
+        result = snprintf(destination, available, text, width, value);            \
+    } else if (spec.star_precision) {                                             \
+        result = snprintf(destination, available, text, precision, value);        \
+    } else {                                                                      \
+        result = snprintf(destination, available, text, value);                   \
+    }
+
+#define LINC_FORMAT_RENDER(type)                           \
+    {                                                      \
+        type value;                                        \
+        memcpy(&value, payload + position, sizeof(value)); \
+        position += sizeof(value);                         \
+        LINC_FORMAT_EMIT(value)                            \
+        break;                                             \
+    }
+
+int linc_format_render(const char *payload, char *buffer, size_t size) {
+    const char *format;
+    size_t position = 0;
+    memcpy(&format, payload, sizeof(format));
+    position += sizeof(format);
+
+    size_t written = 0;
+    const char *cursor = format;
+    while (true) {
+        const char *next = strchr(cursor, '%');
+        size_t literal = next != NULL ? (size_t)(next - cursor) : strlen(cursor);
+        linc_format_append(buffer, size, &written, cursor, literal);
+        if (next == NULL) {
+            break;
+        }
+
+        struct linc_format_spec spec;
+        cursor = linc_format_parse(next, &spec);
+        if (spec.arg == LINC_FORMAT_ARG_NONE) {
+            linc_format_append(buffer, size, &written, "%", 1);
+            continue;
+        }
+
+        char text[LINC_FORMAT_SPEC_LENGTH];
+        memcpy(text, spec.start, spec.length);
+        text[spec.length] = '\0';
+
+        int width = 0;
+        int precision = 0;
+        if (spec.star_width) {
+            memcpy(&width, payload + position, sizeof(width));
+            position += sizeof(width);
+        }
+        if (spec.star_precision) {
+            memcpy(&precision, payload + position, sizeof(precision));
+            position += sizeof(precision);
+        }
+
+        char *destination = written < size ? buffer + written : NULL;
+        size_t available = written < size ? size - written : 0;
+        int result = 0;
+        switch (spec.arg) {
+            case LINC_FORMAT_ARG_INT:
+                LINC_FORMAT_RENDER(int)
+            case LINC_FORMAT_ARG_UINT:
+                LINC_FORMAT_RENDER(unsigned int)
+            case LINC_FORMAT_ARG_LONG:
+                LINC_FORMAT_RENDER(long)
+            case LINC_FORMAT_ARG_ULONG:
+                LINC_FORMAT_RENDER(unsigned long)
+            case LINC_FORMAT_ARG_LLONG:
+                LINC_FORMAT_RENDER(long long)
+            case LINC_FORMAT_ARG_ULLONG:
+                LINC_FORMAT_RENDER(unsigned long long)
+            case LINC_FORMAT_ARG_INTMAX:
+                LINC_FORMAT_RENDER(intmax_t)
+            case LINC_FORMAT_ARG_UINTMAX:
+                LINC_FORMAT_RENDER(uintmax_t)
+            case LINC_FORMAT_ARG_SIZE:
+                LINC_FORMAT_RENDER(size_t)
+            case LINC_FORMAT_ARG_PTRDIFF:
+                LINC_FORMAT_RENDER(ptrdiff_t)
+            case LINC_FORMAT_ARG_DOUBLE:
+                LINC_FORMAT_RENDER(double)
+            case LINC_FORMAT_ARG_LDOUBLE:
+                LINC_FORMAT_RENDER(long double)
+            case LINC_FORMAT_ARG_POINTER:
+                LINC_FORMAT_RENDER(void *)
+            case LINC_FORMAT_ARG_STRING: {
+                uint32_t length;
+                memcpy(&length, payload + position, sizeof(length));
+                position += sizeof(length);
+                const char *value = NULL;
+                if (length != LINC_FORMAT_NULL_STRING) {
+                    value = payload + position;
+                    position += length + LINC_ZERO_CHAR_LENGTH;
+                }
+                LINC_FORMAT_EMIT(value)
+                break;
+            }
+            default:
+                break;
+        }
+        written += result > 0 ? (size_t)result : 0;
+    }
+
+    if (size > 0) {
+        buffer[written < size ? written : size - 1] = '\0';
+    }
+    return (int)written;
+}
+
+// ==================================================
+// Public Functions
+// ==================================================
+
+int linc_set_formatting(enum linc_formatting formatting) {
+    linc_init();
+    if (formatting != LINC_FORMATTING_EAGER && formatting != LINC_FORMATTING_DEFERRED) {
+        return -1;
+    }
+    LINC_ATOMIC_STORE(&linc.formatting, formatting, LINC_RELEASE);
+    return 0;
+}
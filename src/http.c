@@ -0,0 +1,536 @@
+#include "internal/shared.h"
+#include "linc.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+// ==================================================
+// HTTP Sinks
+// ==================================================
+//
+// An HTTP sink renders each log with the JSON layout and gathers the logs of many batches into the body of a POST
+// request, a JSON array or JSON lines, sent once the body is full or once the flush delay passed. Requests go over a
+// single persistent connection, opened on the first log, and are pipelined: up to `pipeline` requests are sent before
+// the sink waits for the response of the oldest one, whose slot then holds the next body. Responses are only parsed
+// for their status and length, a status other than 2xx drops the logs of the request.
+//
+// A connection that fails, times out or is closed by the server is closed, and the requests it did not answer are sent
+// again on the next one, so a log may be received twice. Connection attempts after a failure wait from
+// LINC_SINK_HTTP_MIN_BACKOFF_MS up to LINC_DEFAULT_HTTP_MAX_BACKOFF_MS, doubling each time, and until the server is
+// reachable the oldest request is dropped whenever a new body needs its slot. The sink thread never waits more than
+// LINC_SINK_HTTP_TIMEOUT_MS for a server that makes no progress.
+//
+// Each slot holds the bodies of LINC_DEFAULT_HTTP_PIPELINE requests of LINC_DEFAULT_HTTP_BATCH_BYTES. With
+// LINC_DEFAULT_MAX_NETWORK_SINKS set to 0, HTTP sinks are compiled out and linc_sink_http_funcs returns functions that
+// fail to register.
+
+#if LINC_DEFAULT_MAX_NETWORK_SINKS > 0
+
+static struct linc_sink_http_list linc_sink_https = {.mutex = PTHREAD_MUTEX_INITIALIZER};
+
+static int64_t linc_sink_http_milliseconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static struct linc_sink_http_request *linc_sink_http_slot(struct linc_sink_http *http, size_t request) {
+    return &http->requests[request % http->pipeline];
+}
+
+static char *linc_sink_http_body(struct linc_sink_http *http) {
+    return linc_sink_http_slot(http, http->queued)->bytes + LINC_SINK_HTTP_HEADER_LENGTH;
+}
+
+// Closes the connection after a failure, its unanswered requests are sent again on the next one. The first attempt to
+// connect again is right away if the connection had worked.
+static void linc_sink_http_disconnect(struct linc_sink_http *http) {
+    if (http->fd >= 0) {
+        close(http->fd);
+        http->fd = -1;
+    }
+    http->sent = http->answered;
+    http->sent_bytes = 0;
+    http->response_used = 0;
+    http->skip = 0;
+    http->retry_at = linc_sink_http_milliseconds() + http->backoff;
+    uint32_t backoff = http->backoff == 0 ? LINC_SINK_HTTP_MIN_BACKOFF_MS : http->backoff * 2;
+    http->backoff = backoff < LINC_DEFAULT_HTTP_MAX_BACKOFF_MS ? backoff : LINC_DEFAULT_HTTP_MAX_BACKOFF_MS;
+}
+
+// Waits for the socket up to the timeout, returns whether it is ready.
+static bool linc_sink_http_poll(int fd, short events, int64_t timeout_ms) {
+    struct pollfd pollfd = {.fd = fd, .events = events, .revents = 0};
+    int result = 0;
+    do {
+        result = poll(&pollfd, 1, timeout_ms > 0 ? (int)timeout_ms : 0);
+    } while (result < 0 && errno == EINTR);
+    return result > 0;
+}
+
+static int linc_sink_http_try_connect(const struct addrinfo *address) {
+    int fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+    if (fd < 0) {
+        return -1;
+    }
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    int error = 0;
+    socklen_t length = sizeof(error);
+    if (connect(fd, address->ai_addr, address->ai_addrlen) < 0
+        && (errno != EINPROGRESS || !linc_sink_http_poll(fd, POLLOUT, LINC_SINK_HTTP_TIMEOUT_MS)
+            || getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) < 0 || error != 0)) {
+        close(fd);
+        return -1;
+    }
+    int is_enabled = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &is_enabled, sizeof(is_enabled));
+    return fd;
+}
+
+// Opens the connection, unless the sink is waiting before the next attempt.
+static int linc_sink_http_connect(struct linc_sink_http *http) {
+    if (linc_sink_http_milliseconds() < http->retry_at) {
+        return -1;
+    }
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo *addresses = NULL;
+    if (getaddrinfo(http->host, http->port, &hints, &addresses) == 0) {
+        for (const struct addrinfo *address = addresses; address != NULL && http->fd < 0; address = address->ai_next) {
+            http->fd = linc_sink_http_try_connect(address);
+        }
+        freeaddrinfo(addresses);
+    }
+    if (http->fd < 0) {
+        linc_sink_http_disconnect(http);
+        return -1;
+    }
+    http->sent = http->answered;
+    http->sent_bytes = 0;
+    http->response_used = 0;
+    http->skip = 0;
+    return 0;
+}
+
+// Sends the requests that were not sent yet, as far as the socket takes them without waiting. Returns 1 if some bytes
+// were sent, 0 if none and -1 if the connection failed.
+static int linc_sink_http_send(struct linc_sink_http *http) {
+    int progress = 0;
+    while (http->sent != http->queued) {
+        const struct linc_sink_http_request *request = linc_sink_http_slot(http, http->sent);
+        const char *bytes = request->bytes + request->start + http->sent_bytes;
+        ssize_t written = send(http->fd, bytes, request->length - http->sent_bytes, MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK ? progress : -1;
+        }
+        progress = 1;
+        http->sent_bytes += (size_t)written;
+        if (http->sent_bytes == request->length) {
+            http->sent++;
+            http->sent_bytes = 0;
+        }
+    }
+    return progress;
+}
+
+// Tells whether the header line starts with the name, ignoring case, and points to its value.
+static bool linc_sink_http_is_header(const char *line, const char *end, const char *name, const char **value) {
+    size_t length = strlen(name);
+    if ((size_t)(end - line) < length || strncasecmp(line, name, length) != 0) {
+        return false;
+    }
+    *value = line + length;
+    return true;
+}
+
+// Parses the status line and headers at the start of the response buffer, which end at `end`. Returns the status, and
+// the length of the body in `length`, or -1 if the response cannot be read, e.g., a chunked or unbounded body.
+static int linc_sink_http_parse_head(const char *head, const char *end, size_t *length) {
+    if (end - head < 12 || strncmp(head, "HTTP/1.", 7) != 0 || head[8] != ' ') {
+        return -1;
+    }
+    int status = 0;
+    for (int i = 9; i < 12; i++) {
+        if (head[i] < '0' || head[i] > '9') {
+            return -1;
+        }
+        status = status * 10 + head[i] - '0';
+    }
+
+    bool has_length = false;
+    *length = 0;
+    for (const char *line = head; line < end;) {
+        const char *line_end = line;
+        while (line_end < end && *line_end != '\r') {
+            line_end++;
+        }
+        const char *value = NULL;
+        if (linc_sink_http_is_header(line, line_end, "content-length:", &value)) {
+            has_length = true;
+            for (; value < line_end && *value == ' '; value++) {
+            }
+            for (; value < line_end && *value >= '0' && *value <= '9'; value++) {
+                *length = *length * 10 + (size_t)(*value - '0');
+            }
+        } else if (linc_sink_http_is_header(line, line_end, "transfer-encoding:", &value)) {
+            return -1;
+        }
+        line = line_end + 2;
+    }
+    if (!has_length && status >= 200 && status != 204 && status != 304) {
+        return -1;
+    }
+    return status;
+}
+
+// Reads the responses received so far. Returns 1 if some bytes were read, 0 if none and -1 if the connection failed or
+// was closed. The result is set to -1 for a response other than 2xx.
+static int linc_sink_http_receive(struct linc_sink_http *http, int *result) {
+    int progress = 0;
+    while (true) {
+        ssize_t received = recv(http->fd,
+                                http->response + http->response_used,
+                                sizeof(http->response) - http->response_used,
+                                0);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return progress;
+        }
+        if (received <= 0) {
+            return -1;
+        }
+        progress = 1;
+        http->response_used += (size_t)received;
+
+        while (http->response_used > 0) {
+            if (http->skip > 0) {
+                size_t skipped = http->skip < http->response_used ? http->skip : http->response_used;
+                memmove(http->response, http->response + skipped, http->response_used - skipped);
+                http->response_used -= skipped;
+                http->skip -= skipped;
+                continue;
+            }
+            const char *end = NULL;
+            for (size_t i = 3; i < http->response_used && end == NULL; i++) {
+                if (memcmp(http->response + i - 3, "\r\n\r\n", 4) == 0) {
+                    end = http->response + i + 1;
+                }
+            }
+            if (end == NULL) {
+                if (http->response_used == sizeof(http->response)) {
+                    return -1;
+                }
+                break;
+            }
+            size_t length = 0;
+            int status = linc_sink_http_parse_head(http->response, end - 2, &length);
+            if (status < 0 || http->answered == http->sent) {
+                return -1;
+            }
+            size_t head_length = (size_t)(end - http->response);
+            memmove(http->response, end, http->response_used - head_length);
+            http->response_used -= head_length;
+            if (status < 200) {
+                continue;
+            }
+            http->skip = length;
+            http->answered++;
+            http->backoff = 0;
+            if (status >= 300) {
+                *result = -1;
+            }
+        }
+    }
+}
+
+// Sends the requests and reads the responses until the target number of requests is answered and every request is
+// sent. Gives up and closes the connection once the server made no progress for LINC_SINK_HTTP_TIMEOUT_MS.
+static int linc_sink_http_pump(struct linc_sink_http *http, size_t target) {
+    int result = 0;
+    int64_t deadline = linc_sink_http_milliseconds() + LINC_SINK_HTTP_TIMEOUT_MS;
+    while (true) {
+        if (http->fd < 0 && linc_sink_http_connect(http) < 0) {
+            return -1;
+        }
+        int sent = linc_sink_http_send(http);
+        int received = sent < 0 ? -1 : linc_sink_http_receive(http, &result);
+        if (received < 0) {
+            // The server may close the connection after its last response, the requests left are sent again.
+            bool is_done = http->answered == http->queued;
+            linc_sink_http_disconnect(http);
+            if (is_done) {
+                http->retry_at = 0;
+                return result;
+            }
+            continue;
+        }
+        if (http->answered >= target && http->sent == http->queued) {
+            return result;
+        }
+        int64_t now = linc_sink_http_milliseconds();
+        if (sent > 0 || received > 0) {
+            deadline = now + LINC_SINK_HTTP_TIMEOUT_MS;
+        } else if (now >= deadline) {
+            linc_sink_http_disconnect(http);
+            return -1;
+        }
+        short events = http->sent != http->queued ? POLLIN | POLLOUT : POLLIN;
+        linc_sink_http_poll(http->fd, events, deadline - now);
+    }
+}
+
+// Tells whether the text can be written as is into the request line or the Host header: it must not be empty nor hold
+// spaces, control characters or bytes outside ASCII, which would end the line or the header early.
+static bool linc_sink_http_is_token(const char *text, size_t max_length) {
+    size_t length = strnlen(text, max_length + LINC_ZERO_CHAR_LENGTH);
+    if (length == 0 || length > max_length) {
+        return false;
+    }
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = (unsigned char)text[i];
+        if (c <= ' ' || c >= 0x7F) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Writes the request line and headers right before the body being filled and queues the request, then makes sure the
+// slot of the next body is free, dropping the oldest request if the server cannot answer it.
+static int linc_sink_http_queue(struct linc_sink_http *http) {
+    struct linc_sink_http_request *request = linc_sink_http_slot(http, http->queued);
+    char *body = linc_sink_http_body(http);
+    if (!http->is_ndjson) {
+        body[http->used++] = ']';
+    }
+    char head[LINC_SINK_HTTP_HEADER_LENGTH];
+    bool is_ipv6 = strchr(http->host, ':') != NULL;
+    int head_length = snprintf(head,
+                               sizeof(head),
+                               "POST %s HTTP/1.1\r\n"
+                               "Host: %s%s%s:%s\r\n"
+                               "Content-Type: %s\r\n"
+                               "Content-Length: %zu\r\n"
+                               "\r\n",
+                               http->path,
+                               is_ipv6 ? "[" : "",
+                               http->host,
+                               is_ipv6 ? "]" : "",
+                               http->port,
+                               http->is_ndjson ? "application/x-ndjson" : "application/json",
+                               http->used);
+    request->start = LINC_SINK_HTTP_HEADER_LENGTH - (size_t)head_length;
+    request->length = (size_t)head_length + http->used;
+    memcpy(request->bytes + request->start, head, (size_t)head_length);
+    http->queued++;
+    http->used = 0;
+    http->count = 0;
+
+    if (http->queued - http->answered < http->pipeline) {
+        return linc_sink_http_pump(http, http->answered);
+    }
+    int result = linc_sink_http_pump(http, http->queued - http->pipeline + 1);
+    if (http->queued - http->answered >= http->pipeline) {
+        // Not connected, so the oldest request is not on its way.
+        http->answered++;
+        http->sent = http->answered;
+        result = -1;
+    }
+    return result;
+}
+
+// Adds the log to the body being filled, and queues the body first if the log does not fit.
+static int linc_sink_http_append(struct linc_sink_http *http, struct linc_metadata *metadata) {
+    size_t length = 0;
+    const char *text = linc_layout_view(linc_layout_json, metadata, &length);
+    // JSON lines keep the newline, arrays replace it with a comma or the opening bracket and keep room for the closing
+    // one.
+    size_t needed = http->is_ndjson ? length : length + 1;
+    if (text == NULL || length == 0 || needed > http->batch_size) {
+        return -1;
+    }
+    int result = 0;
+    if (http->used + needed > http->batch_size) {
+        result = linc_sink_http_queue(http);
+    }
+    char *body = linc_sink_http_body(http);
+    if (http->is_ndjson) {
+        memcpy(body + http->used, text, length);
+        http->used += length;
+    } else {
+        body[http->used++] = http->count == 0 ? '[' : ',';
+        memcpy(body + http->used, text, length - LINC_NEWLINE_CHAR_LENGTH);
+        http->used += length - LINC_NEWLINE_CHAR_LENGTH;
+    }
+    http->count++;
+    return result;
+}
+
+static int linc_sink_http_open(void *data) {
+    struct linc_sink_http *http = (struct linc_sink_http *)data;
+    if (http->is_open) {
+        return -1;
+    }
+    http->fd = -1;
+    http->used = 0;
+    http->count = 0;
+    http->queued = 0;
+    http->sent = 0;
+    http->sent_bytes = 0;
+    http->answered = 0;
+    http->response_used = 0;
+    http->skip = 0;
+    http->retry_at = 0;
+    http->backoff = 0;
+    http->is_open = true;
+    return 0;
+}
+
+// Sends the body being filled and waits for the responses of every request.
+static int linc_sink_http_flush(void *data) {
+    struct linc_sink_http *http = (struct linc_sink_http *)data;
+    int result = 0;
+    if (http->count > 0) {
+        result = linc_sink_http_queue(http);
+    }
+    if (http->answered == http->queued) {
+        return result;
+    }
+    return linc_sink_http_pump(http, http->queued) | result;
+}
+
+// Tries once more to reach the server, even if it is waiting after a failure.
+static int linc_sink_http_close(void *data) {
+    struct linc_sink_http *http = (struct linc_sink_http *)data;
+    http->retry_at = 0;
+    int result = linc_sink_http_flush(http);
+    if (http->fd >= 0) {
+        close(http->fd);
+        http->fd = -1;
+    }
+    pthread_mutex_lock(&linc_sink_https.mutex);
+    http->is_open = false;
+    http->is_used = false;
+    pthread_mutex_unlock(&linc_sink_https.mutex);
+    return result;
+}
+
+// Gives back the slot claimed by the builder, unless the sink is open.
+static void linc_sink_http_release(void *data) {
+    struct linc_sink_http *http = (struct linc_sink_http *)data;
+    pthread_mutex_lock(&linc_sink_https.mutex);
+    http->is_used = http->is_open;
+    pthread_mutex_unlock(&linc_sink_https.mutex);
+}
+
+static int linc_sink_http_write_batch(void *data, struct linc_metadata *const *records, size_t count) {
+    struct linc_sink_http *http = (struct linc_sink_http *)data;
+    int result = 0;
+    for (size_t i = 0; i < count; i++) {
+        result |= linc_sink_http_append(http, records[i]);
+    }
+    return result;
+}
+
+static int linc_sink_http_write(void *data, struct linc_metadata *metadata) {
+    return linc_sink_http_write_batch(data, &metadata, 1);
+}
+
+// The server is only reached on the first request, so the sink can be registered before the server is up.
+static struct linc_sink_funcs linc_sink_http_create(const char *host,
+                                                    const char *port,
+                                                    const struct linc_sink_http_options *options) {
+    struct linc_sink_funcs funcs;
+    memset(&funcs, 0, sizeof(funcs));
+    struct linc_sink_http_options defaults = {
+        .path = NULL, .batch_size = 0, .flush_delay_us = 0, .pipeline = 0, .is_ndjson = false};
+    if (options == NULL) {
+        options = &defaults;
+    }
+    const char *path = options->path != NULL ? options->path : "/";
+    size_t batch_size = options->batch_size > 0 ? options->batch_size : LINC_DEFAULT_HTTP_BATCH_BYTES;
+    size_t pipeline = options->pipeline > 0 ? options->pipeline : LINC_DEFAULT_HTTP_PIPELINE;
+    if (host == NULL || port == NULL || !linc_sink_http_is_token(host, LINC_SINK_HTTP_HOST_LENGTH)
+        || !linc_sink_http_is_token(port, LINC_SINK_HTTP_PORT_LENGTH) || path[0] != '/'
+        || !linc_sink_http_is_token(path, LINC_SINK_HTTP_PATH_LENGTH) || batch_size < LINC_SINK_HTTP_MIN_BATCH_BYTES
+        || batch_size > LINC_DEFAULT_HTTP_BATCH_BYTES || pipeline > LINC_DEFAULT_HTTP_PIPELINE) {
+        return funcs;
+    }
+
+    struct linc_sink_http_list *https = &linc_sink_https;
+    pthread_mutex_lock(&https->mutex);
+    size_t index = 0;
+    while (index < LINC_DEFAULT_MAX_NETWORK_SINKS && https->list[index].is_used) {
+        index++;
+    }
+    if (index == LINC_DEFAULT_MAX_NETWORK_SINKS) {
+        pthread_mutex_unlock(&https->mutex);
+        return funcs;
+    }
+    struct linc_sink_http *http = &https->list[index];
+    http->is_used = true;
+    http->is_open = false;
+    strcpy(http->host, host);
+    strcpy(http->port, port);
+    strcpy(http->path, path);
+    http->is_ndjson = options->is_ndjson;
+    http->batch_size = batch_size;
+    http->pipeline = pipeline;
+    http->fd = -1;
+    pthread_mutex_unlock(&https->mutex);
+
+    funcs.data = http;
+    funcs.open = linc_sink_http_open;
+    funcs.close = linc_sink_http_close;
+    funcs.write = linc_sink_http_write;
+    funcs.flush = linc_sink_http_flush;
+    funcs.write_batch = linc_sink_http_write_batch;
+    funcs.release = linc_sink_http_release;
+    funcs.flush_latency = options->flush_delay_us > 0 ? options->flush_delay_us : LINC_DEFAULT_HTTP_FLUSH_DELAY_US;
+    return funcs;
+}
+
+#else
+
+static struct linc_sink_funcs linc_sink_http_create(const char *host,
+                                                    const char *port,
+                                                    const struct linc_sink_http_options *options) {
+    (void)host;
+    (void)port;
+    (void)options;
+    struct linc_sink_funcs funcs;
+    memset(&funcs, 0, sizeof(funcs));
+    return funcs;
+}
+
+#endif  // LINC_DEFAULT_MAX_NETWORK_SINKS > 0
+
+// ==================================================
+// Public Functions
+// ==================================================
+
+struct linc_sink_funcs linc_sink_http_funcs(const char *host,
+                                            const char *port,
+                                            const struct linc_sink_http_options *options) {
+    linc_init();
+    return linc_sink_http_create(host, port, options);
+}
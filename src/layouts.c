@@ -0,0 +1,749 @@
+#include "internal/shared.h"
+#include "linc.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+// ==================================================
+// Layouts
+// ==================================================
+//
+// A pattern is parsed once into a list of operations, each one appends a constant text or a field of the record to
+// the output, so rendering never parses a format string. Patterns use these directives:
+//
+// %t timestamp string   %T nanoseconds since epoch   %l level   %i thread ID   %I kernel thread ID   %N thread name
+// %M module   %f file   %n line   %F function   %m message   %% percent sign
+// %{color} ANSI color, e.g., %{bold}, %{red}, %{reset} or %{level}
+//
+// Fields take an optional width, e.g., %-16M or %5n, or an escaping flag instead, %jm escapes the message for a JSON
+// string and %qm quotes it for logfmt when it holds spaces, quotes or equal signs. The built-in layouts are compiled
+// when the library starts, along with the rest of its state.
+
+#define LINC_LAYOUT_MAX_WIDTH 1024    // Maximum width of a field
+#define LINC_LAYOUT_DIGITS_LENGTH 32  // Longest field written by the layout itself, a timestamp with nanoseconds
+
+#define LINC_LAYOUT_TEXT_PATTERN                                      \
+    "[ %t ] [ %-" LINC_STRINGIFY(LINC_LOG_LEVEL_LENGTH) "l ] [ %i ] " \
+    "[ %-" LINC_STRINGIFY(LINC_DEFAULT_MODULE_NAME_LENGTH) "M ] %f:%n %F: %m\n"
+
+#define LINC_LAYOUT_TEXT_COLOR_PATTERN                                                                 \
+    "[ %{bold}%t%{reset} ] [ %{level}%-" LINC_STRINGIFY(LINC_LOG_LEVEL_LENGTH) "l%{reset} ] "          \
+    "[ %{bold}%i%{reset} ] [ %{bold}%-" LINC_STRINGIFY(LINC_DEFAULT_MODULE_NAME_LENGTH) "M%{reset} ] " \
+    "%{cyan}%f%{reset}:%{yellow}%n%{reset} %{magenta}%F%{reset}: %m\n"
+
+#define LINC_LAYOUT_JSON_PATTERN                                                                       \
+    "{\"timestamp\":\"%t\",\"level\":\"%l\",\"thread_id\":\"%i\",\"module\":\"%jM\",\"file\":\"%jf\"," \
+    "\"line\":%n,\"func\":\"%jF\",\"message\":\"%jm\"}\n"
+
+#define LINC_LAYOUT_LOGFMT_PATTERN \
+    "time=\"%t\" level=%l thread_id=%i module=%qM file=%qf line=%n func=%qF message=%qm\n"
+
+linc_layout linc_layout_text = &linc.layouts.list[LINC_LAYOUT_BUILTIN_TEXT];
+linc_layout linc_layout_text_color = &linc.layouts.list[LINC_LAYOUT_BUILTIN_TEXT_COLOR];
+linc_layout linc_layout_json = &linc.layouts.list[LINC_LAYOUT_BUILTIN_JSON];
+linc_layout linc_layout_logfmt = &linc.layouts.list[LINC_LAYOUT_BUILTIN_LOGFMT];
+
+// Text of the records that are not shared, i.e., rendered by a sink with its own layout or given by the sink itself.
+static LINC_THREAD_LOCAL char
+    linc_layout_private[LINC_LOG_MAX_LENGTH + LINC_NEWLINE_CHAR_LENGTH + LINC_ZERO_CHAR_LENGTH];
+
+struct linc_layout_color {
+    const char *name;  // Name of the color in patterns
+    const char *code;  // ANSI escape sequence
+};
+
+static const struct linc_layout_color linc_layout_colors[] = {
+    {"reset", LINC_COLOR_RESET},
+    {"bold", LINC_COLOR_BOLD},
+    {"dim", LINC_COLOR_DIM},
+    {"normal", LINC_COLOR_NORMAL},
+    {"red", LINC_COLOR_RED},
+    {"green", LINC_COLOR_GREEN},
+    {"yellow", LINC_COLOR_YELLOW},
+    {"blue", LINC_COLOR_BLUE},
+    {"magenta", LINC_COLOR_MAGENTA},
+    {"cyan", LINC_COLOR_CYAN},
+    {"white", LINC_COLOR_WHITE},
+};
+
+struct linc_layout_text {
+    const char *text;  // Constant text
+    size_t length;     // Length of the text
+};
+
+#define LINC_LAYOUT_TEXT(text) {text, sizeof(text) - 1}
+
+// Levels and their colors, the last entry is used for unknown levels.
+static const struct linc_layout_text linc_layout_levels[LINC_LEVEL_FATAL + 2] = {
+    LINC_LAYOUT_TEXT("TRACE"),
+    LINC_LAYOUT_TEXT("DEBUG"),
+    LINC_LAYOUT_TEXT("INFO"),
+    LINC_LAYOUT_TEXT("WARN"),
+    LINC_LAYOUT_TEXT("ERROR"),
+    LINC_LAYOUT_TEXT("FATAL"),
+    LINC_LAYOUT_TEXT("UNKN"),
+};
+
+static const struct linc_layout_text linc_layout_level_colors[LINC_LEVEL_FATAL + 2] = {
+    LINC_LAYOUT_TEXT(LINC_COLOR_DIM LINC_COLOR_BLUE),
+    LINC_LAYOUT_TEXT(LINC_COLOR_CYAN),
+    LINC_LAYOUT_TEXT(LINC_COLOR_GREEN),
+    LINC_LAYOUT_TEXT(LINC_COLOR_YELLOW),
+    LINC_LAYOUT_TEXT(LINC_COLOR_RED),
+    LINC_LAYOUT_TEXT(LINC_COLOR_BOLD LINC_COLOR_MAGENTA),
+    LINC_LAYOUT_TEXT(LINC_COLOR_WHITE),
+};
+
+enum linc_layout_separator {
+    LINC_LAYOUT_SEPARATOR_TIMESTAMP = 0,  // Before the timestamp
+    LINC_LAYOUT_SEPARATOR_LEVEL = 1,      // Between the timestamp and the level
+    LINC_LAYOUT_SEPARATOR_THREAD = 2,     // Between the level and the thread ID
+    LINC_LAYOUT_SEPARATOR_MODULE = 3,     // Between the thread ID and the module name
+    LINC_LAYOUT_SEPARATOR_FILE = 4,       // Between the module name and the file name
+    LINC_LAYOUT_SEPARATOR_LINE = 5,       // Between the file name and the line number
+    LINC_LAYOUT_SEPARATOR_FUNC = 6,       // Between the line number and the function name
+    LINC_LAYOUT_SEPARATOR_MESSAGE = 7,    // Between the function name and the message
+    LINC_LAYOUT_SEPARATOR_COUNT = 8,      // Number of separators
+};
+
+// Constant text of the built-in text layouts, without and with colors.
+static const struct linc_layout_text linc_layout_text_separators[2][LINC_LAYOUT_SEPARATOR_COUNT] = {
+    {
+        LINC_LAYOUT_TEXT("[ "),
+        LINC_LAYOUT_TEXT(" ] [ "),
+        LINC_LAYOUT_TEXT(" ] [ "),
+        LINC_LAYOUT_TEXT(" ] [ "),
+        LINC_LAYOUT_TEXT(" ] "),
+        LINC_LAYOUT_TEXT(":"),
+        LINC_LAYOUT_TEXT(" "),
+        LINC_LAYOUT_TEXT(": "),
+    },
+    {
+        LINC_LAYOUT_TEXT("[ " LINC_COLOR_BOLD),
+        LINC_LAYOUT_TEXT(LINC_COLOR_RESET " ] [ "),
+        LINC_LAYOUT_TEXT(" ] [ " LINC_COLOR_BOLD),
+        LINC_LAYOUT_TEXT(LINC_COLOR_RESET " ] [ " LINC_COLOR_BOLD),
+        LINC_LAYOUT_TEXT(LINC_COLOR_RESET " ] " LINC_COLOR_CYAN),
+        LINC_LAYOUT_TEXT(LINC_COLOR_RESET ":" LINC_COLOR_YELLOW),
+        LINC_LAYOUT_TEXT(LINC_COLOR_RESET " " LINC_COLOR_MAGENTA),
+        LINC_LAYOUT_TEXT(LINC_COLOR_RESET ": "),
+    },
+};
+
+static const char linc_layout_hex[] = "0123456789abcdef";
+
+static const char linc_layout_pairs[] =
+    "0001020304050607080910111213141516171819202122232425262728293031323334353637383940414243444546474849"
+    "5051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+
+// ==================================================
+// Compilation
+// ==================================================
+
+static int linc_layout_push(struct linc_layout *layout, struct linc_layout_op op) {
+    if (layout->count >= LINC_DEFAULT_LAYOUT_OPS) {
+        return -1;
+    }
+    layout->ops[layout->count++] = op;
+    layout->fields |= 1U << op.field;
+    return 0;
+}
+
+// Appends constant text, merged with the previous operation when it is constant text too.
+static int linc_layout_literal(struct linc_layout *layout, const char *text, size_t length) {
+    if (layout->literals_length + length > LINC_DEFAULT_LAYOUT_LITERALS_LENGTH) {
+        return -1;
+    }
+    memcpy(layout->literals + layout->literals_length, text, length);
+    layout->literals_length += length;
+
+    struct linc_layout_op *last = layout->count > 0 ? &layout->ops[layout->count - 1] : NULL;
+    if (last != NULL && last->field == LINC_LAYOUT_LITERAL) {
+        last->length += (uint16_t)length;
+        return 0;
+    }
+    struct linc_layout_op op;
+    memset(&op, 0, sizeof(op));
+    op.field = LINC_LAYOUT_LITERAL;
+    op.offset = (uint16_t)(layout->literals_length - length);
+    op.length = (uint16_t)length;
+    return linc_layout_push(layout, op);
+}
+
+// Parses "%{name}", returns the number of characters read or -1.
+static int linc_layout_color(struct linc_layout *layout, const char *directive) {
+    const char *end = strchr(directive, '}');
+    if (end == NULL) {
+        return -1;
+    }
+    size_t length = (size_t)(end - directive - 1);
+    if (length == 5 && strncmp(directive + 1, "level", 5) == 0) {
+        struct linc_layout_op op;
+        memset(&op, 0, sizeof(op));
+        op.field = LINC_LAYOUT_LEVEL_COLOR;
+        return linc_layout_push(layout, op) < 0 ? -1 : (int)(end - directive + 1);
+    }
+    for (size_t i = 0; i < sizeof(linc_layout_colors) / sizeof(linc_layout_colors[0]); i++) {
+        const struct linc_layout_color *color = &linc_layout_colors[i];
+        if (strlen(color->name) == length && strncmp(directive + 1, color->name, length) == 0) {
+            int result = linc_layout_literal(layout, color->code, strlen(color->code));
+            return result < 0 ? -1 : (int)(end - directive + 1);
+        }
+    }
+    return -1;
+}
+
+static int linc_layout_field_of(char conversion) {
+    switch (conversion) {
+        case 't':
+            return LINC_LAYOUT_TIMESTAMP;
+        case 'T':
+            return LINC_LAYOUT_EPOCH;
+        case 'l':
+            return LINC_LAYOUT_LEVEL;
+        case 'i':
+            return LINC_LAYOUT_THREAD_ID;
+        case 'I':
+            return LINC_LAYOUT_TID;
+        case 'N':
+            return LINC_LAYOUT_THREAD_NAME;
+        case 'M':
+            return LINC_LAYOUT_MODULE;
+        case 'f':
+            return LINC_LAYOUT_FILE;
+        case 'n':
+            return LINC_LAYOUT_LINE;
+        case 'F':
+            return LINC_LAYOUT_FUNC;
+        case 'm':
+            return LINC_LAYOUT_MESSAGE;
+        default:
+            return -1;
+    }
+}
+
+// Parses a field directive after its percent sign, returns the number of characters read or -1.
+static int linc_layout_field(struct linc_layout *layout, const char *directive) {
+    struct linc_layout_op op;
+    memset(&op, 0, sizeof(op));
+    const char *cursor = directive;
+    for (;; cursor++) {
+        if (*cursor == '-') {
+            op.is_left_aligned = true;
+        } else if (*cursor == 'j') {
+            op.escape = LINC_LAYOUT_ESCAPE_JSON;
+        } else if (*cursor == 'q') {
+            op.escape = LINC_LAYOUT_ESCAPE_LOGFMT;
+        } else {
+            break;
+        }
+    }
+    unsigned int width = 0;
+    while (*cursor >= '0' && *cursor <= '9') {
+        width = width * 10 + (unsigned int)(*cursor++ - '0');
+        if (width > LINC_LAYOUT_MAX_WIDTH) {
+            return -1;
+        }
+    }
+    int field = linc_layout_field_of(*cursor);
+    if (field < 0 || (op.escape != LINC_LAYOUT_ESCAPE_NONE && (width > 0 || op.is_left_aligned))) {
+        return -1;
+    }
+    op.field = (uint8_t)field;
+    op.width = (uint16_t)width;
+    return linc_layout_push(layout, op) < 0 ? -1 : (int)(cursor - directive + 1);
+}
+
+static int linc_layout_parse(struct linc_layout *layout, const char *pattern) {
+    memset(layout, 0, sizeof(*layout));
+    const char *cursor = pattern;
+    while (*cursor != '\0') {
+        if (*cursor != '%') {
+            size_t length = strcspn(cursor, "%");
+            if (linc_layout_literal(layout, cursor, length) < 0) {
+                return -1;
+            }
+            cursor += length;
+            continue;
+        }
+
+        cursor++;
+        int read;
+        if (*cursor == '%') {
+            read = linc_layout_literal(layout, "%", 1) < 0 ? -1 : 1;
+        } else if (*cursor == '{') {
+            read = linc_layout_color(layout, cursor);
+        } else {
+            read = linc_layout_field(layout, cursor);
+        }
+        if (read < 0) {
+            return -1;
+        }
+        cursor += read;
+    }
+    return 0;
+}
+
+void linc_layouts_init(void) {
+    struct linc_layout_list *layouts = &linc.layouts;
+    pthread_mutex_init(&layouts->mutex, NULL);
+    linc_layout_parse(&layouts->list[LINC_LAYOUT_BUILTIN_TEXT], LINC_LAYOUT_TEXT_PATTERN);
+    linc_layout_parse(&layouts->list[LINC_LAYOUT_BUILTIN_TEXT_COLOR], LINC_LAYOUT_TEXT_COLOR_PATTERN);
+    linc_layout_parse(&layouts->list[LINC_LAYOUT_BUILTIN_JSON], LINC_LAYOUT_JSON_PATTERN);
+    linc_layout_parse(&layouts->list[LINC_LAYOUT_BUILTIN_LOGFMT], LINC_LAYOUT_LOGFMT_PATTERN);
+    layouts->count = LINC_LAYOUT_BUILTIN_COUNT;
+}
+
+// ==================================================
+// Rendering
+// ==================================================
+//
+// The writer truncates like snprintf, it keeps counting the length of the output once the buffer is full.
+
+struct linc_writer {
+    char *buffer;   // Output buffer
+    size_t size;    // Size of the output buffer, including the terminator
+    size_t length;  // Length of the whole output, may exceed the size of the buffer
+};
+
+static void linc_writer_append(struct linc_writer *writer, const char *text, size_t length) {
+    if (writer->length < writer->size) {
+        size_t space = writer->size - writer->length;
+        memcpy(writer->buffer + writer->length, text, length < space ? length : space);
+    }
+    writer->length += length;
+}
+
+static void linc_writer_fill(struct linc_writer *writer, char character, size_t count) {
+    if (writer->length < writer->size) {
+        size_t space = writer->size - writer->length;
+        memset(writer->buffer + writer->length, character, count < space ? count : space);
+    }
+    writer->length += count;
+}
+
+static void linc_writer_text(struct linc_writer *writer, const struct linc_layout_text *text) {
+    linc_writer_append(writer, text->text, text->length);
+}
+
+static bool linc_writer_is_special(unsigned char character) {
+    return character < 0x20 || character == '"' || character == '\\';
+}
+
+// Appends the text escaped for a JSON string, copying the runs of plain characters at once.
+static void linc_writer_json(struct linc_writer *writer, const char *text, size_t length) {
+    size_t start = 0;
+    for (size_t i = 0; i < length; i++) {
+        unsigned char character = (unsigned char)text[i];
+        if (!linc_writer_is_special(character)) {
+            continue;
+        }
+        linc_writer_append(writer, text + start, i - start);
+        start = i + 1;
+        char escaped[6] = {'\\', (char)character, 0, 0, 0, 0};
+        size_t escaped_length = 2;
+        switch (character) {
+            case '\n':
+                escaped[1] = 'n';
+                break;
+            case '\r':
+                escaped[1] = 'r';
+                break;
+            case '\t':
+                escaped[1] = 't';
+                break;
+            case '"':
+            case '\\':
+                break;
+            default:
+                memcpy(escaped + 1, "u00", 3);
+                escaped[4] = linc_layout_hex[character >> 4];
+                escaped[5] = linc_layout_hex[character & 0xF];
+                escaped_length = 6;
+                break;
+        }
+        linc_writer_append(writer, escaped, escaped_length);
+    }
+    linc_writer_append(writer, text + start, length - start);
+}
+
+// Appends the text as a logfmt value, quoted only when it is empty or holds spaces, quotes or equal signs.
+static void linc_writer_logfmt(struct linc_writer *writer, const char *text, size_t length) {
+    bool is_quoted = length == 0;
+    for (size_t i = 0; i < length && !is_quoted; i++) {
+        unsigned char character = (unsigned char)text[i];
+        is_quoted = character <= ' ' || character == '=' || linc_writer_is_special(character);
+    }
+    if (!is_quoted) {
+        linc_writer_append(writer, text, length);
+        return;
+    }
+    linc_writer_append(writer, "\"", 1);
+    linc_writer_json(writer, text, length);
+    linc_writer_append(writer, "\"", 1);
+}
+
+// Same output as "%016" PRIxPTR.
+static size_t linc_layout_thread_id(char *digits, uintptr_t thread_id) {
+    enum { LINC_HEX_DIGITS = sizeof(uintptr_t) * 2 > 16 ? sizeof(uintptr_t) * 2 : 16 };
+    for (int i = LINC_HEX_DIGITS - 1; i >= 0; i--) {
+        digits[i] = linc_layout_hex[thread_id & 0xF];
+        thread_id >>= 4;
+    }
+    return LINC_HEX_DIGITS;
+}
+
+// Writes the number at the end of the digits, two digits at a time, and returns the position of its first digit.
+static size_t linc_layout_decimal(char *digits, size_t size, uint64_t value) {
+    size_t position = size;
+    while (value >= 100) {
+        position -= 2;
+        memcpy(digits + position, linc_layout_pairs + (value % 100) * 2, 2);
+        value /= 100;
+    }
+    if (value >= 10) {
+        position -= 2;
+        memcpy(digits + position, linc_layout_pairs + value * 2, 2);
+    } else {
+        digits[--position] = (char)('0' + value);
+    }
+    return position;
+}
+
+// Checks an optional string of the metadata, missing strings are printed as "unknown".
+static int linc_layout_string(const char *field, size_t max_length, const char **text, size_t *length) {
+    if (field == NULL) {
+        *text = "unknown";
+        *length = sizeof("unknown") - 1;
+        return 0;
+    }
+    *length = strnlen(field, max_length + LINC_ZERO_CHAR_LENGTH);
+    if (*length == 0 || *length > max_length) {
+        return -1;
+    }
+    *text = field;
+    return 0;
+}
+
+struct linc_layout_record {
+    size_t level;                      // Index of the level in the level tables
+    const char *module_name;           // Module name, or "unknown"
+    size_t module_name_length;         // Length of the module name
+    const char *filename;              // Source file name, or "unknown"
+    size_t filename_length;            // Length of the source file name
+    const char *func;                  // Function name, or "unknown"
+    size_t func_length;                // Length of the function name
+    const struct linc_thread *thread;  // Registry entry of the thread, NULL if unknown
+};
+
+// Checks the strings used by the layout before anything is written, so invalid records leave the buffer untouched.
+static int linc_layout_check(linc_layout layout,
+                             const struct linc_metadata *metadata,
+                             struct linc_layout_record *record) {
+    record->level = metadata->level >= LINC_LEVEL_TRACE && metadata->level <= LINC_LEVEL_FATAL
+                        ? (size_t)metadata->level
+                        : LINC_LEVEL_FATAL + 1;
+    // Metadata built by hand or kept after its thread exited may refer to another entry, its thread ID is the truth.
+    record->thread = linc_thread_of(metadata->thread);
+    if (record->thread != NULL && record->thread->id != metadata->thread_id) {
+        record->thread = NULL;
+    }
+    if ((layout->fields & (1U << LINC_LAYOUT_MODULE)) != 0
+        && linc_layout_string(metadata->module_name,
+                              LINC_DEFAULT_MODULE_NAME_LENGTH,
+                              &record->module_name,
+                              &record->module_name_length)
+               < 0) {
+        return -1;
+    }
+    if ((layout->fields & (1U << LINC_LAYOUT_FILE)) != 0
+        && linc_layout_string(metadata->filename, LINC_LOG_FILE_LENGTH, &record->filename, &record->filename_length)
+               < 0) {
+        return -1;
+    }
+    if ((layout->fields & (1U << LINC_LAYOUT_FUNC)) != 0
+        && linc_layout_string(metadata->func, LINC_LOG_FUNC_LENGTH, &record->func, &record->func_length) < 0) {
+        return -1;
+    }
+    return 0;
+}
+
+// Returns the text of a field and its length, fields computed by the layout are written into the digits.
+static size_t linc_layout_value(int field,
+                                const struct linc_metadata *metadata,
+                                const struct linc_layout_record *record,
+                                char *digits,
+                                const char **text) {
+    size_t position = LINC_LAYOUT_DIGITS_LENGTH;
+    switch (field) {
+        case LINC_LAYOUT_TIMESTAMP:
+            if (linc_format_timestamp(metadata->timestamp,
+                                      digits,
+                                      LINC_LAYOUT_DIGITS_LENGTH,
+                                      LINC_DEFAULT_TIMESTAMP_PRECISION,
+                                      LINC_DEFAULT_TIMEZONE)
+                < 0) {
+                memset(digits, '0', LINC_LOG_TIMESTAMP_LENGTH);
+                memcpy(digits, "0000-00-00 00:00:00.", LINC_LOG_TIMESTAMP_PREFIX_LENGTH + 1);
+            }
+            *text = digits;
+            return LINC_LOG_TIMESTAMP_LENGTH;
+        case LINC_LAYOUT_EPOCH: {
+            uint64_t magnitude = metadata->timestamp < 0 ? 0 - (uint64_t)metadata->timestamp
+                                                         : (uint64_t)metadata->timestamp;
+            position = linc_layout_decimal(digits, LINC_LAYOUT_DIGITS_LENGTH, magnitude);
+            if (metadata->timestamp < 0) {
+                digits[--position] = '-';
+            }
+            *text = digits + position;
+            return LINC_LAYOUT_DIGITS_LENGTH - position;
+        }
+        case LINC_LAYOUT_LEVEL:
+            *text = linc_layout_levels[record->level].text;
+            return linc_layout_levels[record->level].length;
+        case LINC_LAYOUT_THREAD_ID:
+            if (record->thread != NULL) {
+                *text = record->thread->id_text;
+                return LINC_THREAD_ID_TEXT_LENGTH;
+            }
+            *text = digits;
+            return linc_layout_thread_id(digits, metadata->thread_id);
+        case LINC_LAYOUT_TID:
+            *text = record->thread != NULL ? record->thread->tid_text : "0";
+            return record->thread != NULL ? record->thread->tid_length : 1;
+        case LINC_LAYOUT_THREAD_NAME:
+            if (record->thread == NULL || record->thread->name_length == 0) {
+                *text = "unknown";
+                return sizeof("unknown") - 1;
+            }
+            *text = record->thread->name;
+            return record->thread->name_length;
+        case LINC_LAYOUT_MODULE:
+            *text = record->module_name;
+            return record->module_name_length;
+        case LINC_LAYOUT_FILE:
+            *text = record->filename;
+            return record->filename_length;
+        case LINC_LAYOUT_LINE:
+            position = linc_layout_decimal(digits, LINC_LAYOUT_DIGITS_LENGTH, metadata->line);
+            *text = digits + position;
+            return LINC_LAYOUT_DIGITS_LENGTH - position;
+        case LINC_LAYOUT_FUNC:
+            *text = record->func;
+            return record->func_length;
+        case LINC_LAYOUT_MESSAGE:
+            *text = metadata->message;
+            return strnlen(metadata->message, sizeof(metadata->message));
+        default:
+            *text = "";
+            return 0;
+    }
+}
+
+static void linc_layout_run(linc_layout layout,
+                            const struct linc_layout_op *op,
+                            const struct linc_metadata *metadata,
+                            const struct linc_layout_record *record,
+                            struct linc_writer *writer) {
+    if (op->field == LINC_LAYOUT_LITERAL) {
+        linc_writer_append(writer, layout->literals + op->offset, op->length);
+        return;
+    }
+    if (op->field == LINC_LAYOUT_LEVEL_COLOR) {
+        linc_writer_text(writer, &linc_layout_level_colors[record->level]);
+        return;
+    }
+
+    char digits[LINC_LAYOUT_DIGITS_LENGTH];
+    const char *text;
+    size_t length = linc_layout_value(op->field, metadata, record, digits, &text);
+    if (op->escape == LINC_LAYOUT_ESCAPE_JSON) {
+        linc_writer_json(writer, text, length);
+    } else if (op->escape == LINC_LAYOUT_ESCAPE_LOGFMT) {
+        linc_writer_logfmt(writer, text, length);
+    } else if (op->width <= length) {
+        linc_writer_append(writer, text, length);
+    } else if (op->is_left_aligned) {
+        linc_writer_append(writer, text, length);
+        linc_writer_fill(writer, ' ', op->width - length);
+    } else {
+        linc_writer_fill(writer, ' ', op->width - length);
+        linc_writer_append(writer, text, length);
+    }
+}
+
+// Renders the built-in text layouts, the default format of every log line, without walking their operations. The
+// output is the same as the one of LINC_LAYOUT_TEXT_PATTERN and LINC_LAYOUT_TEXT_COLOR_PATTERN.
+static void linc_layout_run_text(const struct linc_metadata *metadata,
+                                 const struct linc_layout_record *record,
+                                 struct linc_writer *writer,
+                                 bool use_colors) {
+    const struct linc_layout_text *separators = linc_layout_text_separators[use_colors ? 1 : 0];
+    const struct linc_layout_text *level = &linc_layout_levels[record->level];
+    char digits[LINC_LAYOUT_DIGITS_LENGTH];
+    const char *text;
+    size_t length;
+
+    linc_writer_text(writer, &separators[LINC_LAYOUT_SEPARATOR_TIMESTAMP]);
+    length = linc_layout_value(LINC_LAYOUT_TIMESTAMP, metadata, record, digits, &text);
+    linc_writer_append(writer, text, length);
+    linc_writer_text(writer, &separators[LINC_LAYOUT_SEPARATOR_LEVEL]);
+    if (use_colors) {
+        linc_writer_text(writer, &linc_layout_level_colors[record->level]);
+    }
+    linc_writer_text(writer, level);
+    linc_writer_fill(writer, ' ', LINC_LOG_LEVEL_LENGTH - level->length);
+    if (use_colors) {
+        linc_writer_append(writer, LINC_COLOR_RESET, sizeof(LINC_COLOR_RESET) - 1);
+    }
+    linc_writer_text(writer, &separators[LINC_LAYOUT_SEPARATOR_THREAD]);
+    length = linc_layout_value(LINC_LAYOUT_THREAD_ID, metadata, record, digits, &text);
+    linc_writer_append(writer, text, length);
+    linc_writer_text(writer, &separators[LINC_LAYOUT_SEPARATOR_MODULE]);
+    linc_writer_append(writer, record->module_name, record->module_name_length);
+    linc_writer_fill(writer, ' ', LINC_DEFAULT_MODULE_NAME_LENGTH - record->module_name_length);
+    linc_writer_text(writer, &separators[LINC_LAYOUT_SEPARATOR_FILE]);
+    linc_writer_append(writer, record->filename, record->filename_length);
+    linc_writer_text(writer, &separators[LINC_LAYOUT_SEPARATOR_LINE]);
+    length = linc_layout_value(LINC_LAYOUT_LINE, metadata, record, digits, &text);
+    linc_writer_append(writer, text, length);
+    linc_writer_text(writer, &separators[LINC_LAYOUT_SEPARATOR_FUNC]);
+    linc_writer_append(writer, record->func, record->func_length);
+    linc_writer_text(writer, &separators[LINC_LAYOUT_SEPARATOR_MESSAGE]);
+    length = linc_layout_value(LINC_LAYOUT_MESSAGE, metadata, record, digits, &text);
+    linc_writer_append(writer, text, length);
+    linc_writer_append(writer, "\n", LINC_NEWLINE_CHAR_LENGTH);
+}
+
+// ==================================================
+// Shared Texts
+// ==================================================
+//
+// Every sink reads the same decoded records, so sinks with the same layout would render the same text once each. The
+// first sink asking for the text of a record with a layout renders it next to the record in the dispatch slot, the
+// other sinks only read it. The first LINC_DEFAULT_SHARED_LAYOUTS layouts asked for are shared, the text of other
+// layouts is rendered by each sink in a thread-local buffer. The worker resets the texts when it reuses the slot.
+
+// Returns the index of the layout among the shared ones, the layout takes a free index the first time it is used.
+static int linc_layout_shared(linc_layout layout) {
+    for (int i = 0; i < LINC_DEFAULT_SHARED_LAYOUTS; i++) {
+        linc_layout shared = LINC_ATOMIC_LOAD(&linc.dispatch.layouts[i], LINC_ACQUIRE);
+        while (shared == NULL && !LINC_ATOMIC_CAS(&linc.dispatch.layouts[i], &shared, layout, LINC_ACQ_REL)) {
+        }
+        if (shared == NULL || shared == layout) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static const char *linc_layout_view_private(linc_layout layout, const struct linc_metadata *metadata, size_t *length) {
+    int written = linc_layout_render(layout, metadata, linc_layout_private, sizeof(linc_layout_private));
+    if (written < 0) {
+        return NULL;
+    }
+    *length = (size_t)written;
+    return linc_layout_private;
+}
+
+// The sink that wins the state renders the text, the others wait for it a few times before rendering their own copy.
+static const char *linc_layout_view_shared(linc_layout layout,
+                                           const struct linc_metadata *metadata,
+                                           size_t slot,
+                                           int shared,
+                                           size_t *length) {
+    int *state = &linc.dispatch.states[slot][shared];
+    struct linc_dispatch_text *text = &linc.dispatch.texts[slot][shared];
+    for (int attempt = 0; attempt < LINC_SPIN_ATTEMPTS; attempt++) {
+        int current = LINC_ATOMIC_LOAD(state, LINC_ACQUIRE);
+        if (current == LINC_DISPATCH_TEXT_EMPTY
+            && LINC_ATOMIC_CAS(state, &current, LINC_DISPATCH_TEXT_RENDERING, LINC_ACQUIRE)) {
+            int written = linc_layout_render(layout, metadata, text->text, sizeof(text->text));
+            text->length = written < 0 ? 0 : (size_t)written;
+            current = written < 0 ? LINC_DISPATCH_TEXT_FAILED : LINC_DISPATCH_TEXT_READY;
+            LINC_ATOMIC_STORE(state, current, LINC_RELEASE);
+        }
+        if (current == LINC_DISPATCH_TEXT_READY) {
+            *length = text->length;
+            return text->text;
+        }
+        if (current == LINC_DISPATCH_TEXT_FAILED) {
+            return NULL;
+        }
+        if (current == LINC_DISPATCH_TEXT_RENDERING) {
+            sched_yield();
+        }
+    }
+    return linc_layout_view_private(layout, metadata, length);
+}
+
+// ==================================================
+// Public Functions
+// ==================================================
+
+linc_layout linc_layout_compile(const char *pattern) {
+    linc_init();
+    if (pattern == NULL) {
+        return NULL;
+    }
+    struct linc_layout_list *layouts = &linc.layouts;
+    pthread_mutex_lock(&layouts->mutex);
+    struct linc_layout *layout = NULL;
+    if (layouts->count < LINC_LAYOUT_BUILTIN_COUNT + LINC_DEFAULT_MAX_LAYOUTS
+        && linc_layout_parse(&layouts->list[layouts->count], pattern) == 0) {
+        layout = &layouts->list[layouts->count++];
+    }
+    pthread_mutex_unlock(&layouts->mutex);
+    return layout;
+}
+
+int linc_layout_render(linc_layout layout, const struct linc_metadata *metadata, char *buffer, size_t length) {
+    linc_init();
+    if (layout == NULL || metadata == NULL || buffer == NULL) {
+        return -1;
+    }
+    // Fields the layout does not use are left unchecked, and zero.
+    struct linc_layout_record record = {0};
+    if (linc_layout_check(layout, metadata, &record) < 0 || length == 0) {
+        return -1;
+    }
+
+    struct linc_writer writer = {.buffer = buffer, .size = length, .length = 0};
+    if (layout == linc_layout_text || layout == linc_layout_text_color) {
+        linc_layout_run_text(metadata, &record, &writer, layout == linc_layout_text_color);
+    } else {
+        for (size_t i = 0; i < layout->count; i++) {
+            linc_layout_run(layout, &layout->ops[i], metadata, &record, &writer);
+        }
+    }
+    if (writer.length >= length) {
+        buffer[length - 1] = '\0';
+        return -1;
+    }
+    buffer[writer.length] = '\0';
+    return (int)writer.length;
+}
+
+int linc_stringify_metadata(struct linc_metadata *metadata, char *buffer, size_t length, bool use_colors) {
+    return linc_layout_render(use_colors ? linc_layout_text_color : linc_layout_text, metadata, buffer, length);
+}
+
+const char *linc_layout_view(linc_layout layout, const struct linc_metadata *metadata, size_t *length) {
+    linc_init();
+    if (layout == NULL || metadata == NULL || length == NULL) {
+        return NULL;
+    }
+    uintptr_t address = (uintptr_t)metadata;
+    uintptr_t slots = (uintptr_t)linc.dispatch.slots;
+    if (address < slots || address >= (uintptr_t)(linc.dispatch.slots + LINC_DEFAULT_DISPATCH_SIZE)) {
+        return linc_layout_view_private(layout, metadata, length);
+    }
+    int shared = linc_layout_shared(layout);
+    if (shared < 0) {
+        return linc_layout_view_private(layout, metadata, length);
+    }
+    return linc_layout_view_shared(layout, metadata, (address - slots) / sizeof(*metadata), shared, length);
+}
@@ -2,6 +2,7 @@
 #include "linc.h"
 
 #include <pthread.h>
+#include <stddef.h>
 #include <string.h>
 
 // ==================================================
@@ -34,6 +35,13 @@ static int linc_check_level_module(enum linc_level level) {
     return 0;
 }
 
+static int linc_check_backpressure_module(enum linc_backpressure backpressure) {
+    if (backpressure < LINC_BACKPRESSURE_BLOCK || backpressure > LINC_BACKPRESSURE_OVERWRITE_OLDEST) {
+        return -1;
+    }
+    return 0;
+}
+
 static struct linc_module *linc_add_module(struct linc_module_list *modules,
                                            const char *name,
                                            enum linc_level level,
@@ -51,16 +59,15 @@ static struct linc_module *linc_add_module(struct linc_module_list *modules,
     struct linc_module *module = &modules->list[modules->count];
     strncpy(module->name, name, LINC_DEFAULT_MODULE_NAME_LENGTH);
     module->name[LINC_DEFAULT_MODULE_NAME_LENGTH] = '\0';
-    module->level = level;
-    module->enabled = enabled;
+    module->state = linc_state_pack(level, enabled);
+    for (int i = LINC_LEVEL_TRACE; i <= LINC_LEVEL_FATAL; i++) {
+        module->backpressure[i] = LINC_DEFAULT_BACKPRESSURE;
+        module->backpressure_timeout[i] = LINC_DEFAULT_BACKPRESSURE_TIMEOUT_US;
+    }
+    module->dropped = 0;
+    module->reported = 0;
     modules->count += 1;
 
-    pthread_rwlockattr_t attr;
-    pthread_rwlockattr_init(&attr);
-    pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
-    pthread_rwlock_init(&module->lock, &attr);
-    pthread_rwlockattr_destroy(&attr);
-
     return module;
 }
 
@@ -74,6 +81,11 @@ struct linc_module *linc_register_default_module(struct linc_module_list *module
     return module;
 }
 
+// Records only keep the name of their module, which is embedded in the module itself.
+struct linc_module *linc_module_of_name(const char *module_name) {
+    return (struct linc_module *)(module_name - offsetof(struct linc_module, name));
+}
+
 // ==================================================
 // Public Functions
 // ==================================================
@@ -95,9 +107,7 @@ int linc_set_module_level(linc_module module, enum linc_level level) {
     if (module == NULL || linc_check_level_module(level) < 0) {
         return -1;
     }
-    pthread_rwlock_wrlock(&module->lock);
-    module->level = level;
-    pthread_rwlock_unlock(&module->lock);
+    linc_state_set_level(&module->state, level);
     return 0;
 }
 
@@ -106,8 +116,32 @@ int linc_set_module_enabled(linc_module module, bool enabled) {
     if (module == NULL) {
         return -1;
     }
-    pthread_rwlock_wrlock(&module->lock);
-    module->enabled = enabled;
-    pthread_rwlock_unlock(&module->lock);
+    linc_state_set_enabled(&module->state, enabled);
+    return 0;
+}
+
+int linc_set_module_backpressure(linc_module module,
+                                 enum linc_level level,
+                                 enum linc_backpressure backpressure,
+                                 uint32_t timeout_us) {
+    linc_init();
+    bool is_failed = false;
+    is_failed |= module == NULL;
+    is_failed |= linc_check_level_module(level) < 0;
+    is_failed |= linc_check_backpressure_module(backpressure) < 0;
+
+    if (is_failed == true) {
+        return -1;
+    }
+    LINC_ATOMIC_STORE(&module->backpressure_timeout[level], timeout_us, LINC_RELEASE);
+    LINC_ATOMIC_STORE(&module->backpressure[level], (int)backpressure, LINC_RELEASE);
     return 0;
 }
+
+size_t linc_get_module_dropped(linc_module module) {
+    linc_init();
+    if (module == NULL) {
+        return 0;
+    }
+    return LINC_ATOMIC_LOAD(&module->dropped, LINC_RELAXED);
+}
@@ -0,0 +1,226 @@
+#include "internal/shared.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// ==================================================
+// Ring File Reader
+// ==================================================
+//
+// Reads the records left in a ring file and prints them as the default text layout would have. Nothing here uses the
+// state of the library, so linc-recover links this file and utils.c only: linking the whole library would start it
+// with the tool, and place the ring of the tool in the very file it was asked to read. The crash handler prints its
+// lines the same way, since it cannot render layouts either.
+
+// Reads a name written by linc_recovery_put_name, an empty name is a missing one. Returns false if the name does not
+// end before the record.
+static bool linc_recovery_get_name(const char **cursor, const char *end, const char **name) {
+    const char *zero = memchr(*cursor, '\0', (size_t)(end - *cursor));
+    if (zero == NULL) {
+        return false;
+    }
+    *name = zero > *cursor ? *cursor : NULL;
+    *cursor = zero + LINC_ZERO_CHAR_LENGTH;
+    return true;
+}
+
+// Checks the header of the bytes of a ring file and starts reading at the tail. Returns -1 if the bytes are not a ring
+// file of this build.
+int linc_recovery_open(struct linc_recovery_reader *reader, const void *data, size_t length) {
+    const struct linc_recovery_header *header = (const struct linc_recovery_header *)data;
+    if (length < LINC_RECOVERY_HEADER_BYTES || memcmp(header->magic, LINC_RECOVERY_MAGIC, sizeof(header->magic)) != 0
+        || header->version != LINC_RECOVERY_VERSION
+        || header->record_header != (uint32_t)offsetof(struct linc_record, message)) {
+        return -1;
+    }
+    if (header->size == 0 || header->size % LINC_RECORD_ALIGNMENT != 0
+        || header->size > length - LINC_RECOVERY_HEADER_BYTES) {
+        return -1;
+    }
+    reader->header = header;
+    reader->bytes = (const unsigned char *)data + LINC_RECOVERY_HEADER_BYTES;
+    reader->position = header->tail;
+    reader->end = header->tail + header->size;
+    return 0;
+}
+
+// Reads the next record into the metadata, its names point into the bytes of the file. Returns 1 for a record, 0
+// after the last published record and -1 if the bytes are not a valid record. Records are read until the first one
+// that is not published, so the records after a thread that crashed while writing its own are lost.
+int linc_recovery_next(struct linc_recovery_reader *reader, struct linc_metadata *metadata) {
+    uint64_t size = reader->header->size;
+    while (reader->position < reader->end) {
+        uint64_t offset = reader->position % size;
+        uint32_t value = 0;
+        memcpy(&value, reader->bytes + offset, sizeof(value));
+        if (value == 0) {
+            return 0;
+        }
+        uint64_t length = value & ~LINC_RECORD_PADDING;
+        if (length == 0 || length % LINC_RECORD_ALIGNMENT != 0 || length > size - offset) {
+            return -1;
+        }
+        if ((value & LINC_RECORD_PADDING) != 0) {
+            reader->position += length;
+            continue;
+        }
+
+        const struct linc_record *record = (const struct linc_record *)(const void *)(reader->bytes + offset);
+        if (length < offsetof(struct linc_record, message)
+            || (uint64_t)record->message_length + LINC_ZERO_CHAR_LENGTH + sizeof(int64_t) + sizeof(uint64_t)
+                   > length - offsetof(struct linc_record, message)) {
+            return -1;
+        }
+        const char *end = (const char *)record + length;
+        const char *cursor = record->message + record->message_length + LINC_ZERO_CHAR_LENGTH;
+        uint64_t thread_id = 0;
+        memcpy(&metadata->timestamp, cursor, sizeof(metadata->timestamp));
+        cursor += sizeof(metadata->timestamp);
+        memcpy(&thread_id, cursor, sizeof(thread_id));
+        cursor += sizeof(thread_id);
+        if (!linc_recovery_get_name(&cursor, end, &metadata->module_name)
+            || !linc_recovery_get_name(&cursor, end, &metadata->filename)
+            || !linc_recovery_get_name(&cursor, end, &metadata->func)) {
+            return -1;
+        }
+
+        metadata->level = (enum linc_level)record->level;
+        metadata->thread_id = (uintptr_t)thread_id;
+        metadata->thread = 0;
+        metadata->line = record->line;
+        if ((record->flags & LINC_RECORD_DEFERRED) != 0) {
+            memcpy(metadata->message, LINC_RECOVERY_DEFERRED, sizeof(LINC_RECOVERY_DEFERRED));
+        } else {
+            size_t message_length = record->message_length < sizeof(metadata->message) - LINC_ZERO_CHAR_LENGTH
+                                        ? record->message_length
+                                        : sizeof(metadata->message) - LINC_ZERO_CHAR_LENGTH;
+            memcpy(metadata->message, record->message, message_length);
+            metadata->message[message_length] = '\0';
+        }
+        reader->position += length;
+        return 1;
+    }
+    return 0;
+}
+
+// ==================================================
+// Recovered Lines
+// ==================================================
+//
+// Lines are formatted by hand in the default text layout, with UTC timestamps in milliseconds whatever the
+// configuration, and only with async-signal-safe functions, so the crash handler can use them.
+
+static void linc_recovery_append(struct linc_recovery_line *line, const char *text, size_t length) {
+    size_t available = sizeof(line->text) - line->length;
+    length = length < available ? length : available;
+    memcpy(line->text + line->length, text, length);
+    line->length += length;
+}
+
+// Appends a name cut at its maximum length and padded to the width, missing names are printed as "unknown".
+static void linc_recovery_append_name(struct linc_recovery_line *line,
+                                      const char *name,
+                                      size_t max_length,
+                                      size_t width) {
+    const char *text = name != NULL ? name : "unknown";
+    size_t length = strnlen(text, max_length);
+    linc_recovery_append(line, text, length);
+    for (; length < width; length++) {
+        linc_recovery_append(line, " ", 1);
+    }
+}
+
+// Appends the number in decimal, with leading zeros up to the count of digits.
+static void linc_recovery_append_digits(struct linc_recovery_line *line, uint64_t value, size_t count) {
+    char digits[20];
+    size_t position = sizeof(digits);
+    do {
+        digits[--position] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    while (sizeof(digits) - position < count && position > 0) {
+        digits[--position] = '0';
+    }
+    linc_recovery_append(line, digits + position, sizeof(digits) - position);
+}
+
+static void linc_recovery_append_hex(struct linc_recovery_line *line, uint64_t value, size_t count) {
+    static const char hex[] = "0123456789abcdef";
+    char digits[LINC_THREAD_ID_TEXT_LENGTH];
+    for (size_t i = count; i > 0; i--) {
+        digits[i - 1] = hex[value & 0xF];
+        value >>= 4;
+    }
+    linc_recovery_append(line, digits, count);
+}
+
+// Appends "YYYY-MM-DD HH:MM:SS.mmm" in UTC, the date is computed from the days since epoch, since gmtime_r may take a
+// lock.
+static void linc_recovery_append_timestamp(struct linc_recovery_line *line, int64_t timestamp) {
+    int64_t seconds = timestamp / 1000000000L;
+    int64_t milliseconds = timestamp % 1000000000L / 1000000L;
+    if (milliseconds < 0) {
+        milliseconds += 1000;
+        seconds -= 1;
+    }
+    int64_t days = seconds / 86400;
+    int64_t day_seconds = seconds % 86400;
+    if (day_seconds < 0) {
+        day_seconds += 86400;
+        days -= 1;
+    }
+    days += 719468;
+    int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    int64_t day_of_era = days - era * 146097;
+    int64_t year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    int64_t day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    int64_t month_index = (5 * day_of_year + 2) / 153;
+    int64_t day = day_of_year - (153 * month_index + 2) / 5 + 1;
+    int64_t month = month_index < 10 ? month_index + 3 : month_index - 9;
+    int64_t year = year_of_era + era * 400 + (month <= 2);
+    if (year < 0 || year > 9999) {
+        year = 0;
+    }
+
+    linc_recovery_append_digits(line, (uint64_t)year, 4);
+    linc_recovery_append(line, "-", 1);
+    linc_recovery_append_digits(line, (uint64_t)month, 2);
+    linc_recovery_append(line, "-", 1);
+    linc_recovery_append_digits(line, (uint64_t)day, 2);
+    linc_recovery_append(line, " ", 1);
+    linc_recovery_append_digits(line, (uint64_t)(day_seconds / 3600), 2);
+    linc_recovery_append(line, ":", 1);
+    linc_recovery_append_digits(line, (uint64_t)(day_seconds / 60 % 60), 2);
+    linc_recovery_append(line, ":", 1);
+    linc_recovery_append_digits(line, (uint64_t)(day_seconds % 60), 2);
+    linc_recovery_append(line, ".", 1);
+    linc_recovery_append_digits(line, (uint64_t)milliseconds, 3);
+}
+
+// Formats the metadata into the line, ended by a newline. The thread is printed from its ID, the index is ignored.
+void linc_recovery_format(struct linc_recovery_line *line, const struct linc_metadata *metadata) {
+    line->length = 0;
+    linc_recovery_append(line, "[ ", 2);
+    linc_recovery_append_timestamp(line, metadata->timestamp);
+    linc_recovery_append(line, " ] [ ", 5);
+    const char *level = linc_level_string(metadata->level);
+    linc_recovery_append_name(line, level, LINC_LOG_LEVEL_LENGTH, LINC_LOG_LEVEL_LENGTH);
+    linc_recovery_append(line, " ] [ ", 5);
+    linc_recovery_append_hex(line, (uint64_t)metadata->thread_id, LINC_THREAD_ID_TEXT_LENGTH);
+    linc_recovery_append(line, " ] [ ", 5);
+    size_t module_width = LINC_DEFAULT_MODULE_NAME_LENGTH;
+    linc_recovery_append_name(line, metadata->module_name, module_width, module_width);
+    linc_recovery_append(line, " ] ", 3);
+    linc_recovery_append_name(line, metadata->filename, LINC_LOG_FILE_LENGTH, 0);
+    linc_recovery_append(line, ":", 1);
+    linc_recovery_append_digits(line, metadata->line, 1);
+    linc_recovery_append(line, " ", 1);
+    linc_recovery_append_name(line, metadata->func, LINC_LOG_FUNC_LENGTH, 0);
+    linc_recovery_append(line, ": ", 2);
+    linc_recovery_append(line, metadata->message, strnlen(metadata->message, LINC_DEFAULT_MAX_MESSAGE_LENGTH));
+    if (line->length == sizeof(line->text)) {
+        line->length--;
+    }
+    line->text[line->length++] = '\n';
+}
@@ -0,0 +1,240 @@
+#include "internal/shared.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ==================================================
+// Ring File
+// ==================================================
+//
+// When LINC_RING_FILE names a file at startup, the shared ring buffer lives in a shared mapping of that file instead
+// of the process memory, so its records survive a crash of the process and linc-recover can print the ones the worker
+// had not taken yet. The file starts with a page of header, with the size of the ring and a copy of its tail, and
+// every record carries after its message what another process needs to print it: its timestamp already converted, its
+// thread ID and copies of its module, file and function names. Records of per-thread buffers are not in the file.
+//
+//   [timestamp: int64] [thread ID: uint64] [module] 0 [file] 0 [function] 0
+
+static size_t linc_recovery_name_length(const char *name) {
+    return name != NULL ? strnlen(name, LINC_RECOVERY_NAME_LENGTH) : 0;
+}
+
+static char *linc_recovery_put_name(char *cursor, const char *name) {
+    size_t length = linc_recovery_name_length(name);
+    if (length > 0) {
+        memcpy(cursor, name, length);
+    }
+    cursor[length] = '\0';
+    return cursor + length + LINC_ZERO_CHAR_LENGTH;
+}
+
+// Checks what an earlier process left in the file before it is truncated. A file still holding records is moved
+// aside to "<path>.<pid>", with the pid of the process that wrote it, so linc-recover can still print them. Returns -1
+// if the file cannot be reused: the process that wrote it is still running, e.g., the parent of a process that
+// inherited LINC_RING_FILE, or the file is not a ring file of this build.
+static int linc_recovery_check(const char *path) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return errno == ENOENT ? 0 : -1;
+    }
+    struct stat info;
+    if (fstat(fd, &info) < 0 || info.st_size == 0) {
+        close(fd);
+        return info.st_size == 0 ? 0 : -1;
+    }
+    void *data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return -1;
+    }
+
+    struct linc_recovery_reader reader;
+    struct linc_metadata metadata;
+    int status = linc_recovery_open(&reader, data, (size_t)info.st_size);
+    pid_t pid = status == 0 ? (pid_t)reader.header->pid : 0;
+    if (status == 0 && pid > 0 && pid != getpid() && (kill(pid, 0) == 0 || errno == EPERM)) {
+        status = -1;
+    } else if (status == 0 && linc_recovery_next(&reader, &metadata) != 0) {
+        char aside[LINC_RECOVERY_PATH_LENGTH];
+        int length = snprintf(aside, sizeof(aside), "%s.%ld", path, (long)pid);
+        if (length < 0 || (size_t)length >= sizeof(aside) || rename(path, aside) < 0) {
+            status = -1;
+        }
+    }
+    munmap(data, (size_t)info.st_size);
+    return status;
+}
+
+// Maps the file and places the ring buffer in it, the file is created or truncated once linc_recovery_check allows
+// it. Returns -1 if it cannot be mapped, the ring is then left untouched.
+int linc_recovery_map(struct linc_ring_buffer *ring, const char *path, size_t size, struct linc_signal *consume) {
+    if (linc_recovery_check(path) < 0) {
+        return -1;
+    }
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return -1;
+    }
+    size_t length = LINC_RECOVERY_HEADER_BYTES + size;
+    if (ftruncate(fd, (off_t)length) < 0) {
+        close(fd);
+        return -1;
+    }
+    void *mapping = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return -1;
+    }
+
+    struct linc_recovery_header *header = (struct linc_recovery_header *)mapping;
+    memcpy(header->magic, LINC_RECOVERY_MAGIC, sizeof(header->magic));
+    header->version = LINC_RECOVERY_VERSION;
+    header->record_header = (uint32_t)offsetof(struct linc_record, message);
+    header->size = (uint64_t)size;
+    header->pid = (int64_t)getpid();
+    header->tail = 0;
+    linc_ring_buffer_init(ring, (unsigned char *)mapping + LINC_RECOVERY_HEADER_BYTES, size, false, consume);
+    ring->recovery_tail = &header->tail;
+    return 0;
+}
+
+// Bytes written by linc_recovery_encode after the message of the record.
+size_t linc_recovery_length(const struct linc_metadata *metadata) {
+    return sizeof(int64_t) + sizeof(uint64_t) + linc_recovery_name_length(metadata->module_name)
+           + linc_recovery_name_length(metadata->filename) + linc_recovery_name_length(metadata->func)
+           + 3 * LINC_ZERO_CHAR_LENGTH;
+}
+
+void linc_recovery_encode(struct linc_record *record, const struct linc_metadata *metadata, uint8_t flags) {
+    char *cursor = record->message + record->message_length + LINC_ZERO_CHAR_LENGTH;
+    int64_t timestamp = linc_clock_nanoseconds(metadata->timestamp, flags);
+    const struct linc_thread *thread = linc_thread_of(metadata->thread);
+    uint64_t thread_id = thread != NULL ? (uint64_t)thread->id : (uint64_t)metadata->thread_id;
+    memcpy(cursor, &timestamp, sizeof(timestamp));
+    cursor += sizeof(timestamp);
+    memcpy(cursor, &thread_id, sizeof(thread_id));
+    cursor += sizeof(thread_id);
+    cursor = linc_recovery_put_name(cursor, metadata->module_name);
+    cursor = linc_recovery_put_name(cursor, metadata->filename);
+    linc_recovery_put_name(cursor, metadata->func);
+}
+
+// ==================================================
+// Crash Handler
+// ==================================================
+//
+// The crash handler writes the records still in the ring buffers to a file descriptor when the process receives a
+// fatal signal, then lets the signal kill the process. It only reads the buffers, the worker may still be running,
+// and it only calls async-signal-safe functions: lines are formatted by linc_recovery_format, as linc-recover prints
+// them, and written with write. Records with deferred formatting are the exception, their arguments are rendered with
+// snprintf, as a best effort. Records the worker already took from the buffers but sinks have not written yet are
+// lost.
+
+static const int linc_crash_signals[] = {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT};
+
+static int linc_crash_fd = -1;
+static bool linc_crash_is_draining = false;
+static struct linc_recovery_line linc_crash_line;
+static struct linc_metadata linc_crash_metadata;
+
+static void linc_crash_write(int fd, const struct linc_recovery_line *line) {
+    size_t written = 0;
+    while (written < line->length) {
+        ssize_t result = write(fd, line->text + written, line->length - written);
+        if (result <= 0) {
+            if (result < 0 && errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        written += (size_t)result;
+    }
+}
+
+static void linc_crash_format(struct linc_recovery_line *line, const struct linc_record *record) {
+    struct linc_metadata *metadata = &linc_crash_metadata;
+    const struct linc_thread *thread = linc_thread_of(record->thread);
+    metadata->timestamp = linc_clock_nanoseconds_bounded(record->timestamp, record->flags);
+    metadata->level = (enum linc_level)record->level;
+    metadata->thread_id = thread != NULL ? thread->id : linc_record_thread_id(record);
+    metadata->module_name = record->module_name;
+    metadata->filename = record->filename;
+    metadata->line = record->line;
+    metadata->func = record->func;
+    if ((record->flags & LINC_RECORD_DEFERRED) == 0) {
+        size_t length = strnlen(record->message, LINC_DEFAULT_MAX_MESSAGE_LENGTH);
+        memcpy(metadata->message, record->message, length);
+        metadata->message[length] = '\0';
+    } else if (linc_format_render(record->message, metadata->message, sizeof(metadata->message)) < 0) {
+        memcpy(metadata->message, LINC_RECOVERY_DEFERRED, sizeof(LINC_RECOVERY_DEFERRED));
+    }
+    linc_recovery_format(line, metadata);
+}
+
+// Writes the published records of the ring from its tail, without moving it, and stops at the first record that is
+// not published or after a whole ring, in case the worker moved the tail meanwhile.
+static void linc_crash_drain(int fd, struct linc_ring_buffer *ring) {
+    size_t position = LINC_ATOMIC_LOAD(&ring->tail, LINC_ACQUIRE);
+    size_t end = position + ring->size;
+    while (position < end) {
+        const uint32_t *length = (const uint32_t *)(const void *)(ring->buffer + position % ring->size);
+        uint32_t value = LINC_ATOMIC_LOAD(length, LINC_ACQUIRE);
+        uint32_t size = value & ~LINC_RECORD_PADDING;
+        if (size == 0 || size % LINC_RECORD_ALIGNMENT != 0 || size > ring->size - position % ring->size) {
+            return;
+        }
+        if ((value & LINC_RECORD_PADDING) == 0) {
+            linc_crash_format(&linc_crash_line, (const struct linc_record *)(const void *)length);
+            linc_crash_write(fd, &linc_crash_line);
+        }
+        position += size;
+    }
+}
+
+static void linc_crash_handle(int signal_number) {
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = SIG_DFL;
+    sigemptyset(&action.sa_mask);
+    sigaction(signal_number, &action, NULL);
+
+    // Only the first thread to crash writes the records, the others get the default action once it raises the signal.
+    bool is_draining = false;
+    int saved_errno = errno;
+    if (LINC_ATOMIC_CAS(&linc_crash_is_draining, &is_draining, true, LINC_ACQ_REL)) {
+        int fd = LINC_ATOMIC_LOAD(&linc_crash_fd, LINC_ACQUIRE);
+        linc_crash_drain(fd, &linc.ring_buffer);
+        for (size_t i = 0; i < LINC_DEFAULT_MAX_THREAD_BUFFERS; i++) {
+            linc_crash_drain(fd, &linc.thread_buffers.list[i].ring);
+        }
+    }
+    errno = saved_errno;
+    raise(signal_number);
+}
+
+int linc_set_crash_handler(int fd) {
+    linc_init();
+    if (fd < 0) {
+        return -1;
+    }
+    LINC_ATOMIC_STORE(&linc_crash_fd, fd, LINC_RELEASE);
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = linc_crash_handle;
+    sigfillset(&action.sa_mask);
+    for (size_t i = 0; i < sizeof(linc_crash_signals) / sizeof(linc_crash_signals[0]); i++) {
+        if (sigaction(linc_crash_signals[i], &action, NULL) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
@@ -1,56 +1,991 @@
 #include "internal/shared.h"
 #include "linc.h"
 
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <pthread.h>
+#include <spawn.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <time.h>
 #include <unistd.h>
 
 // ==================================================
-// Default Sink Functions
+// Stream Sinks
 // ==================================================
+//
+// The default sink writes to stderr, and the sink of linc_sink_stdout_funcs to stdout, straight to the file
+// descriptor instead of through stdio. Every batch takes a single writev: the texts shared by the sinks of the same
+// layout are written from the dispatch ring without a copy, the other texts are gathered in a private buffer first.
+// Terminals get colors and every record right away, otherwise the default sink waits up to
+// LINC_DEFAULT_STREAM_LATENCY_US for a fuller batch, so a pipe to a log collector takes a system call per batch
+// instead of one per line.
 
-static int linc_sink_stderr_open(void *data) {
-    (void)data;
+// Left without initializer, so their buffers are not stored in the data segment of every binary linking the library.
+static struct linc_sink_stream linc_sink_stderr;
+static struct linc_sink_stream linc_sink_stdout;
+
+// A stream is written by one sink only, so a second registration of the same stream fails.
+static int linc_sink_stream_open(void *data) {
+    struct linc_sink_stream *stream = (struct linc_sink_stream *)data;
+    if (stream->is_open == true) {
+        return -1;
+    }
+    stream->is_open = true;
+    stream->layout = isatty(stream->fd) == 1 ? linc_layout_text_color : linc_layout_text;
+    stream->count = 0;
+    stream->used = 0;
     return 0;
 }
 
-static int linc_sink_stderr_close(void *data) {
+static int linc_sink_stream_close(void *data) {
+    struct linc_sink_stream *stream = (struct linc_sink_stream *)data;
+    stream->is_open = false;
+    return 0;
+}
+
+// Every batch is written before the sink returns, nothing is left to flush.
+static int linc_sink_stream_flush(void *data) {
     (void)data;
     return 0;
 }
 
-static int linc_sink_stderr_write(void *data, struct linc_metadata *metadata) {
-    FILE *output_file = (FILE *)data;
+static bool linc_sink_stream_is_shared(const char *text) {
+    uintptr_t address = (uintptr_t)text;
+    uintptr_t texts = (uintptr_t)linc.dispatch.texts;
+    return address >= texts && address < texts + sizeof(linc.dispatch.texts);
+}
+
+// Writes the pieces, resuming after partial writes, e.g., on pipes. The pieces are changed along the way.
+static int linc_sink_writev(int fd, struct iovec *iovecs, int count) {
+    while (count > 0) {
+        ssize_t written = writev(fd, iovecs, count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        while (count > 0 && (size_t)written >= iovecs->iov_len) {
+            written -= (ssize_t)iovecs->iov_len;
+            iovecs++;
+            count--;
+        }
+        if (count > 0) {
+            iovecs->iov_base = (char *)iovecs->iov_base + written;
+            iovecs->iov_len -= (size_t)written;
+        }
+    }
+    return 0;
+}
+
+// Returns the text of the log, or an error line if it cannot be rendered.
+static const char *linc_sink_view(linc_layout layout, struct linc_metadata *metadata, size_t *length) {
+    static const char error[] = "[ LINC ERROR ] Internal logging error\n";
+    const char *text = linc_layout_view(layout, metadata, length);
+    if (text == NULL) {
+        text = error;
+        *length = sizeof(error) - LINC_ZERO_CHAR_LENGTH;
+    }
+    return text;
+}
+
+static int linc_sink_stream_write_pieces(struct linc_sink_stream *stream) {
+    int result = linc_sink_writev(stream->fd, stream->iovecs, stream->count);
+    stream->count = 0;
+    stream->used = 0;
+    return result;
+}
+
+// Adds the text of the log to the pieces of the stream.
+static int linc_sink_stream_append(struct linc_sink_stream *stream, struct linc_metadata *metadata) {
+    size_t length = 0;
+    const char *text = linc_sink_view(stream->layout, metadata, &length);
+    bool is_shared = linc_sink_stream_is_shared(text);
+    int result = 0;
+    if (stream->count == LINC_SINK_STREAM_IOVECS || (!is_shared && sizeof(stream->buffer) - stream->used < length)) {
+        result = linc_sink_stream_write_pieces(stream);
+    }
+    if (!is_shared) {
+        memcpy(stream->buffer + stream->used, text, length);
+        text = stream->buffer + stream->used;
+        stream->used += length;
+        struct iovec *last = stream->count > 0 ? &stream->iovecs[stream->count - 1] : NULL;
+        if (last != NULL && (char *)last->iov_base + last->iov_len == text) {
+            last->iov_len += length;
+            return result;
+        }
+    }
+    stream->iovecs[stream->count].iov_base = (void *)text;
+    stream->iovecs[stream->count].iov_len = length;
+    stream->count++;
+    return result;
+}
+
+static int linc_sink_stream_write(void *data, struct linc_metadata *metadata) {
+    struct linc_sink_stream *stream = (struct linc_sink_stream *)data;
+    int result = linc_sink_stream_append(stream, metadata);
+    return linc_sink_stream_write_pieces(stream) | result;
+}
+
+static int linc_sink_stream_write_batch(void *data, struct linc_metadata *const *records, size_t count) {
+    struct linc_sink_stream *stream = (struct linc_sink_stream *)data;
+    int result = 0;
+    for (size_t i = 0; i < count; i++) {
+        result |= linc_sink_stream_append(stream, records[i]);
+    }
+    return linc_sink_stream_write_pieces(stream) | result;
+}
+
+static struct linc_sink_funcs linc_sink_stream_funcs(struct linc_sink_stream *stream, int fd) {
+    stream->fd = fd;
+    struct linc_sink_funcs funcs = {
+        .data = stream,
+        .open = linc_sink_stream_open,
+        .close = linc_sink_stream_close,
+        .write = linc_sink_stream_write,
+        .flush = linc_sink_stream_flush,
+        .write_batch = linc_sink_stream_write_batch,
+    };
+    return funcs;
+}
+
+// ==================================================
+// File Sinks
+// ==================================================
+//
+// A file sink keeps the lines of many batches in a page aligned buffer, and writes them once the buffer is full or
+// once the flush delay of the sink passed since the first line it holds. A busy log file takes a system call every
+// buffer, tens of kilobytes, instead of one per line as with fprintf and fflush. A line that does not fit is written
+// with the buffer by a single writev, without a copy. Files are opened in append mode, so other processes appending to
+// the same file never overwrite these lines.
+//
+// Rotating file sinks start a new file before a line would make the current one larger than their maximum size, or
+// once their interval passed. The sink thread only writes the buffer, renames the file to its path followed by a
+// sequence number and opens the path again, so lines keep their order across files and none is lost. Closing the old
+// file, compressing it and deleting the oldest rotated files is left to a helper thread with the lowest priority. The
+// last rotating sink to close waits for the helper to finish and joins it.
+//
+// Binary sinks are file sinks that write the records of binary.c instead of lines. Each sink, and each new file of a
+// sink, starts a new segment of records, which decodes without the previous ones.
+//
+// Asynchronous file sinks split their buffer in slices and submit each full slice to io_uring, then fill the next one
+// while the kernel writes it, so the sink thread does not wait for the disk while a few slices are in flight. Writes
+// carry their offset, so the file is not opened in append mode and the order of the lines does not depend on the order
+// of completions. Completions are reaped without blocking, and a slice is only waited for when the sink needs it again.
+// Flushing submits the slice being filled and waits for every completion. Where io_uring is not available, the sink
+// writes synchronously like any other file sink.
+//
+// With LINC_DEFAULT_MAX_FILE_SINKS set to 0, file sinks are compiled out with their buffers, and their builders return
+// functions that fail to register.
+
+#if LINC_DEFAULT_MAX_FILE_SINKS > 0
+
+#define LINC_SINK_FILE_FLAGS (O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC)  // Flags every file sink opens its file with
+#define LINC_SINK_FILE_ASYNC_FLAGS (O_WRONLY | O_CREAT | O_CLOEXEC)        // Flags of asynchronous file sinks
+#define LINC_SINK_FILE_URING_ENTRIES (LINC_SINK_FILE_SLICES * 2)          // Entries of the ring of a file sink
+
+extern char **environ;
+
+static struct linc_sink_file_list linc_sink_files = {.mutex = PTHREAD_MUTEX_INITIALIZER};
+static struct linc_sink_binary_list linc_sink_binaries;
+static struct linc_sink_rotation_queue linc_sink_rotations = {
+    .head = 0,
+    .tail = 0,
+    .done = 0,
+    .users = 0,
+    .is_started = false,
+    .is_stopping = false,
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+
+static int64_t linc_sink_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec;
+}
+
+// Deletes the rotated files of the sink with a sequence number lower than the oldest one to keep, and returns the
+// sequence number of the newest rotated file, 0 if there is none.
+static unsigned long linc_sink_rotation_scan(const struct linc_sink_file *file, unsigned long oldest) {
+    const char *slash = strrchr(file->path, '/');
+    const char *base = slash != NULL ? slash + 1 : file->path;
+    size_t base_length = strlen(base);
+    int directory_length = (int)(base - file->path);
+    char directory[LINC_SINK_FILE_PATH_LENGTH + LINC_ZERO_CHAR_LENGTH] = ".";
+    if (directory_length > 0) {
+        snprintf(directory, sizeof(directory), "%.*s", directory_length, file->path);
+    }
+
+    DIR *dir = opendir(directory);
+    if (dir == NULL) {
+        return 0;
+    }
+    unsigned long newest = 0;
+    struct dirent *entry = NULL;
+    while ((entry = readdir(dir)) != NULL) {
+        const char *name = entry->d_name;
+        if (strncmp(name, base, base_length) != 0 || name[base_length] != '.') {
+            continue;
+        }
+        const char *digits = name + base_length + 1;
+        if (*digits < '0' || *digits > '9') {
+            continue;
+        }
+        char *end = NULL;
+        unsigned long sequence = strtoul(digits, &end, 10);
+        if (*end != '\0' && strcmp(end, ".gz") != 0) {
+            continue;
+        }
+        if (sequence > newest) {
+            newest = sequence;
+        }
+        if (sequence < oldest) {
+            char rotated[LINC_SINK_FILE_PATH_LENGTH * 2];
+            snprintf(rotated, sizeof(rotated), "%.*s%s", directory_length, file->path, name);
+            unlink(rotated);
+        }
+    }
+    closedir(dir);
+    return newest;
+}
+
+// Tells whether posix_spawnp finds gzip in the PATH, the default path of the C library if it is not set.
+static bool linc_sink_rotation_has_gzip(void) {
+    const char *path = getenv("PATH");
+    if (path == NULL) {
+        path = "/bin:/usr/bin";
+    }
+    while (true) {
+        size_t length = strcspn(path, ":");
+        char candidate[LINC_SINK_FILE_PATH_LENGTH * 2];
+        if (length == 0) {
+            snprintf(candidate, sizeof(candidate), "gzip");
+        } else {
+            snprintf(candidate, sizeof(candidate), "%.*s/gzip", (int)length, path);
+        }
+        if (access(candidate, X_OK) == 0) {
+            return true;
+        }
+        if (path[length] == '\0') {
+            return false;
+        }
+        path += length + 1;
+    }
+}
+
+static void linc_sink_rotation_compress(const char *rotated) {
+    char *argv[] = {(char *)"gzip", (char *)"-f", (char *)"-q", (char *)"--", (char *)rotated, NULL};
+    pid_t pid;
+    if (posix_spawnp(&pid, "gzip", NULL, NULL, argv, environ) != 0) {
+        return;
+    }
+    while (waitpid(pid, NULL, 0) < 0 && errno == EINTR) {
+        continue;
+    }
+}
+
+static void *linc_sink_rotation_helper(void *arg) {
+    (void)arg;
+#if defined(__linux__)
+    // Linux keeps a nice value per thread, elsewhere this would lower the priority of the whole process.
+    setpriority(PRIO_PROCESS, 0, LINC_SINK_ROTATION_NICE);
+#endif
+    struct linc_sink_rotation_queue *queue = &linc_sink_rotations;
+    while (true) {
+        pthread_mutex_lock(&queue->mutex);
+        while (queue->head == queue->tail && !queue->is_stopping) {
+            pthread_cond_wait(&queue->cond, &queue->mutex);
+        }
+        if (queue->head == queue->tail) {
+            pthread_mutex_unlock(&queue->mutex);
+            break;
+        }
+        struct linc_sink_rotation_job job = queue->jobs[queue->tail % LINC_SINK_ROTATION_JOBS];
+        queue->tail++;
+        pthread_mutex_unlock(&queue->mutex);
+
+        close(job.fd);
+        struct linc_sink_file *file = job.file;
+        if (file->is_compressed) {
+            char rotated[LINC_SINK_FILE_PATH_LENGTH * 2];
+            snprintf(rotated, sizeof(rotated), "%s.%lu", file->path, job.sequence);
+            linc_sink_rotation_compress(rotated);
+        }
+        if (file->max_files > 0 && job.sequence >= file->max_files) {
+            linc_sink_rotation_scan(file, job.sequence - file->max_files + 1);
+        }
+
+        pthread_mutex_lock(&queue->mutex);
+        queue->done++;
+        pthread_cond_broadcast(&queue->cond);
+        pthread_mutex_unlock(&queue->mutex);
+    }
+    return NULL;
+}
+
+// Counts a rotating sink as a user of the helper, starting the helper for the first one.
+static int linc_sink_rotation_acquire(void) {
+    struct linc_sink_rotation_queue *queue = &linc_sink_rotations;
+    pthread_mutex_lock(&queue->mutex);
+    while (queue->is_stopping) {
+        pthread_cond_wait(&queue->cond, &queue->mutex);
+    }
+    if (!queue->is_started) {
+        queue->is_started = pthread_create(&queue->thread, NULL, linc_sink_rotation_helper, NULL) == 0;
+    }
+    int result = queue->is_started ? 0 : -1;
+    queue->users += queue->is_started ? 1 : 0;
+    pthread_mutex_unlock(&queue->mutex);
+    return result;
+}
+
+// Waits until the helper finished the files rotated so far. The last rotating sink stops the helper and joins it, so
+// the library never exits in the middle of a compression.
+static void linc_sink_rotation_release(void) {
+    struct linc_sink_rotation_queue *queue = &linc_sink_rotations;
+    pthread_mutex_lock(&queue->mutex);
+    queue->users--;
+    if (queue->users > 0) {
+        while (queue->done < queue->head) {
+            pthread_cond_wait(&queue->cond, &queue->mutex);
+        }
+        pthread_mutex_unlock(&queue->mutex);
+        return;
+    }
+    queue->is_stopping = true;
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&queue->mutex);
+    pthread_join(queue->thread, NULL);
+
+    pthread_mutex_lock(&queue->mutex);
+    queue->is_started = false;
+    queue->is_stopping = false;
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&queue->mutex);
+}
+
+// Hands the old file over to the helper. If the helper is too far behind, the file is closed right away, it is then
+// neither compressed nor counted among the files to keep, and the sink reports an error.
+static int linc_sink_rotation_push(const struct linc_sink_rotation_job *job) {
+    struct linc_sink_rotation_queue *queue = &linc_sink_rotations;
+    pthread_mutex_lock(&queue->mutex);
+    bool is_full = queue->head - queue->tail == LINC_SINK_ROTATION_JOBS;
+    if (!is_full) {
+        queue->jobs[queue->head % LINC_SINK_ROTATION_JOBS] = *job;
+        queue->head++;
+        pthread_cond_broadcast(&queue->cond);
+    }
+    pthread_mutex_unlock(&queue->mutex);
+    if (is_full) {
+        close(job->fd);
+        return -1;
+    }
+    return 0;
+}
+
+// Tells whether the writes of the sink go through its io_uring.
+static bool linc_sink_file_is_async(const struct linc_sink_file *file) {
+    return file->uring.fd >= 0;
+}
+
+// Called by the sink thread with an empty buffer. If the file cannot be renamed or opened again, the sink keeps
+// writing to the current file and tries again after another maximum size or interval.
+static int linc_sink_file_rotate(struct linc_sink_file *file) {
+    file->rotate_at = linc_sink_seconds() + file->interval;
+    char rotated[LINC_SINK_FILE_PATH_LENGTH * 2];
+    snprintf(rotated, sizeof(rotated), "%s.%lu", file->path, file->sequence);
+    if (rename(file->path, rotated) < 0) {
+        file->size = 0;
+        return 0;
+    }
+    int flags = linc_sink_file_is_async(file) ? LINC_SINK_FILE_ASYNC_FLAGS : LINC_SINK_FILE_FLAGS;
+    int fd = open(file->path, flags, 0644);
+    if (fd < 0) {
+        rename(rotated, file->path);
+        file->size = 0;
+        return 0;
+    }
 
-    if (output_file == NULL) {
+    struct linc_sink_rotation_job job = {.fd = file->fd, .file = file, .sequence = file->sequence};
+    file->fd = fd;
+    file->size = 0;
+    file->offset = 0;
+    file->sequence++;
+    if (file->binary != NULL) {
+        linc_binary_reset(&file->binary->writer);
+    }
+    return linc_sink_rotation_push(&job);
+}
+
+// Writes the bytes at the offset, resuming after partial writes.
+static int linc_sink_pwrite(int fd, const char *buffer, size_t length, off_t offset) {
+    while (length > 0) {
+        ssize_t written = pwrite(fd, buffer, length, offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        buffer += written;
+        length -= (size_t)written;
+        offset += written;
+    }
+    return 0;
+}
+
+// Size of the part of the buffer being filled, a slice if the sink is asynchronous.
+static size_t linc_sink_file_capacity(const struct linc_sink_file *file) {
+    return linc_sink_file_is_async(file) ? file->length / LINC_SINK_FILE_SLICES : file->length;
+}
+
+static char *linc_sink_file_current(struct linc_sink_file *file) {
+    return file->buffer + file->slice * linc_sink_file_capacity(file);
+}
+
+// Frees the slice of a completion, writing synchronously what the kernel did not write.
+static int linc_sink_file_complete(struct linc_sink_file *file, uint64_t tag, int written) {
+    struct linc_sink_file_slice *slice = &file->slices[tag];
+    size_t done = written > 0 ? (size_t)written : 0;
+    int result = 0;
+    if (done < slice->length) {
+        const char *data = file->buffer + tag * linc_sink_file_capacity(file) + done;
+        result = linc_sink_pwrite(file->fd, data, slice->length - done, slice->offset + (off_t)done);
+    }
+    slice->is_pending = false;
+    return result;
+}
+
+static bool linc_sink_file_is_pending(const struct linc_sink_file *file) {
+    for (size_t i = 0; i < LINC_SINK_FILE_SLICES; i++) {
+        if (file->slices[i].is_pending) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Reaps the completions that arrived, then waits until the slice being filled is free, or every slice with is_all.
+static int linc_sink_file_reap(struct linc_sink_file *file, bool is_all) {
+    int result = 0;
+    while (true) {
+        bool is_waiting = is_all ? linc_sink_file_is_pending(file) : file->slices[file->slice].is_pending;
+        uint64_t tag = 0;
+        int written = 0;
+        int reaped = linc_uring_reap(&file->uring, is_waiting, &tag, &written);
+        if (reaped == 0) {
+            return result;
+        }
+        if (reaped < 0 || tag >= LINC_SINK_FILE_SLICES) {
+            // Completions are lost with the ring, so the slices cannot be told apart anymore.
+            for (size_t i = 0; i < LINC_SINK_FILE_SLICES; i++) {
+                file->slices[i].is_pending = false;
+            }
+            return -1;
+        }
+        result |= linc_sink_file_complete(file, tag, written);
+    }
+}
+
+// Submits the slice being filled at the end of the file and moves to the next slice, once the kernel is done with it.
+static int linc_sink_file_submit(struct linc_sink_file *file) {
+    int result = 0;
+    if (file->used > 0) {
+        struct linc_sink_file_slice *slice = &file->slices[file->slice];
+        const char *data = linc_sink_file_current(file);
+        slice->offset = file->offset;
+        slice->length = file->used;
+        slice->is_pending = linc_uring_write(&file->uring, file->fd, data, file->used, file->offset, file->slice) == 0;
+        if (!slice->is_pending) {
+            result = linc_sink_pwrite(file->fd, data, file->used, file->offset);
+        }
+        file->offset += (off_t)file->used;
+        file->size += file->used;
+        file->used = 0;
+        file->slice = (file->slice + 1) % LINC_SINK_FILE_SLICES;
+    }
+    return linc_sink_file_reap(file, false) | result;
+}
+
+// Opens the file, with its io_uring and the rotation helper if the sink needs them, all released by close.
+static int linc_sink_file_open(void *data) {
+    struct linc_sink_file *file = (struct linc_sink_file *)data;
+    if (file->is_open) {
         return -1;
     }
-    int fd = fileno(output_file);
+    file->uring.fd = -1;
+    if (file->is_async) {
+        linc_uring_init(&file->uring, LINC_SINK_FILE_URING_ENTRIES);
+    }
+    int fd = open(file->path, linc_sink_file_is_async(file) ? LINC_SINK_FILE_ASYNC_FLAGS : LINC_SINK_FILE_FLAGS, 0644);
+    struct stat st;
+    if (fd >= 0 && fstat(fd, &st) < 0) {
+        close(fd);
+        fd = -1;
+    }
+    if (fd >= 0 && file->is_rotating && linc_sink_rotation_acquire() < 0) {
+        close(fd);
+        fd = -1;
+    }
     if (fd < 0) {
+        linc_uring_exit(&file->uring);
         return -1;
     }
-    bool use_colors = isatty(fd) == 1;
+    file->fd = fd;
+    file->used = 0;
+    file->size = (size_t)st.st_size;
+    file->offset = st.st_size;
+    file->slice = 0;
+    memset(file->slices, 0, sizeof(file->slices));
+    file->rotate_at = linc_sink_seconds() + file->interval;
+    file->sequence = file->is_rotating ? linc_sink_rotation_scan(file, 0) + 1 : 0;
+    if (file->binary != NULL) {
+        linc_binary_reset(&file->binary->writer);
+    }
+    file->is_open = true;
+    return 0;
+}
 
-    char formatted_log[LINC_LOG_MAX_LENGTH + LINC_NEWLINE_CHAR_LENGTH + LINC_ZERO_CHAR_LENGTH];
-    int written = linc_stringify_metadata(metadata, formatted_log, sizeof(formatted_log), use_colors);
+// Writes every buffered line. Asynchronous sinks return once the kernel completed every write they submitted.
+static int linc_sink_file_flush(void *data) {
+    struct linc_sink_file *file = (struct linc_sink_file *)data;
+    if (linc_sink_file_is_async(file)) {
+        int result = linc_sink_file_submit(file);
+        return linc_sink_file_reap(file, true) | result;
+    }
+    if (file->used == 0) {
+        return 0;
+    }
+    struct iovec iovec = {.iov_base = file->buffer, .iov_len = file->used};
+    file->size += file->used;
+    file->used = 0;
+    return linc_sink_writev(file->fd, &iovec, 1);
+}
 
-    if (written < 0) {
-        strcpy(formatted_log, "[ LINC ERROR ] Internal logging error\n");
-        written = strlen(formatted_log);
-    } else if ((size_t)written >= sizeof(formatted_log)) {
-        written = sizeof(formatted_log) - 1;
+static int linc_sink_file_close(void *data) {
+    struct linc_sink_file *file = (struct linc_sink_file *)data;
+    int result = linc_sink_file_flush(file);
+    linc_uring_exit(&file->uring);
+    if (close(file->fd) < 0) {
+        result = -1;
+    }
+    file->fd = -1;
+    if (file->is_rotating) {
+        linc_sink_rotation_release();
     }
+    pthread_mutex_lock(&linc_sink_files.mutex);
+    file->is_open = false;
+    file->is_used = false;
+    pthread_mutex_unlock(&linc_sink_files.mutex);
+    return result;
+}
 
-    size_t write_size = fwrite(formatted_log, sizeof(char), written, output_file);
-    return write_size == (size_t)written ? 0 : -1;
+// Gives back the slot claimed by the builder, unless the sink is open.
+static void linc_sink_file_release(void *data) {
+    struct linc_sink_file *file = (struct linc_sink_file *)data;
+    pthread_mutex_lock(&linc_sink_files.mutex);
+    file->is_used = file->is_open;
+    pthread_mutex_unlock(&linc_sink_files.mutex);
 }
 
-static int linc_sink_stderr_flush(void *data) {
-    FILE *output_file = (FILE *)data;
-    return fflush(output_file);
+// Starts a new file once the interval of the sink passed, unless the current one is still empty.
+static int linc_sink_file_rotate_due(struct linc_sink_file *file) {
+    if (file->interval == 0) {
+        return 0;
+    }
+    int64_t now = linc_sink_seconds();
+    if (now < file->rotate_at) {
+        return 0;
+    }
+    if (file->size + file->used == 0) {
+        file->rotate_at = now + file->interval;
+        return 0;
+    }
+    int result = linc_sink_file_flush(file);
+    return linc_sink_file_rotate(file) | result;
+}
+
+// Returns the line of the log, or its record for binary sinks.
+static const char *linc_sink_file_render(struct linc_sink_file *file, struct linc_metadata *metadata, size_t *length) {
+    if (file->binary == NULL) {
+        return linc_sink_view(file->layout, metadata, length);
+    }
+    *length = linc_binary_encode(&file->binary->writer, metadata, file->binary->record);
+    return file->binary->record;
+}
+
+static int linc_sink_file_append(struct linc_sink_file *file, struct linc_metadata *metadata) {
+    size_t length = 0;
+    const char *text = linc_sink_file_render(file, metadata, &length);
+    int result = 0;
+    size_t pending = file->size + file->used;
+    if (file->max_size > 0 && pending > 0 && pending + length > file->max_size) {
+        result = linc_sink_file_flush(file);
+        result |= linc_sink_file_rotate(file);
+        if (file->binary != NULL) {
+            // The record may use identifiers defined in the previous file, the new one starts a new segment.
+            text = linc_sink_file_render(file, metadata, &length);
+        }
+    }
+    if (length <= linc_sink_file_capacity(file) - file->used) {
+        memcpy(linc_sink_file_current(file) + file->used, text, length);
+        file->used += length;
+        return result;
+    }
+    if (linc_sink_file_is_async(file)) {
+        result |= linc_sink_file_submit(file);
+        if (length <= linc_sink_file_capacity(file)) {
+            memcpy(linc_sink_file_current(file), text, length);
+            file->used = length;
+            return result;
+        }
+        // A line larger than a slice is written synchronously, at its own offset.
+        result |= linc_sink_pwrite(file->fd, text, length, file->offset);
+        file->offset += (off_t)length;
+        file->size += length;
+        return result;
+    }
+
+    struct iovec iovecs[2];
+    iovecs[0].iov_base = file->buffer;
+    iovecs[0].iov_len = file->used;
+    iovecs[1].iov_base = (void *)text;
+    iovecs[1].iov_len = length;
+    file->size += file->used + length;
+    file->used = 0;
+    return linc_sink_writev(file->fd, iovecs, 2) | result;
+}
+
+static int linc_sink_file_write(void *data, struct linc_metadata *metadata) {
+    struct linc_sink_file *file = (struct linc_sink_file *)data;
+    int result = linc_sink_file_rotate_due(file);
+    return linc_sink_file_append(file, metadata) | result;
+}
+
+static int linc_sink_file_write_batch(void *data, struct linc_metadata *const *records, size_t count) {
+    struct linc_sink_file *file = (struct linc_sink_file *)data;
+    int result = linc_sink_file_rotate_due(file);
+    for (size_t i = 0; i < count; i++) {
+        result |= linc_sink_file_append(file, records[i]);
+    }
+    return result;
 }
 
+// Claims a slot for the sink, the file is only opened once the sink is registered.
+static struct linc_sink_funcs linc_sink_file_create(const char *path,
+                                                    const struct linc_sink_file_options *options,
+                                                    const struct linc_sink_rotation_options *rotation,
+                                                    bool is_binary) {
+    struct linc_sink_funcs funcs;
+    memset(&funcs, 0, sizeof(funcs));
+    struct linc_sink_file_options defaults = {.buffer_size = 0, .flush_delay_us = 0, .layout = NULL, .is_async = false};
+    if (options == NULL) {
+        options = &defaults;
+    }
+    size_t length = options->buffer_size > 0 ? options->buffer_size : LINC_DEFAULT_FILE_BUFFER_BYTES;
+    if (path == NULL || strlen(path) > LINC_SINK_FILE_PATH_LENGTH || length > LINC_DEFAULT_FILE_BUFFER_BYTES) {
+        return funcs;
+    }
+    if (rotation != NULL && rotation->is_compressed && !linc_sink_rotation_has_gzip()) {
+        return funcs;
+    }
+
+    struct linc_sink_file_list *files = &linc_sink_files;
+    pthread_mutex_lock(&files->mutex);
+    size_t index = 0;
+    while (index < LINC_DEFAULT_MAX_FILE_SINKS && files->list[index].is_used) {
+        index++;
+    }
+    if (index == LINC_DEFAULT_MAX_FILE_SINKS) {
+        pthread_mutex_unlock(&files->mutex);
+        return funcs;
+    }
+    struct linc_sink_file *file = &files->list[index];
+    file->is_used = true;
+    file->is_open = false;
+    file->fd = -1;
+    file->uring.fd = -1;
+    file->is_async = options->is_async;
+    file->layout = options->layout != NULL ? options->layout : linc_layout_text;
+    file->binary = is_binary ? &linc_sink_binaries.list[index] : NULL;
+    file->length = length;
+    strcpy(file->path, path);
+    file->max_size = rotation != NULL ? rotation->max_size : 0;
+    file->interval = rotation != NULL ? rotation->interval_s : 0;
+    file->max_files = rotation != NULL ? rotation->max_files : 0;
+    file->is_rotating = rotation != NULL;
+    file->is_compressed = rotation != NULL ? rotation->is_compressed : false;
+    pthread_mutex_unlock(&files->mutex);
+
+    funcs.data = file;
+    funcs.open = linc_sink_file_open;
+    funcs.close = linc_sink_file_close;
+    funcs.write = linc_sink_file_write;
+    funcs.flush = linc_sink_file_flush;
+    funcs.write_batch = linc_sink_file_write_batch;
+    funcs.release = linc_sink_file_release;
+    funcs.flush_latency = options->flush_delay_us > 0 ? options->flush_delay_us : LINC_DEFAULT_FILE_FLUSH_DELAY_US;
+    return funcs;
+}
+
+#else
+
+static struct linc_sink_funcs linc_sink_file_create(const char *path,
+                                                    const struct linc_sink_file_options *options,
+                                                    const struct linc_sink_rotation_options *rotation,
+                                                    bool is_binary) {
+    (void)path;
+    (void)options;
+    (void)rotation;
+    (void)is_binary;
+    struct linc_sink_funcs funcs;
+    memset(&funcs, 0, sizeof(funcs));
+    return funcs;
+}
+
+#endif  // LINC_DEFAULT_MAX_FILE_SINKS > 0
+
+// ==================================================
+// Memory-Mapped Sinks
+// ==================================================
+//
+// A memory-mapped sink preallocates a segment at the end of its file, maps it and copies each line straight into the
+// mapping. Lines reach the page cache without any system call, and the kernel writes them back to disk. Once a
+// segment is full, the next one is preallocated and mapped, so lines may span two segments. The file is truncated to
+// the lines written when the sink closes. A process that crashes leaves the preallocated tail filled with zero bytes,
+// which is cut off when a sink opens the file again, since lines never contain zero bytes. Memory-mapped sinks are
+// compiled out with file sinks.
+
+#if LINC_DEFAULT_MAX_FILE_SINKS > 0
+
+#define LINC_SINK_MMAP_TRIM_BYTES 4096  // Bytes read at once while looking for the end of the lines of a file
+
+static struct linc_sink_mmap_list linc_sink_mmaps = {.mutex = PTHREAD_MUTEX_INITIALIZER};
+
+// Returns the offset right after the last byte of the file that is not zero, looking back at most one segment.
+static off_t linc_sink_mmap_end(int fd, off_t size, size_t segment) {
+    char block[LINC_SINK_MMAP_TRIM_BYTES];
+    off_t limit = size > (off_t)segment ? size - (off_t)segment : 0;
+    off_t end = size;
+    while (end > limit) {
+        size_t length = end - limit < (off_t)sizeof(block) ? (size_t)(end - limit) : sizeof(block);
+        if (pread(fd, block, length, end - (off_t)length) != (ssize_t)length) {
+            return size;
+        }
+        while (length > 0 && block[length - 1] == '\0') {
+            length--;
+            end--;
+        }
+        if (length > 0) {
+            break;
+        }
+    }
+    return end;
+}
+
+// Preallocates the segment of the sink and maps it. The file grows to the end of the segment.
+static int linc_sink_mmap_map(struct linc_sink_mmap *map) {
+    if (posix_fallocate(map->fd, map->base, (off_t)map->segment) != 0) {
+        return -1;
+    }
+    void *mapping = mmap(NULL, map->segment, PROT_READ | PROT_WRITE, MAP_SHARED, map->fd, map->base);
+    if (mapping == MAP_FAILED) {
+        return -1;
+    }
+    map->mapping = (char *)mapping;
+    return 0;
+}
+
+static void linc_sink_mmap_unmap(struct linc_sink_mmap *map) {
+    if (map->mapping != NULL) {
+        munmap(map->mapping, map->segment);
+        map->mapping = NULL;
+    }
+}
+
+// Tells whether another memory-mapped sink has the file open, its close would truncate the file under the mapping.
+static bool linc_sink_mmap_is_shared(const struct stat *st) {
+    for (size_t i = 0; i < LINC_DEFAULT_MAX_FILE_SINKS; i++) {
+        const struct linc_sink_mmap *other = &linc_sink_mmaps.list[i];
+        if (other->is_open && other->device == st->st_dev && other->inode == st->st_ino) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Opens the file and maps the segment after its last line, both released by close. A file already mapped by another
+// sink is refused.
+static int linc_sink_mmap_open(void *data) {
+    struct linc_sink_mmap *map = (struct linc_sink_mmap *)data;
+    if (map->is_open) {
+        return -1;
+    }
+    int fd = open(map->path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    struct stat st;
+    if (fd >= 0 && fstat(fd, &st) < 0) {
+        close(fd);
+        fd = -1;
+    }
+    if (fd < 0) {
+        return -1;
+    }
+    pthread_mutex_lock(&linc_sink_mmaps.mutex);
+    bool is_shared = linc_sink_mmap_is_shared(&st);
+    pthread_mutex_unlock(&linc_sink_mmaps.mutex);
+    if (is_shared) {
+        close(fd);
+        return -1;
+    }
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    off_t end = linc_sink_mmap_end(fd, st.st_size, map->segment);
+    map->fd = fd;
+    map->mapping = NULL;
+    map->base = end / (off_t)page * (off_t)page;
+    map->used = (size_t)(end - map->base);
+    if (linc_sink_mmap_map(map) < 0) {
+        close(fd);
+        map->fd = -1;
+        return -1;
+    }
+    pthread_mutex_lock(&linc_sink_mmaps.mutex);
+    map->device = st.st_dev;
+    map->inode = st.st_ino;
+    map->is_open = true;
+    pthread_mutex_unlock(&linc_sink_mmaps.mutex);
+    return 0;
+}
+
+// Lines are in the page cache once written, the kernel writes them back.
+static int linc_sink_mmap_flush(void *data) {
+    (void)data;
+    return 0;
+}
+
+static int linc_sink_mmap_close(void *data) {
+    struct linc_sink_mmap *map = (struct linc_sink_mmap *)data;
+    int result = 0;
+    linc_sink_mmap_unmap(map);
+    if (ftruncate(map->fd, map->base + (off_t)map->used) < 0) {
+        result = -1;
+    }
+    if (close(map->fd) < 0) {
+        result = -1;
+    }
+    map->fd = -1;
+    pthread_mutex_lock(&linc_sink_mmaps.mutex);
+    map->is_open = false;
+    map->is_used = false;
+    pthread_mutex_unlock(&linc_sink_mmaps.mutex);
+    return result;
+}
+
+// Gives back the slot claimed by the builder, unless the sink is open.
+static void linc_sink_mmap_release(void *data) {
+    struct linc_sink_mmap *map = (struct linc_sink_mmap *)data;
+    pthread_mutex_lock(&linc_sink_mmaps.mutex);
+    map->is_used = map->is_open;
+    pthread_mutex_unlock(&linc_sink_mmaps.mutex);
+}
+
+static int linc_sink_mmap_write(void *data, struct linc_metadata *metadata) {
+    struct linc_sink_mmap *map = (struct linc_sink_mmap *)data;
+    size_t length = 0;
+    const char *text = linc_sink_view(map->layout, metadata, &length);
+    while (length > 0) {
+        if (map->used == map->segment) {
+            linc_sink_mmap_unmap(map);
+            map->base += (off_t)map->segment;
+            map->used = 0;
+        }
+        // A segment that could not be mapped, e.g., on a full disk, is tried again with the next line.
+        if (map->mapping == NULL && linc_sink_mmap_map(map) < 0) {
+            return -1;
+        }
+        size_t chunk = length < map->segment - map->used ? length : map->segment - map->used;
+        memcpy(map->mapping + map->used, text, chunk);
+        map->used += chunk;
+        text += chunk;
+        length -= chunk;
+    }
+    return 0;
+}
+
+static int linc_sink_mmap_write_batch(void *data, struct linc_metadata *const *records, size_t count) {
+    int result = 0;
+    for (size_t i = 0; i < count; i++) {
+        result |= linc_sink_mmap_write(data, records[i]);
+    }
+    return result;
+}
+
+// Claims a slot for the sink, the file is only opened and mapped once the sink is registered.
+static struct linc_sink_funcs linc_sink_mmap_create(const char *path, const struct linc_sink_mmap_options *options) {
+    struct linc_sink_funcs funcs;
+    memset(&funcs, 0, sizeof(funcs));
+    struct linc_sink_mmap_options defaults = {.segment_size = 0, .layout = NULL};
+    if (options == NULL) {
+        options = &defaults;
+    }
+    if (path == NULL || strlen(path) > LINC_SINK_FILE_PATH_LENGTH) {
+        return funcs;
+    }
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t segment = options->segment_size > 0 ? options->segment_size : LINC_DEFAULT_MMAP_SEGMENT_BYTES;
+    segment = (segment + page - 1) / page * page;
+
+    struct linc_sink_mmap_list *maps = &linc_sink_mmaps;
+    pthread_mutex_lock(&maps->mutex);
+    size_t index = 0;
+    while (index < LINC_DEFAULT_MAX_FILE_SINKS && maps->list[index].is_used) {
+        index++;
+    }
+    if (index == LINC_DEFAULT_MAX_FILE_SINKS) {
+        pthread_mutex_unlock(&maps->mutex);
+        return funcs;
+    }
+    struct linc_sink_mmap *map = &maps->list[index];
+    map->is_used = true;
+    map->is_open = false;
+    map->fd = -1;
+    map->layout = options->layout != NULL ? options->layout : linc_layout_text;
+    map->mapping = NULL;
+    map->segment = segment;
+    strcpy(map->path, path);
+    pthread_mutex_unlock(&maps->mutex);
+
+    funcs.data = map;
+    funcs.open = linc_sink_mmap_open;
+    funcs.close = linc_sink_mmap_close;
+    funcs.write = linc_sink_mmap_write;
+    funcs.flush = linc_sink_mmap_flush;
+    funcs.write_batch = linc_sink_mmap_write_batch;
+    funcs.release = linc_sink_mmap_release;
+    return funcs;
+}
+
+#else
+
+static struct linc_sink_funcs linc_sink_mmap_create(const char *path, const struct linc_sink_mmap_options *options) {
+    (void)path;
+    (void)options;
+    struct linc_sink_funcs funcs;
+    memset(&funcs, 0, sizeof(funcs));
+    return funcs;
+}
+
+#endif  // LINC_DEFAULT_MAX_FILE_SINKS > 0
+
 // ==================================================
 // Internal Functions
 // ==================================================
@@ -82,7 +1017,10 @@ static int linc_check_level_sink(enum linc_level level) {
 }
 
 static int linc_check_funcs_sink(struct linc_sink_funcs funcs) {
-    if (funcs.open == NULL || funcs.close == NULL || funcs.write == NULL || funcs.flush == NULL) {
+    if (funcs.open == NULL || funcs.close == NULL || funcs.flush == NULL) {
+        return -1;
+    }
+    if (funcs.write == NULL && funcs.write_batch == NULL) {
         return -1;
     }
     return 0;
@@ -98,28 +1036,30 @@ static struct linc_sink *linc_add_sink(
     is_failed |= linc_check_funcs_sink(funcs) < 0;
 
     if (is_failed == true) {
+        linc_release_sink_funcs(funcs);
         return NULL;
     }
 
     struct linc_sink *sink = &sinks->list[sinks->count];
     strncpy(sink->name, name, LINC_DEFAULT_SINK_NAME_LENGTH);
     sink->name[LINC_DEFAULT_SINK_NAME_LENGTH] = '\0';
-    sink->level = level;
+    sink->state = linc_state_pack(level, enabled);
     sink->funcs = funcs;
-    sink->enabled = enabled;
-    sinks->count += 1;
+    sink->batch_size = LINC_DEFAULT_BATCH_SIZE;
+    sink->batch_latency = LINC_DEFAULT_BATCH_LATENCY_US;
 
-    pthread_rwlockattr_t attr;
-    pthread_rwlockattr_init(&attr);
-    pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
-    pthread_rwlock_init(&sink->lock, &attr);
-    pthread_rwlockattr_destroy(&attr);
+    if (sink->funcs.open(sink->funcs.data) < 0) {
+        linc_release_sink_funcs(funcs);
+        return NULL;
+    }
 
-    sink->funcs.open(sink->funcs.data);
+    // The sink reads records published from now on, the worker only waits for it once it is counted.
+    sink->cursor = LINC_ATOMIC_LOAD(&linc.dispatch.published, LINC_ACQUIRE);
+    LINC_ATOMIC_STORE(&sinks->count, sinks->count + 1, LINC_RELEASE);
 
     pthread_attr_t task_attr;
     pthread_attr_init(&task_attr);
-    pthread_attr_setdetachstate(&task_attr, PTHREAD_CREATE_DETACHED);
+    pthread_attr_setdetachstate(&task_attr, PTHREAD_CREATE_JOINABLE);
     pthread_create(&sink->thread_id, &task_attr, linc_task, sink);
     pthread_attr_destroy(&task_attr);
 
@@ -128,18 +1068,15 @@ static struct linc_sink *linc_add_sink(
 
 struct linc_sink *linc_register_default_sink(struct linc_sink_list *sinks) {
     sinks->count = 0;
-    struct linc_sink_funcs funcs = {
-        .data = stderr,
-        .open = linc_sink_stderr_open,
-        .close = linc_sink_stderr_close,
-        .write = linc_sink_stderr_write,
-        .flush = linc_sink_stderr_flush,
-    };
     pthread_rwlockattr_t attr;
     pthread_rwlockattr_init(&attr);
     pthread_rwlock_init(&sinks->lock, &attr);
     pthread_rwlockattr_destroy(&attr);
+    struct linc_sink_funcs funcs = linc_sink_stream_funcs(&linc_sink_stderr, STDERR_FILENO);
     struct linc_sink *sink = linc_add_sink(sinks, LINC_DEFAULT_SINK_NAME, LINC_LEVEL_TRACE, true, funcs);
+    if (sink != NULL && linc_sink_stderr.layout == linc_layout_text) {
+        LINC_ATOMIC_STORE(&sink->batch_latency, LINC_DEFAULT_STREAM_LATENCY_US, LINC_RELEASE);
+    }
     return sink;
 }
 
@@ -147,6 +1084,39 @@ struct linc_sink *linc_register_default_sink(struct linc_sink_list *sinks) {
 // Public Functions
 // ==================================================
 
+struct linc_sink_funcs linc_sink_stdout_funcs(void) {
+    linc_init();
+    return linc_sink_stream_funcs(&linc_sink_stdout, STDOUT_FILENO);
+}
+
+struct linc_sink_funcs linc_sink_file_funcs(const char *path, const struct linc_sink_file_options *options) {
+    linc_init();
+    return linc_sink_file_create(path, options, NULL, false);
+}
+
+struct linc_sink_funcs linc_sink_rotating_funcs(const char *path,
+                                                const struct linc_sink_file_options *options,
+                                                const struct linc_sink_rotation_options *rotation) {
+    linc_init();
+    struct linc_sink_funcs funcs;
+    memset(&funcs, 0, sizeof(funcs));
+    if (rotation == NULL) {
+        return funcs;
+    }
+    return linc_sink_file_create(path, options, rotation, false);
+}
+
+// Binary sinks are file sinks that write encoded records instead of lines, the layout of the options is not used.
+struct linc_sink_funcs linc_sink_binary_funcs(const char *path, const struct linc_sink_file_options *options) {
+    linc_init();
+    return linc_sink_file_create(path, options, NULL, true);
+}
+
+struct linc_sink_funcs linc_sink_mmap_funcs(const char *path, const struct linc_sink_mmap_options *options) {
+    linc_init();
+    return linc_sink_mmap_create(path, options);
+}
+
 struct linc_sink *linc_register_sink(const char *name,
                                      enum linc_level level,
                                      bool enabled,
@@ -162,14 +1132,19 @@ struct linc_sink *linc_register_sink(const char *name,
     return sink;
 }
 
+// Functions of a sink that was registered are left alone, their slot is given back when the sink closes.
+void linc_release_sink_funcs(struct linc_sink_funcs funcs) {
+    if (funcs.release != NULL) {
+        funcs.release(funcs.data);
+    }
+}
+
 int linc_set_sink_level(linc_sink sink, enum linc_level level) {
     linc_init();
     if (sink == NULL || linc_check_level_sink(level) < 0) {
         return -1;
     }
-    pthread_rwlock_wrlock(&sink->lock);
-    sink->level = level;
-    pthread_rwlock_unlock(&sink->lock);
+    linc_state_set_level(&sink->state, level);
     return 0;
 }
 
@@ -178,8 +1153,16 @@ int linc_set_sink_enabled(linc_sink sink, bool enabled) {
     if (sink == NULL) {
         return -1;
     }
-    pthread_rwlock_wrlock(&sink->lock);
-    sink->enabled = enabled;
-    pthread_rwlock_unlock(&sink->lock);
+    linc_state_set_enabled(&sink->state, enabled);
+    return 0;
+}
+
+int linc_set_sink_batch(linc_sink sink, size_t size, uint32_t latency_us) {
+    linc_init();
+    if (sink == NULL || size < 1 || size > LINC_DEFAULT_BATCH_SIZE) {
+        return -1;
+    }
+    LINC_ATOMIC_STORE(&sink->batch_latency, latency_us, LINC_RELEASE);
+    LINC_ATOMIC_STORE(&sink->batch_size, size, LINC_RELEASE);
     return 0;
 }
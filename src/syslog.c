@@ -0,0 +1,364 @@
+#if defined(__linux__)
+#define _GNU_SOURCE  // sendmmsg
+#endif
+
+#include "internal/shared.h"
+#include "linc.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#define LINC_SINK_SYSLOG_HAS_SENDMMSG 1
+#else
+#define LINC_SINK_SYSLOG_HAS_SENDMMSG 0
+#endif
+
+// ==================================================
+// Syslog Sinks
+// ==================================================
+//
+// A syslog sink frames each log as an RFC 5424 message, one datagram each, to a UDP receiver or to a Unix datagram
+// socket such as /dev/log:
+//
+//   <PRI>1 TIMESTAMP HOSTNAME APP-NAME PROCID MSGID - MSG
+//
+// PRI holds the facility of the sink and the severity of the level, MSGID the module name, and MSG the message or the
+// log rendered with the layout of the sink. Datagrams of many batches are framed one after the other in a buffer and
+// sent by a single sendmmsg once the buffer is full or once the flush delay passed, so hundreds of logs take a system
+// call. Datagrams longer than the maximum size of the sink are cut, as receivers would do. A datagram that cannot be
+// sent is tried once more, after connecting again for Unix sockets, since the syslog daemon may have restarted, and is
+// then dropped. A Unix socket whose receiver stays behind blocks the sink thread up to LINC_SINK_SYSLOG_TIMEOUT_MS, the
+// rest of the buffer is then dropped.
+//
+// Each slot holds a buffer of LINC_DEFAULT_SYSLOG_BUFFER_BYTES, so a sink only takes datagrams up to that size. Syslog
+// sinks are compiled out with HTTP sinks.
+
+#if LINC_DEFAULT_MAX_NETWORK_SINKS > 0
+
+static struct linc_sink_syslog_list linc_sink_syslogs = {.mutex = PTHREAD_MUTEX_INITIALIZER};
+
+// Severities of the levels, from debug (7) to critical (2).
+static const unsigned int linc_sink_syslog_severities[LINC_LEVEL_FATAL + 1] = {7, 7, 6, 4, 3, 2};
+
+// Copies a header field, keeping the printable characters without spaces that RFC 5424 allows. Returns the length.
+static size_t linc_sink_syslog_field(char *field, const char *text, size_t max_length) {
+    size_t length = 0;
+    for (; text != NULL && *text != '\0' && length < max_length; text++) {
+        if (*text > ' ' && *text < 127) {
+            field[length++] = *text;
+        }
+    }
+    if (length == 0) {
+        field[length++] = '-';
+    }
+    field[length] = '\0';
+    return length;
+}
+
+static int linc_sink_syslog_connect(struct linc_sink_syslog *syslog) {
+    int fd = socket(syslog->address.ss_family, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    struct timeval timeout = {
+        .tv_sec = LINC_SINK_SYSLOG_TIMEOUT_MS / 1000, .tv_usec = (LINC_SINK_SYSLOG_TIMEOUT_MS % 1000) * 1000};
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    if (connect(fd, (const struct sockaddr *)&syslog->address, syslog->address_length) < 0) {
+        close(fd);
+        return -1;
+    }
+    if (syslog->fd >= 0) {
+        close(syslog->fd);
+    }
+    syslog->fd = fd;
+    return 0;
+}
+
+// Sends the datagram of index `sent` and the following ones, returns the number sent or -1.
+static int linc_sink_syslog_send_some(struct linc_sink_syslog *syslog, size_t sent) {
+#if LINC_SINK_SYSLOG_HAS_SENDMMSG
+    struct mmsghdr messages[LINC_SINK_SYSLOG_DATAGRAMS];
+    memset(messages, 0, sizeof(messages[0]) * (syslog->count - sent));
+    for (size_t i = sent; i < syslog->count; i++) {
+        messages[i - sent].msg_hdr.msg_iov = &syslog->datagrams[i];
+        messages[i - sent].msg_hdr.msg_iovlen = 1;
+    }
+    return sendmmsg(syslog->fd, messages, (unsigned int)(syslog->count - sent), 0);
+#else
+    const struct iovec *datagram = &syslog->datagrams[sent];
+    return send(syslog->fd, datagram->iov_base, datagram->iov_len, 0) < 0 ? -1 : 1;
+#endif
+}
+
+// Sends every framed datagram and empties the buffer.
+static int linc_sink_syslog_send(struct linc_sink_syslog *syslog) {
+    int result = 0;
+    size_t sent = 0;
+    bool is_retried = false;
+    while (sent < syslog->count) {
+        int count = linc_sink_syslog_send_some(syslog, sent);
+        if (count > 0) {
+            sent += (size_t)count;
+            is_retried = false;
+        } else if (count < 0 && errno == EINTR) {
+            continue;
+        } else if (!is_retried) {
+            is_retried = true;
+            if (syslog->address.ss_family == AF_UNIX) {
+                linc_sink_syslog_connect(syslog);
+            }
+        } else {
+            // A receiver that did not take a datagram within the timeout will not take the next ones either.
+            sent = errno == EAGAIN || errno == EWOULDBLOCK ? syslog->count : sent + 1;
+            is_retried = false;
+            result = -1;
+        }
+    }
+    syslog->count = 0;
+    syslog->used = 0;
+    return result;
+}
+
+// Frames the log into the buffer, after sending the buffer if it might not fit.
+static int linc_sink_syslog_append(struct linc_sink_syslog *syslog, struct linc_metadata *metadata) {
+    int result = 0;
+    if (syslog->count == LINC_SINK_SYSLOG_DATAGRAMS || syslog->used + syslog->max_datagram > sizeof(syslog->buffer)) {
+        result = linc_sink_syslog_send(syslog);
+    }
+
+    // "YYYY-MM-DD HH:MM:SS.uuuuuu" becomes "YYYY-MM-DDTHH:MM:SS.uuuuuuZ".
+    char timestamp[LINC_LOG_TIMESTAMP_PREFIX_LENGTH + 2 + LINC_TIMESTAMP_MICROSECONDS + LINC_ZERO_CHAR_LENGTH];
+    if (linc_format_timestamp(metadata->timestamp,
+                              timestamp,
+                              sizeof(timestamp) - 1,
+                              LINC_TIMESTAMP_MICROSECONDS,
+                              LINC_TIMEZONE_UTC) == 0) {
+        size_t length = strlen(timestamp);
+        timestamp[10] = 'T';
+        timestamp[length] = 'Z';
+        timestamp[length + 1] = '\0';
+    } else {
+        strcpy(timestamp, "-");
+    }
+    char msgid[LINC_SINK_SYSLOG_MSGID_LENGTH + LINC_ZERO_CHAR_LENGTH];
+    linc_sink_syslog_field(msgid, metadata->module_name, LINC_SINK_SYSLOG_MSGID_LENGTH);
+    size_t level = metadata->level <= LINC_LEVEL_FATAL ? (size_t)metadata->level : LINC_LEVEL_FATAL;
+    unsigned int priority = syslog->facility * 8 + linc_sink_syslog_severities[level];
+
+    char *datagram = syslog->buffer + syslog->used;
+    int written = snprintf(datagram,
+                           syslog->max_datagram,
+                           "<%u>1 %s %s %s %ld %s - ",
+                           priority,
+                           timestamp,
+                           syslog->hostname,
+                           syslog->app_name,
+                           syslog->pid,
+                           msgid);
+    if (written < 0) {
+        return -1;
+    }
+    size_t length = (size_t)written < syslog->max_datagram ? (size_t)written : syslog->max_datagram - 1;
+
+    const char *text = metadata->message;
+    size_t text_length = strlen(text);
+    if (syslog->layout != NULL) {
+        const char *view = linc_layout_view(syslog->layout, metadata, &text_length);
+        if (view != NULL) {
+            text = view;
+            text_length -= text_length > 0 && view[text_length - 1] == '\n' ? LINC_NEWLINE_CHAR_LENGTH : 0;
+        } else {
+            text_length = strlen(text);
+            result = -1;
+        }
+    }
+    if (text_length > syslog->max_datagram - length) {
+        text_length = syslog->max_datagram - length;
+    }
+    memcpy(datagram + length, text, text_length);
+    length += text_length;
+
+    syslog->datagrams[syslog->count].iov_base = datagram;
+    syslog->datagrams[syslog->count].iov_len = length;
+    syslog->count++;
+    syslog->used += length;
+    return result;
+}
+
+// Connects the socket, closed by close.
+static int linc_sink_syslog_open(void *data) {
+    struct linc_sink_syslog *syslog = (struct linc_sink_syslog *)data;
+    if (syslog->is_open) {
+        return -1;
+    }
+    syslog->fd = -1;
+    if (linc_sink_syslog_connect(syslog) < 0) {
+        return -1;
+    }
+    syslog->count = 0;
+    syslog->used = 0;
+    syslog->is_open = true;
+    return 0;
+}
+
+static int linc_sink_syslog_flush(void *data) {
+    struct linc_sink_syslog *syslog = (struct linc_sink_syslog *)data;
+    return linc_sink_syslog_send(syslog);
+}
+
+static int linc_sink_syslog_close(void *data) {
+    struct linc_sink_syslog *syslog = (struct linc_sink_syslog *)data;
+    int result = linc_sink_syslog_send(syslog);
+    if (syslog->fd >= 0 && close(syslog->fd) < 0) {
+        result = -1;
+    }
+    syslog->fd = -1;
+    pthread_mutex_lock(&linc_sink_syslogs.mutex);
+    syslog->is_open = false;
+    syslog->is_used = false;
+    pthread_mutex_unlock(&linc_sink_syslogs.mutex);
+    return result;
+}
+
+// Gives back the slot claimed by the builder, unless the sink is open.
+static void linc_sink_syslog_release(void *data) {
+    struct linc_sink_syslog *syslog = (struct linc_sink_syslog *)data;
+    pthread_mutex_lock(&linc_sink_syslogs.mutex);
+    syslog->is_used = syslog->is_open;
+    pthread_mutex_unlock(&linc_sink_syslogs.mutex);
+}
+
+static int linc_sink_syslog_write_batch(void *data, struct linc_metadata *const *records, size_t count) {
+    struct linc_sink_syslog *syslog = (struct linc_sink_syslog *)data;
+    int result = 0;
+    for (size_t i = 0; i < count; i++) {
+        result |= linc_sink_syslog_append(syslog, records[i]);
+    }
+    return result;
+}
+
+static int linc_sink_syslog_write(void *data, struct linc_metadata *metadata) {
+    return linc_sink_syslog_write_batch(data, &metadata, 1);
+}
+
+// Finds the address of the receiver: the path of a Unix datagram socket without a port, a UDP host and port otherwise.
+static int linc_sink_syslog_resolve(struct linc_sink_syslog *syslog, const char *address, const char *port) {
+    memset(&syslog->address, 0, sizeof(syslog->address));
+    if (port == NULL) {
+        struct sockaddr_un *unix_address = (struct sockaddr_un *)&syslog->address;
+        if (strlen(address) >= sizeof(unix_address->sun_path)) {
+            return -1;
+        }
+        unix_address->sun_family = AF_UNIX;
+        strcpy(unix_address->sun_path, address);
+        syslog->address_length = sizeof(*unix_address);
+        return 0;
+    }
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    struct addrinfo *addresses = NULL;
+    if (getaddrinfo(address, port, &hints, &addresses) != 0) {
+        return -1;
+    }
+    memcpy(&syslog->address, addresses->ai_addr, addresses->ai_addrlen);
+    syslog->address_length = addresses->ai_addrlen;
+    freeaddrinfo(addresses);
+    return 0;
+}
+
+// Resolves the receiver right away, so a receiver that cannot be resolved gives empty functions. The socket is only
+// connected once the sink is registered, and linc_register_sink fails if a Unix socket does not exist.
+static struct linc_sink_funcs linc_sink_syslog_create(const char *address,
+                                                      const char *port,
+                                                      const struct linc_sink_syslog_options *options) {
+    struct linc_sink_funcs funcs;
+    memset(&funcs, 0, sizeof(funcs));
+    struct linc_sink_syslog_options defaults = {
+        .app_name = NULL, .facility = 0, .max_datagram = 0, .flush_delay_us = 0, .layout = NULL};
+    if (options == NULL) {
+        options = &defaults;
+    }
+    size_t max_datagram = options->max_datagram > 0 ? options->max_datagram : LINC_DEFAULT_SYSLOG_DATAGRAM_BYTES;
+    if (address == NULL || options->facility > 23 || max_datagram < LINC_SINK_SYSLOG_MIN_DATAGRAM
+        || max_datagram > LINC_SINK_SYSLOG_MAX_DATAGRAM || max_datagram > LINC_DEFAULT_SYSLOG_BUFFER_BYTES) {
+        return funcs;
+    }
+
+    struct linc_sink_syslog_list *syslogs = &linc_sink_syslogs;
+    pthread_mutex_lock(&syslogs->mutex);
+    size_t index = 0;
+    while (index < LINC_DEFAULT_MAX_NETWORK_SINKS && syslogs->list[index].is_used) {
+        index++;
+    }
+    if (index == LINC_DEFAULT_MAX_NETWORK_SINKS) {
+        pthread_mutex_unlock(&syslogs->mutex);
+        return funcs;
+    }
+    struct linc_sink_syslog *syslog = &syslogs->list[index];
+    if (linc_sink_syslog_resolve(syslog, address, port) < 0) {
+        pthread_mutex_unlock(&syslogs->mutex);
+        return funcs;
+    }
+    syslog->is_used = true;
+    syslog->is_open = false;
+    syslog->fd = -1;
+    char hostname[LINC_SINK_SYSLOG_HOSTNAME_LENGTH + LINC_ZERO_CHAR_LENGTH] = "";
+    gethostname(hostname, sizeof(hostname) - 1);
+    linc_sink_syslog_field(syslog->hostname, hostname, LINC_SINK_SYSLOG_HOSTNAME_LENGTH);
+    linc_sink_syslog_field(syslog->app_name, options->app_name, LINC_SINK_SYSLOG_APP_NAME_LENGTH);
+    syslog->pid = (long)getpid();
+    syslog->facility = options->facility > 0 ? options->facility : LINC_DEFAULT_SYSLOG_FACILITY;
+    syslog->max_datagram = max_datagram;
+    syslog->layout = options->layout;
+    syslog->count = 0;
+    syslog->used = 0;
+    pthread_mutex_unlock(&syslogs->mutex);
+
+    funcs.data = syslog;
+    funcs.open = linc_sink_syslog_open;
+    funcs.close = linc_sink_syslog_close;
+    funcs.write = linc_sink_syslog_write;
+    funcs.flush = linc_sink_syslog_flush;
+    funcs.write_batch = linc_sink_syslog_write_batch;
+    funcs.release = linc_sink_syslog_release;
+    funcs.flush_latency = options->flush_delay_us > 0 ? options->flush_delay_us : LINC_DEFAULT_SYSLOG_FLUSH_DELAY_US;
+    return funcs;
+}
+
+#else
+
+static struct linc_sink_funcs linc_sink_syslog_create(const char *address,
+                                                      const char *port,
+                                                      const struct linc_sink_syslog_options *options) {
+    (void)address;
+    (void)port;
+    (void)options;
+    struct linc_sink_funcs funcs;
+    memset(&funcs, 0, sizeof(funcs));
+    return funcs;
+}
+
+#endif  // LINC_DEFAULT_MAX_NETWORK_SINKS > 0
+
+// ==================================================
+// Public Functions
+// ==================================================
+
+struct linc_sink_funcs linc_sink_syslog_funcs(const char *address,
+                                              const char *port,
+                                              const struct linc_sink_syslog_options *options) {
+    linc_init();
+    return linc_sink_syslog_create(address, port, options);
+}
@@ -0,0 +1,182 @@
+#if defined(__linux__)
+#define _DEFAULT_SOURCE  // syscall
+#endif
+
+#include "internal/shared.h"
+#include "linc.h"
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#endif
+
+// ==================================================
+// Thread Registry
+// ==================================================
+//
+// Each thread claims an entry of the registry the first time it logs and keeps it in a thread-local variable, so
+// records carry the small index of the entry instead of the thread ID, and producers never call pthread_self. The
+// entry holds the thread ID and the kernel thread ID already rendered, and the thread name, so layouts copy them
+// instead of converting numbers on every line. Entries never change once claimed: renaming a thread claims a new
+// entry. The entry is retired when its thread exits or renames itself, and freed by the worker once every buffer is
+// drained and every sink has written the records that refer to it.
+//
+// A thread that finds the registry full logs without an entry, its records then carry the thread ID itself. It tries
+// to claim an entry again once the worker freed some, which it tells by the epoch of the registry.
+
+static LINC_THREAD_LOCAL uint32_t linc_thread_index = 0;
+static LINC_THREAD_LOCAL bool linc_thread_is_exiting = false;
+static LINC_THREAD_LOCAL size_t linc_thread_full_epoch = 0;  // Epoch plus one of the registry when it was full
+
+static void linc_thread_retire(void *arg) {
+    struct linc_thread *thread = (struct linc_thread *)arg;
+    linc_thread_index = 0;
+    linc_thread_is_exiting = true;
+    LINC_ATOMIC_STORE(&thread->state, LINC_THREAD_RETIRED, LINC_RELEASE);
+}
+
+// Thread name given by the kernel, e.g., set with pthread_setname_np, inherited from the process name otherwise.
+static void linc_thread_kernel_name(char *name, size_t size) {
+    name[0] = '\0';
+#if defined(__linux__) && defined(PR_GET_NAME)
+    char kernel_name[16 + LINC_ZERO_CHAR_LENGTH] = {0};
+    if (prctl(PR_GET_NAME, kernel_name, 0, 0, 0) == 0) {
+        strncpy(name, kernel_name, size - LINC_ZERO_CHAR_LENGTH);
+        name[size - LINC_ZERO_CHAR_LENGTH] = '\0';
+    }
+#else
+    (void)size;
+#endif
+}
+
+static long linc_thread_tid(void) {
+#if defined(__linux__) && defined(SYS_gettid)
+    return (long)syscall(SYS_gettid);
+#else
+    return 0;
+#endif
+}
+
+static uint32_t linc_thread_claim(const char *name) {
+    for (size_t i = 0; i < LINC_DEFAULT_MAX_THREADS; i++) {
+        struct linc_thread *thread = &linc.threads.list[i];
+        int state = LINC_THREAD_FREE;
+        if (!LINC_ATOMIC_CAS(&thread->state, &state, LINC_THREAD_ACTIVE, LINC_ACQUIRE)) {
+            continue;
+        }
+
+        char text[LINC_THREAD_TID_TEXT_LENGTH + LINC_ZERO_CHAR_LENGTH];
+        thread->id = (uintptr_t)pthread_self();
+        snprintf(text, sizeof(text), "%0*" PRIxPTR, (int)LINC_THREAD_ID_TEXT_LENGTH, thread->id);
+        memcpy(thread->id_text, text, LINC_THREAD_ID_TEXT_LENGTH);
+        thread->tid = linc_thread_tid();
+        thread->tid_length = (size_t)snprintf(text, sizeof(text), "%ld", thread->tid);
+        memcpy(thread->tid_text, text, thread->tid_length);
+        if (name != NULL) {
+            strcpy(thread->name, name);
+        } else {
+            linc_thread_kernel_name(thread->name, sizeof(thread->name));
+        }
+        thread->name_length = strlen(thread->name);
+
+        pthread_setspecific(linc.threads.key, thread);
+        return (uint32_t)i + 1;
+    }
+    return 0;
+}
+
+void linc_threads_init(void) {
+    pthread_key_create(&linc.threads.key, linc_thread_retire);
+    for (size_t i = 0; i < LINC_DEFAULT_MAX_THREADS; i++) {
+        linc.threads.list[i].state = LINC_THREAD_FREE;
+    }
+}
+
+// Returns the index of the entry of the calling thread, claiming one on its first log, or 0 if the registry is full.
+uint32_t linc_thread_current(void) {
+    if (linc_thread_index != 0 || linc_thread_is_exiting == true) {
+        return linc_thread_index;
+    }
+    size_t epoch = LINC_ATOMIC_LOAD(&linc.threads.epoch, LINC_ACQUIRE) + 1;
+    if (linc_thread_full_epoch == epoch) {
+        return 0;
+    }
+    linc_thread_index = linc_thread_claim(NULL);
+    linc_thread_full_epoch = linc_thread_index == 0 ? epoch : 0;
+    return linc_thread_index;
+}
+
+const struct linc_thread *linc_thread_of(uint32_t thread) {
+    if (thread == 0 || thread > LINC_DEFAULT_MAX_THREADS) {
+        return NULL;
+    }
+    return &linc.threads.list[thread - 1];
+}
+
+// Called by the worker when idle. Records only refer to retired entries while they are buffered or dispatched, and
+// a thread publishes its last record before it retires its entry, so the entries seen retired before the buffers are
+// seen empty are only referred to by the records dispatched so far. They are freed once every sink wrote those, which
+// the worker checks each time it is idle instead of waiting for the sinks.
+void linc_thread_collect(bool (*is_empty)(void)) {
+    if (linc.threads.is_collecting == false) {
+        bool retired[LINC_DEFAULT_MAX_THREADS];
+        bool is_retired = false;
+        for (size_t i = 0; i < LINC_DEFAULT_MAX_THREADS; i++) {
+            retired[i] = LINC_ATOMIC_LOAD(&linc.threads.list[i].state, LINC_ACQUIRE) == LINC_THREAD_RETIRED;
+            is_retired |= retired[i];
+        }
+        if (is_retired == false || !is_empty()) {
+            return;
+        }
+        for (size_t i = 0; i < LINC_DEFAULT_MAX_THREADS; i++) {
+            if (retired[i] == true) {
+                LINC_ATOMIC_STORE(&linc.threads.list[i].state, LINC_THREAD_COLLECTING, LINC_RELAXED);
+            }
+        }
+        linc.threads.collect_position = LINC_ATOMIC_LOAD(&linc.dispatch.published, LINC_ACQUIRE);
+        linc.threads.is_collecting = true;
+    }
+    if (!linc_dispatch_is_past(linc.threads.collect_position)) {
+        return;
+    }
+    for (size_t i = 0; i < LINC_DEFAULT_MAX_THREADS; i++) {
+        if (LINC_ATOMIC_LOAD(&linc.threads.list[i].state, LINC_RELAXED) == LINC_THREAD_COLLECTING) {
+            LINC_ATOMIC_STORE(&linc.threads.list[i].state, LINC_THREAD_FREE, LINC_RELEASE);
+        }
+    }
+    linc.threads.is_collecting = false;
+    LINC_ATOMIC_FETCH_ADD(&linc.threads.epoch, 1, LINC_RELEASE);
+}
+
+// ==================================================
+// Public Functions
+// ==================================================
+
+int linc_set_thread_name(const char *name) {
+    linc_init();
+    if (name == NULL) {
+        return -1;
+    }
+    size_t name_length = strnlen(name, LINC_DEFAULT_THREAD_NAME_LENGTH + LINC_ZERO_CHAR_LENGTH);
+    if (name_length == 0 || name_length > LINC_DEFAULT_THREAD_NAME_LENGTH) {
+        return -1;
+    }
+
+    uint32_t previous = linc_thread_index;
+    uint32_t index = linc_thread_claim(name);
+    if (index == 0) {
+        return -1;
+    }
+    if (previous != 0) {
+        LINC_ATOMIC_STORE(&linc.threads.list[previous - 1].state, LINC_THREAD_RETIRED, LINC_RELEASE);
+    }
+    linc_thread_index = index;
+    linc_thread_full_epoch = 0;
+    return 0;
+}
@@ -0,0 +1,190 @@
+#if defined(__linux__)
+#define _DEFAULT_SOURCE  // syscall
+#endif
+
+#include "internal/uring.h"
+#include "internal/atomics.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#define LINC_URING_HAS_IO_URING 1
+#endif
+#endif
+
+#if !defined(LINC_URING_HAS_IO_URING)
+#define LINC_URING_HAS_IO_URING 0
+#endif
+
+// ==================================================
+// io_uring
+// ==================================================
+//
+// Minimal io_uring client, through the raw system calls so the library does not depend on liburing. A single thread
+// owns each ring: it submits writes one at a time and reaps their completions, without blocking unless asked to.
+// Every function fails where io_uring is not available, e.g., on other systems, on old kernels or in sandboxes that
+// block it, and callers then write synchronously.
+
+#if LINC_URING_HAS_IO_URING
+
+int linc_uring_init(struct linc_uring *ring, unsigned int entries) {
+    memset(ring, 0, sizeof(*ring));
+    ring->fd = -1;
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (fd < 0) {
+        return -1;
+    }
+
+    ring->fd = fd;
+    ring->entries = params.sq_entries;
+    ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+        ring->sq_ring_size = ring->sq_ring_size > ring->cq_ring_size ? ring->sq_ring_size : ring->cq_ring_size;
+        ring->cq_ring_size = 0;
+    }
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    int prot = PROT_READ | PROT_WRITE;
+    void *sq_ring = mmap(NULL, ring->sq_ring_size, prot, MAP_SHARED, fd, IORING_OFF_SQ_RING);
+    ring->sq_ring = sq_ring != MAP_FAILED ? sq_ring : NULL;
+    void *cq_ring = sq_ring;
+    if (ring->cq_ring_size > 0) {
+        cq_ring = mmap(NULL, ring->cq_ring_size, prot, MAP_SHARED, fd, IORING_OFF_CQ_RING);
+        ring->cq_ring = cq_ring != MAP_FAILED ? cq_ring : NULL;
+    }
+    void *sqes = mmap(NULL, ring->sqes_size, prot, MAP_SHARED, fd, IORING_OFF_SQES);
+    ring->sqes = sqes != MAP_FAILED ? sqes : NULL;
+    if (sq_ring == MAP_FAILED || cq_ring == MAP_FAILED || sqes == MAP_FAILED) {
+        linc_uring_exit(ring);
+        return -1;
+    }
+
+    char *sq = (char *)sq_ring;
+    char *cq = (char *)cq_ring;
+    ring->sq_head = (unsigned int *)(void *)(sq + params.sq_off.head);
+    ring->sq_tail = (unsigned int *)(void *)(sq + params.sq_off.tail);
+    ring->sq_mask = (unsigned int *)(void *)(sq + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned int *)(void *)(sq + params.sq_off.array);
+    ring->cq_head = (unsigned int *)(void *)(cq + params.cq_off.head);
+    ring->cq_tail = (unsigned int *)(void *)(cq + params.cq_off.tail);
+    ring->cq_mask = (unsigned int *)(void *)(cq + params.cq_off.ring_mask);
+    ring->cqes = cq + params.cq_off.cqes;
+    return 0;
+}
+
+void linc_uring_exit(struct linc_uring *ring) {
+    if (ring->sqes != NULL) {
+        munmap(ring->sqes, ring->sqes_size);
+    }
+    if (ring->cq_ring != NULL) {
+        munmap(ring->cq_ring, ring->cq_ring_size);
+    }
+    if (ring->sq_ring != NULL) {
+        munmap(ring->sq_ring, ring->sq_ring_size);
+    }
+    if (ring->fd >= 0) {
+        close(ring->fd);
+    }
+    memset(ring, 0, sizeof(*ring));
+    ring->fd = -1;
+}
+
+// Submits a write at the offset, tagged so its completion can be told apart. The buffer must stay untouched until the
+// completion is reaped.
+int linc_uring_write(struct linc_uring *ring, int fd, const void *buffer, size_t length, off_t offset, uint64_t tag) {
+    if (ring->fd < 0) {
+        return -1;
+    }
+    unsigned int tail = *ring->sq_tail;
+    if (tail - LINC_ATOMIC_LOAD(ring->sq_head, LINC_ACQUIRE) >= ring->entries) {
+        return -1;
+    }
+    unsigned int index = tail & *ring->sq_mask;
+    struct io_uring_sqe *sqe = &((struct io_uring_sqe *)ring->sqes)[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_WRITE;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t)(uintptr_t)buffer;
+    sqe->len = (uint32_t)length;
+    sqe->off = (uint64_t)offset;
+    sqe->user_data = tag;
+    ring->sq_array[index] = index;
+    LINC_ATOMIC_STORE(ring->sq_tail, tail + 1, LINC_RELEASE);
+
+    while (true) {
+        if (syscall(__NR_io_uring_enter, ring->fd, 1, 0, 0, NULL, 0) == 1) {
+            return 0;
+        }
+        if (errno != EINTR) {
+            // The kernel only reads the queue during the call, so the entry can be taken back.
+            LINC_ATOMIC_STORE(ring->sq_tail, tail, LINC_RELEASE);
+            return -1;
+        }
+    }
+}
+
+// Takes the next completion and returns 1 with its tag and the result of the write, or 0 if there is none. Waits for
+// a completion if asked to.
+int linc_uring_reap(struct linc_uring *ring, bool is_waiting, uint64_t *tag, int *result) {
+    if (ring->fd < 0) {
+        return -1;
+    }
+    while (true) {
+        unsigned int head = *ring->cq_head;
+        if (head != LINC_ATOMIC_LOAD(ring->cq_tail, LINC_ACQUIRE)) {
+            struct io_uring_cqe *cqe = &((struct io_uring_cqe *)ring->cqes)[head & *ring->cq_mask];
+            *tag = cqe->user_data;
+            *result = cqe->res;
+            LINC_ATOMIC_STORE(ring->cq_head, head + 1, LINC_RELEASE);
+            return 1;
+        }
+        if (!is_waiting) {
+            return 0;
+        }
+        if (syscall(__NR_io_uring_enter, ring->fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0 && errno != EINTR) {
+            return -1;
+        }
+    }
+}
+
+#else
+
+int linc_uring_init(struct linc_uring *ring, unsigned int entries) {
+    (void)entries;
+    memset(ring, 0, sizeof(*ring));
+    ring->fd = -1;
+    return -1;
+}
+
+void linc_uring_exit(struct linc_uring *ring) {
+    ring->fd = -1;
+}
+
+int linc_uring_write(struct linc_uring *ring, int fd, const void *buffer, size_t length, off_t offset, uint64_t tag) {
+    (void)ring;
+    (void)fd;
+    (void)buffer;
+    (void)length;
+    (void)offset;
+    (void)tag;
+    return -1;
+}
+
+int linc_uring_reap(struct linc_uring *ring, bool is_waiting, uint64_t *tag, int *result) {
+    (void)ring;
+    (void)is_waiting;
+    (void)tag;
+    (void)result;
+    return -1;
+}
+
+#endif
@@ -1,7 +1,10 @@
 #include "internal/shared.h"
 
 #include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
 #include <string.h>
+#include <time.h>
 
 // ==================================================
 // Internal Functions
@@ -12,58 +15,275 @@ static int linc_check_sink(struct linc_sink *sink, enum linc_level level) {
         return -1;
     }
 
-    pthread_rwlock_rdlock(&sink->lock);
-    bool is_sink_enabled = sink->enabled == true;
-    bool is_level_valid = level >= sink->level;
-    pthread_rwlock_unlock(&sink->lock);
-
-    if (!is_sink_enabled || !is_level_valid) {
+    if (!linc_state_accepts(&sink->state, level)) {
         return -1;
     }
     return 0;
 }
 
+static size_t linc_task_write(struct linc_sink *sink, size_t cursor, size_t published) {
+    for (; cursor != published; cursor++) {
+        struct linc_metadata *metadata = &linc.dispatch.slots[cursor % LINC_DEFAULT_DISPATCH_SIZE];
+        int sink_check = linc_check_sink(sink, metadata->level);
+        if (sink_check == 0) {
+            sink->funcs.write(sink->funcs.data, metadata);
+        }
+        linc_dispatch_advance(sink, cursor + 1);
+    }
+    return cursor;
+}
+
+static size_t linc_task_write_batch(struct linc_sink *sink, size_t cursor, size_t published) {
+    size_t batch_size = LINC_ATOMIC_LOAD(&sink->batch_size, LINC_RELAXED);
+    uint32_t batch_latency = LINC_ATOMIC_LOAD(&sink->batch_latency, LINC_RELAXED);
+
+    if (published - cursor < batch_size && batch_latency > 0) {
+        published = linc_dispatch_wait_batch(cursor, batch_size, batch_latency);
+    }
+
+    struct linc_metadata *records[LINC_DEFAULT_BATCH_SIZE];
+    size_t count = 0;
+    for (; cursor != published && count < batch_size; cursor++) {
+        struct linc_metadata *metadata = &linc.dispatch.slots[cursor % LINC_DEFAULT_DISPATCH_SIZE];
+        int sink_check = linc_check_sink(sink, metadata->level);
+        if (sink_check == 0) {
+            records[count++] = metadata;
+        }
+    }
+    if (count > 0) {
+        sink->funcs.write_batch(sink->funcs.data, records, count);
+    }
+    linc_dispatch_advance(sink, cursor);
+    return cursor;
+}
+
+static bool linc_task_is_due(const struct timespec *deadline) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec > deadline->tv_sec || (now.tv_sec == deadline->tv_sec && now.tv_nsec >= deadline->tv_nsec);
+}
+
 void *linc_task(void *arg) {
     struct linc_sink *sink = (struct linc_sink *)arg;
+    size_t cursor = LINC_ATOMIC_LOAD(&sink->cursor, LINC_ACQUIRE);
+    // Sinks with a flush latency are flushed once that much time passed since the first write after the last flush,
+    // whether more records arrive or not.
+    bool is_pending = false;
+    struct timespec flush_deadline;
 
     while (true) {
-        linc_task_sync_wait_worker();
-        struct linc_metadata *metadata = linc.task_sync.metadata;
-        if (metadata == NULL) {
+        size_t published = is_pending ? linc_dispatch_wait_until(cursor, &flush_deadline) : linc_dispatch_wait(cursor);
+        if (is_pending && (published == cursor || linc_task_is_due(&flush_deadline))) {
+            sink->funcs.flush(sink->funcs.data);
+            is_pending = false;
+            continue;
+        }
+        if (published == cursor) {
             break;
         }
-        int sink_check = linc_check_sink(sink, metadata->level);
-        if (sink_check == 0) {
-            sink->funcs.write(sink->funcs.data, metadata);
+        if (sink->funcs.write_batch != NULL) {
+            cursor = linc_task_write_batch(sink, cursor, published);
+        } else {
+            cursor = linc_task_write(sink, cursor, published);
+        }
+        if (!is_pending && sink->funcs.flush_latency > 0) {
+            linc_deadline(&flush_deadline, sink->funcs.flush_latency);
+            is_pending = true;
         }
-        linc_task_sync_signal_worker();
     }
     sink->funcs.flush(sink->funcs.data);
     sink->funcs.close(sink->funcs.data);
-    linc_task_sync_signal_worker();
 
     pthread_exit(0);
 }
 
+static bool linc_worker_is_ready(void *arg) {
+    (void)arg;
+    if (LINC_ATOMIC_LOAD(&linc.ring_buffer.shutdown, LINC_ACQUIRE) == true) {
+        return true;
+    }
+    if (LINC_ATOMIC_LOAD(&linc.eviction_requested, LINC_ACQUIRE) == true) {
+        return true;
+    }
+    if (linc_ring_buffer_peek(&linc.ring_buffer) != NULL) {
+        return true;
+    }
+    size_t count = LINC_ATOMIC_LOAD(&linc.thread_buffers.count, LINC_ACQUIRE);
+    for (size_t i = 0; i < count; i++) {
+        struct linc_thread_buffer *buffer = &linc.thread_buffers.list[i];
+        int state = LINC_ATOMIC_LOAD(&buffer->state, LINC_ACQUIRE);
+        if (state == LINC_THREAD_BUFFER_RETIRED || linc_ring_buffer_peek(&buffer->ring) != NULL) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Tells whether every buffer satisfies the check, the shared ring buffer and the per-thread ones.
+static bool linc_worker_is_every(bool (*check)(struct linc_ring_buffer *ring)) {
+    if (!check(&linc.ring_buffer)) {
+        return false;
+    }
+    size_t count = LINC_ATOMIC_LOAD(&linc.thread_buffers.count, LINC_ACQUIRE);
+    for (size_t i = 0; i < count; i++) {
+        if (!check(&linc.thread_buffers.list[i].ring)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool linc_worker_is_drained(void) {
+    return linc_worker_is_every(linc_ring_buffer_is_drained);
+}
+
+// The buffers are empty but still open, unlike drained ones, which are only drained once shut down.
+static bool linc_worker_is_empty(void) {
+    return linc_worker_is_every(linc_ring_buffer_is_empty);
+}
+
+// Timestamps of the same clock compare as raw ticks, records of different clocks, e.g., around a call to
+// linc_set_clock, are only comparable once converted.
+static bool linc_worker_is_older(const struct linc_record *record, const struct linc_record *oldest) {
+    if (((record->flags ^ oldest->flags) & LINC_RECORD_CLOCK_MASK) == 0) {
+        return record->timestamp < oldest->timestamp;
+    }
+    return linc_clock_nanoseconds(record->timestamp, record->flags)
+           < linc_clock_nanoseconds(oldest->timestamp, oldest->flags);
+}
+
+// Picks the buffer holding the oldest log among the shared ring buffer and the per-thread buffers. A thread that is
+// producing a log into an empty buffer may still publish an older timestamp, so the choice is postponed a few times
+// while that happens, keeping the output ordered by timestamp.
+static struct linc_ring_buffer *linc_worker_next(void) {
+    for (int attempt = 0;; attempt++) {
+        struct linc_record *oldest = linc_ring_buffer_peek(&linc.ring_buffer);
+        struct linc_ring_buffer *next = oldest == NULL ? NULL : &linc.ring_buffer;
+        bool is_pending = false;
+
+        size_t count = LINC_ATOMIC_LOAD(&linc.thread_buffers.count, LINC_ACQUIRE);
+        for (size_t i = 0; i < count; i++) {
+            struct linc_thread_buffer *buffer = &linc.thread_buffers.list[i];
+            int state = LINC_ATOMIC_LOAD(&buffer->state, LINC_ACQUIRE);
+            if (state == LINC_THREAD_BUFFER_FREE) {
+                continue;
+            }
+            bool is_producing = LINC_ATOMIC_LOAD(&buffer->pending, LINC_ACQUIRE);
+            struct linc_record *record = linc_ring_buffer_peek(&buffer->ring);
+            if (record == NULL) {
+                if (state == LINC_THREAD_BUFFER_RETIRED) {
+                    LINC_ATOMIC_CAS(&buffer->state, &state, LINC_THREAD_BUFFER_FREE, LINC_RELEASE);
+                }
+                is_pending |= is_producing;
+                continue;
+            }
+            if (oldest == NULL || linc_worker_is_older(record, oldest)) {
+                oldest = record;
+                next = &buffer->ring;
+            }
+        }
+
+        if (next == NULL || !is_pending || attempt >= LINC_SPIN_ATTEMPTS) {
+            return next;
+        }
+        sched_yield();
+    }
+}
+
+static bool linc_worker_can_dispatch(void *arg) {
+    return linc_dispatch_has_space(arg) || LINC_ATOMIC_LOAD(&linc.eviction_requested, LINC_ACQUIRE) == true;
+}
+
+static void linc_worker_drop(struct linc_record *record) {
+    struct linc_module *module = linc_module_of_name(record->module_name);
+    LINC_ATOMIC_FETCH_ADD(&module->dropped, 1, LINC_RELAXED);
+}
+
+// Drops the oldest records of the buffers whose producers asked for it with the overwrite-oldest policy.
+static void linc_worker_evict(void) {
+    if (LINC_ATOMIC_LOAD(&linc.eviction_requested, LINC_RELAXED) == false) {
+        return;
+    }
+    LINC_ATOMIC_STORE(&linc.eviction_requested, false, LINC_SEQ_CST);
+    linc_ring_buffer_evict(&linc.ring_buffer, linc_worker_drop);
+    size_t count = LINC_ATOMIC_LOAD(&linc.thread_buffers.count, LINC_ACQUIRE);
+    for (size_t i = 0; i < count; i++) {
+        linc_ring_buffer_evict(&linc.thread_buffers.list[i].ring, linc_worker_drop);
+    }
+}
+
+// Once the buffers are empty again, reports the logs dropped by each module since the last report as a warning of
+// that module.
+static void linc_worker_report(void) {
+    pthread_mutex_lock(&linc.modules.mutex);
+    size_t count = linc.modules.count;
+    pthread_mutex_unlock(&linc.modules.mutex);
+
+    for (size_t i = 0; i < count; i++) {
+        struct linc_module *module = &linc.modules.list[i];
+        size_t dropped = LINC_ATOMIC_LOAD(&module->dropped, LINC_RELAXED);
+        if (dropped == module->reported) {
+            continue;
+        }
+
+        struct linc_metadata *metadata = linc_dispatch_claim();
+        metadata->timestamp = linc_timestamp();
+        metadata->level = LINC_LEVEL_WARN;
+        metadata->thread = linc_thread_current();
+        const struct linc_thread *thread = linc_thread_of(metadata->thread);
+        metadata->thread_id = thread != NULL ? thread->id : (uintptr_t)pthread_self();
+        metadata->module_name = module->name;
+        metadata->filename = __FILE__;
+        metadata->line = __LINE__;
+        metadata->func = __func__;
+        snprintf(metadata->message, sizeof(metadata->message), "%zu messages dropped", dropped - module->reported);
+        linc_dispatch_publish();
+        module->reported = dropped;
+    }
+}
+
 void *linc_worker(void *arg) {
     (void)arg;
 
     while (true) {
-        struct linc_metadata metadata;
-        if (linc_ring_buffer_dequeue(&metadata) < 0) {
-            pthread_rwlock_rdlock(&linc.sinks.lock);
-            linc_task_sync_wait_tasks();
-            linc.task_sync.metadata = NULL;
-            linc_task_sync_signal_tasks();
-            pthread_rwlock_unlock(&linc.sinks.lock);
-            break;
+        linc_worker_evict();
+        struct linc_ring_buffer *ring = linc_worker_next();
+        if (ring == NULL) {
+            linc_clock_resync(true);
+            linc_worker_report();
+            linc_thread_collect(linc_worker_is_empty);
+            if (linc_worker_is_drained()) {
+                linc_dispatch_shutdown();
+                pthread_rwlock_rdlock(&linc.sinks.lock);
+                for (size_t i = 0; i < linc.sinks.count; i++) {
+                    pthread_join(linc.sinks.list[i].thread_id, NULL);
+                }
+                pthread_rwlock_unlock(&linc.sinks.lock);
+                break;
+            }
+            if (LINC_ATOMIC_LOAD(&linc.ring_buffer.shutdown, LINC_ACQUIRE) == true) {
+                // Producers claimed positions before the shutdown and are still publishing them.
+                sched_yield();
+                continue;
+            }
+            // Wakes up at least once per resync interval, so the clock follows the realtime clock while idle.
+            struct timespec deadline;
+            linc_deadline(&deadline, (uint64_t)LINC_DEFAULT_CLOCK_RESYNC_MS * 1000);
+            linc_signal_wait_until(&linc.worker_signal, linc_worker_is_ready, NULL, &deadline);
+            continue;
+        }
+
+        if (!linc_dispatch_has_space(NULL)) {
+            // Producers may ask for an eviction while the worker waits for the sinks.
+            linc_signal_wait(&linc.dispatch.produce, linc_worker_can_dispatch, NULL);
+            continue;
         }
 
-        pthread_rwlock_rdlock(&linc.sinks.lock);
-        linc_task_sync_wait_tasks();
-        linc.task_sync.metadata = &metadata;
-        linc_task_sync_signal_tasks();
-        pthread_rwlock_unlock(&linc.sinks.lock);
+        struct linc_metadata *metadata = linc_dispatch_claim();
+        linc_record_decode(linc_ring_buffer_peek(ring), metadata);
+        linc_ring_buffer_release(ring);
+        linc_dispatch_publish();
+        linc_clock_resync(false);
     }
 
     pthread_exit(0);
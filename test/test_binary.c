@@ -0,0 +1,197 @@
+#include "internal/binary.h"
+#include "linc.h"
+#include "utinc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BINARY_LOGS 1000
+
+const char *title = "LINC binary format test\n";
+
+static struct linc_binary_writer writer;
+static struct linc_binary_reader reader;
+static struct linc_metadata metadata;
+static struct linc_metadata decoded;
+static char encoded[65536];
+static char expected_line[1024];
+static char decoded_line[1024];
+static struct linc_sink_file_options binary_options;
+static const struct timespec binary_pause = {.tv_sec = 0, .tv_nsec = 500000000};  // Many times the flush delay
+
+// Decodes the bytes, renders every log and compares it with the text of the logs numbered from first. Returns the
+// number of logs, or -1 if one differs or the bytes are not valid.
+static int decode_all(const char *data, size_t length, int first) {
+    int count = 0;
+    size_t position = 0;
+    while (position < length) {
+        size_t used = 0;
+        const char *entry = data + position;
+        enum linc_binary_status status = linc_binary_decode(&reader, entry, length - position, &decoded, &used);
+        if (status <= LINC_BINARY_PARTIAL) {
+            return -1;
+        }
+        if (status == LINC_BINARY_RECORD) {
+            snprintf(expected_line, sizeof(expected_line), "binary log %d", first + count);
+            linc_stringify_metadata(&decoded, decoded_line, sizeof(decoded_line), false);
+            if (strcmp(decoded.message, expected_line) != 0 || strstr(decoded_line, expected_line) == NULL) {
+                return -1;
+            }
+            count++;
+        }
+        position += used;
+    }
+    return count;
+}
+
+DEFINE_CALLBACK(clean_binary, {
+    memset(&writer, 0, sizeof(writer));
+    memset(&reader, 0, sizeof(reader));
+    memset(&metadata, 0, sizeof(metadata));
+    metadata.timestamp = 1757500215000000000;
+    metadata.level = LINC_LEVEL_WARN;
+    metadata.thread_id = 0x0123456789;
+    metadata.module_name = "module";
+    metadata.filename = "test_file.c";
+    metadata.line = 42;
+    metadata.func = "test_function";
+    strcpy(metadata.message, "This is a test message");
+})
+
+TEST_RUNNER(title, {
+    BEFORE_EACH(clean_binary);
+    TEST_SUITE("Binary format tests", {
+        TEST_CASE("Should decode logs into the same text", {
+            size_t length = 0;
+            for (int i = 0; i < 4; i++) {
+                metadata.timestamp += i % 2 == 0 ? 1500000 : -700000;
+                metadata.level = (enum linc_level)(LINC_LEVEL_TRACE + i);
+                metadata.module_name = i == 3 ? NULL : metadata.module_name;
+                metadata.line += (uint32_t)i * 1000;
+                length += linc_binary_encode(&writer, &metadata, encoded + length);
+            }
+            size_t position = 0;
+            size_t used = 0;
+            int records = 0;
+            while (position < length) {
+                enum linc_binary_status status =
+                    linc_binary_decode(&reader, encoded + position, length - position, &decoded, &used);
+                ASSERT_TRUE(status > LINC_BINARY_PARTIAL, "Error decoding entry");
+                position += used;
+                records += status == LINC_BINARY_RECORD;
+            }
+            ASSERT_EQUAL(4, records, "Error number of logs");
+            linc_stringify_metadata(&metadata, expected_line, sizeof(expected_line), false);
+            linc_stringify_metadata(&decoded, decoded_line, sizeof(decoded_line), false);
+            ASSERT_STRING_EQUAL(expected_line, decoded_line, "Error decoded text");
+            ASSERT_NULL(decoded.module_name, "Error missing module");
+        });
+
+        TEST_CASE("Should intern names and start segments that decode on their own", {
+            size_t first = linc_binary_encode(&writer, &metadata, encoded);
+            size_t second = linc_binary_encode(&writer, &metadata, encoded + first);
+            ASSERT_TRUE(second < first / 2, "Error interned names written again");
+            ASSERT_TRUE(second < strlen(metadata.message) + 16, "Error size of an interned log");
+
+            linc_binary_reset(&writer);
+            size_t third = linc_binary_encode(&writer, &metadata, encoded);
+            ASSERT_EQUAL(first, third, "Error size of the first log of a new segment");
+            size_t used = 0;
+            size_t entry = 0;
+            int definitions = 0;
+            enum linc_binary_status status = LINC_BINARY_DEFINITION;
+            while ((status = linc_binary_decode(&reader, encoded + used, third - used, &decoded, &entry))
+                   == LINC_BINARY_DEFINITION) {
+                used += entry;
+                definitions++;
+            }
+            ASSERT_EQUAL(LINC_BINARY_RECORD, status, "Error log of the new segment");
+            ASSERT_EQUAL(5, definitions, "Error header and definitions of a segment");
+            ASSERT_EQUAL(third, used + entry, "Error length of the new segment");
+        });
+
+        TEST_CASE("Should reject partial and invalid data", {
+            size_t length = linc_binary_encode(&writer, &metadata, encoded);
+            size_t used = 0;
+            enum linc_binary_status status = linc_binary_decode(&reader, encoded, 3, &decoded, &used);
+            ASSERT_EQUAL(LINC_BINARY_PARTIAL, status, "Error partial header");
+            ASSERT_EQUAL(0, used, "Error bytes used by a partial header");
+
+            encoded[0] = 'X';
+            status = linc_binary_decode(&reader, encoded, length, &decoded, &used);
+            ASSERT_EQUAL(LINC_BINARY_INVALID, status, "Error unknown tag");
+            encoded[0] = 'R';
+            status = linc_binary_decode(&reader, encoded, length, &decoded, &used);
+            ASSERT_EQUAL(LINC_BINARY_INVALID, status, "Error log before a segment");
+        });
+    });
+
+    TEST_SUITE("Binary sinks tests", {
+        TEST_CASE("Should write logs that decode in order", {
+            linc_set_sink_enabled(linc_default_sink, false);
+            char path[] = "/tmp/linc_test_binary_XXXXXX";
+            int fd = mkstemp(path);
+            ASSERT_TRUE(fd >= 0, "Error mkstemp");
+            binary_options.flush_delay_us = 20000;
+            struct linc_sink_funcs funcs = linc_sink_binary_funcs(path, &binary_options);
+            linc_sink sink = linc_register_sink("binary", LINC_LEVEL_TRACE, true, funcs);
+            ASSERT_NOT_NULL(sink, "Error sink");
+
+            size_t text_length = 0;
+            for (int i = 0; i < BINARY_LOGS; i++) {
+                INFO("binary log %d", i);
+                text_length += 90 + (size_t)snprintf(expected_line, sizeof(expected_line), "binary log %d", i);
+            }
+            nanosleep(&binary_pause, NULL);
+            ssize_t length = read(fd, encoded, sizeof(encoded));
+            close(fd);
+            unlink(path);
+            linc_set_sink_enabled(sink, false);
+
+            ASSERT_TRUE(length > 0, "Error reading binary file");
+            ASSERT_EQUAL(BINARY_LOGS, decode_all(encoded, (size_t)length, 0), "Error decoding binary file");
+            ASSERT_TRUE((size_t)length * 3 < text_length, "Error binary file not smaller than text");
+        });
+
+        TEST_CASE("Should give back the file and the slot of sinks whose registration fails", {
+            char path[] = "/tmp/linc_test_binary_XXXXXX";
+            int fd = mkstemp(path);
+            ASSERT_TRUE(fd >= 0, "Error mkstemp");
+            int lowest_fd = dup(fd);
+            close(lowest_fd);
+            int failed = 0;
+            for (int i = 0; i < LINC_DEFAULT_MAX_FILE_SINKS + 1; i++) {
+                struct linc_sink_funcs funcs = linc_sink_binary_funcs(path, NULL);
+                failed += linc_register_sink("binary", LINC_LEVEL_TRACE, true, funcs) == NULL;
+            }
+            int next_fd = dup(fd);
+            close(next_fd);
+            linc_sink sink = linc_register_sink("fresh", LINC_LEVEL_TRACE, true, linc_sink_binary_funcs(path, NULL));
+            linc_set_sink_enabled(sink, false);
+            close(fd);
+            unlink(path);
+
+            ASSERT_EQUAL(LINC_DEFAULT_MAX_FILE_SINKS + 1, failed, "Error duplicate name");
+            ASSERT_EQUAL(lowest_fd, next_fd, "Error file left open");
+            ASSERT_NOT_NULL(sink, "Error fresh sink");
+        });
+
+        TEST_CASE("Should give back the slot of functions that are never registered", {
+            int built = 0;
+            for (int i = 0; i < LINC_DEFAULT_MAX_FILE_SINKS + 1; i++) {
+                struct linc_sink_funcs funcs = linc_sink_binary_funcs("/tmp/linc_test_unregistered.bin", NULL);
+                built += funcs.open != NULL;
+                linc_release_sink_funcs(funcs);
+            }
+            ASSERT_EQUAL(LINC_DEFAULT_MAX_FILE_SINKS + 1, built, "Error slot kept by unregistered functions");
+        });
+
+        TEST_CASE("Should reject binary sinks without a path", {
+            struct linc_sink_funcs funcs = linc_sink_binary_funcs(NULL, NULL);
+            ASSERT_NULL(funcs.write, "Error funcs without a path");
+        });
+    });
+})
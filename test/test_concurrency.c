@@ -0,0 +1,748 @@
+#include "linc.h"
+#include "utinc.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define PRODUCERS 16
+#define PRODUCER_LOGS 2000
+#define MAX_PADDING 400
+#define SLOW_LOGS 100
+#define BATCH_LOGS 1000
+#define BATCH_SIZE 32
+#define PRESSURE_LOGS 20000
+#define SHARED_LOGS 100
+
+const char *title = "LINC concurrency test\n";
+
+bool padded = false;
+char padding[MAX_PADDING + 1];
+
+struct counting {
+    pthread_mutex_t mutex;
+    int count;
+    int last[PRODUCERS];
+    int out_of_order;
+    int64_t last_timestamp;
+    int unsorted;
+    int corrupted;
+};
+struct counting counting = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+};
+
+int sink_counting_open(void *data) {
+    (void)data;
+    return 0;
+}
+
+int sink_counting_close(void *data) {
+    (void)data;
+    return 0;
+}
+
+int sink_counting_write(void *data, struct linc_metadata *metadata) {
+    struct counting *counting = (struct counting *)data;
+    int producer = -1;
+    int index = -1;
+    int length = 0;
+    if (sscanf(metadata->message, "producer %d log %d%n", &producer, &index, &length) != 2) {
+        return -1;
+    }
+    if (producer < 0 || producer >= PRODUCERS) {
+        return -1;
+    }
+    const char *tail = metadata->message + length;
+    size_t expected = padded ? (size_t)((producer * 31 + index) % MAX_PADDING) : 0;
+    bool is_corrupted = strlen(tail) != expected || strspn(tail, "x") != expected;
+    pthread_mutex_lock(&counting->mutex);
+    if (is_corrupted) {
+        counting->corrupted++;
+    }
+    if (index != counting->last[producer] + 1) {
+        counting->out_of_order++;
+    }
+    counting->last[producer] = index;
+    if (metadata->timestamp < counting->last_timestamp) {
+        counting->unsorted++;
+    }
+    counting->last_timestamp = metadata->timestamp;
+    counting->count++;
+    pthread_mutex_unlock(&counting->mutex);
+    return 0;
+}
+
+int sink_counting_flush(void *data) {
+    (void)data;
+    return 0;
+}
+
+struct batching {
+    pthread_mutex_t mutex;
+    int count;
+    int calls;
+    int oversized;
+    int out_of_order;
+};
+struct batching batching = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+};
+
+int sink_batching_write_batch(void *data, struct linc_metadata *const *records, size_t count) {
+    struct batching *batching = (struct batching *)data;
+    pthread_mutex_lock(&batching->mutex);
+    batching->calls++;
+    if (count > BATCH_SIZE) {
+        batching->oversized++;
+    }
+    for (size_t i = 0; i < count; i++) {
+        int index = -1;
+        if (sscanf(records[i]->message, "batch log %d", &index) == 1) {
+            batching->out_of_order += index != batching->count;
+            batching->count++;
+        }
+    }
+    pthread_mutex_unlock(&batching->mutex);
+    return 0;
+}
+
+struct sharing {
+    pthread_mutex_t mutex;
+    int count;
+    const char *texts[SHARED_LOGS];
+    int mismatched;
+};
+struct sharing sharing[2] = {
+    {.mutex = PTHREAD_MUTEX_INITIALIZER},
+    {.mutex = PTHREAD_MUTEX_INITIALIZER},
+};
+const char *sharing_names[2] = {"sharing_a", "sharing_b"};
+
+int sink_sharing_write(void *data, struct linc_metadata *metadata) {
+    struct sharing *sharing = (struct sharing *)data;
+    int index = -1;
+    if (sscanf(metadata->message, "shared log %d", &index) != 1 || index < 0 || index >= SHARED_LOGS) {
+        return 0;
+    }
+    size_t length = 0;
+    const char *text = linc_layout_view(linc_layout_json, metadata, &length);
+    char expected[1024];
+    int expected_length = linc_layout_render(linc_layout_json, metadata, expected, sizeof(expected));
+    pthread_mutex_lock(&sharing->mutex);
+    if (text == NULL || (int)length != expected_length || strncmp(text, expected, length) != 0) {
+        sharing->mismatched++;
+    }
+    sharing->texts[index] = text;
+    sharing->count++;
+    pthread_mutex_unlock(&sharing->mutex);
+    return 0;
+}
+
+struct naming {
+    pthread_mutex_t mutex;
+    linc_layout layout;
+    char texts[2][128];
+    int count;
+    uintptr_t crowded_ids[2];
+    uint32_t crowded_threads[2];
+};
+struct naming naming = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+};
+linc_sink naming_sink = NULL;
+
+int sink_naming_write(void *data, struct linc_metadata *metadata) {
+    struct naming *naming = (struct naming *)data;
+    int index = -1;
+    if (sscanf(metadata->message, "crowded log %d", &index) == 1 && index >= 0 && index <= 1) {
+        pthread_mutex_lock(&naming->mutex);
+        naming->crowded_ids[index] = metadata->thread_id;
+        naming->crowded_threads[index] = metadata->thread;
+        pthread_mutex_unlock(&naming->mutex);
+        return 0;
+    }
+    if (sscanf(metadata->message, "named log %d", &index) != 1 || index < 0 || index > 1) {
+        return 0;
+    }
+    pthread_mutex_lock(&naming->mutex);
+    linc_layout_render(naming->layout, metadata, naming->texts[index], sizeof(naming->texts[index]));
+    naming->count++;
+    pthread_mutex_unlock(&naming->mutex);
+    return 0;
+}
+
+void *naming_thread(void *arg) {
+    int index = *(int *)arg;
+    if (index == 0) {
+        linc_set_thread_name("named thread");
+    }
+    INFO("named log %d", index);
+    return NULL;
+}
+
+// Threads that keep every entry of the registry until they are released, and the thread that logs meanwhile.
+struct crowding {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int ready;
+    bool released;
+    uintptr_t id;
+};
+struct crowding crowding = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+
+void crowding_wait(void) {
+    pthread_mutex_lock(&crowding.mutex);
+    crowding.ready++;
+    pthread_cond_broadcast(&crowding.cond);
+    while (!crowding.released) {
+        pthread_cond_wait(&crowding.cond, &crowding.mutex);
+    }
+    pthread_mutex_unlock(&crowding.mutex);
+}
+
+void *crowding_thread(void *arg) {
+    (void)arg;
+    linc_set_thread_name("crowding");
+    crowding_wait();
+    return NULL;
+}
+
+void *crowded_thread(void *arg) {
+    (void)arg;
+    crowding.id = (uintptr_t)pthread_self();
+    INFO("crowded log 0");
+    crowding_wait();
+    // The worker frees the retired entries while idle, at least once per resync interval.
+    struct timespec pause = {.tv_sec = 0, .tv_nsec = 10000000};
+    uint32_t thread = 0;
+    for (int attempt = 0; attempt < 500 && thread == 0; attempt++) {
+        INFO("crowded log 1");
+        nanosleep(&pause, NULL);
+        pthread_mutex_lock(&naming.mutex);
+        thread = naming.crowded_threads[1];
+        pthread_mutex_unlock(&naming.mutex);
+    }
+    return NULL;
+}
+
+pthread_mutex_t slow_mutex = PTHREAD_MUTEX_INITIALIZER;
+int slow_count = 0;
+
+int sink_slow_write(void *data, struct linc_metadata *metadata) {
+    (void)data;
+    (void)metadata;
+    struct timespec pause = {.tv_sec = 0, .tv_nsec = 10000000};
+    nanosleep(&pause, NULL);
+    pthread_mutex_lock(&slow_mutex);
+    slow_count++;
+    pthread_mutex_unlock(&slow_mutex);
+    return 0;
+}
+
+struct gate {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool closed;
+    int count;
+    int last;
+    int dropped;
+    int errors;
+};
+struct gate gate = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+linc_sink gate_sink = NULL;
+linc_module pressure = NULL;
+
+int sink_gate_write(void *data, struct linc_metadata *metadata) {
+    struct gate *gate = (struct gate *)data;
+    pthread_mutex_lock(&gate->mutex);
+    while (gate->closed) {
+        pthread_cond_wait(&gate->cond, &gate->mutex);
+    }
+    int value = 0;
+    if (sscanf(metadata->message, "pressure log %d", &value) == 1) {
+        gate->count++;
+        gate->last = value;
+    } else if (sscanf(metadata->message, "%d messages dropped", &value) == 1) {
+        gate->dropped += value;
+    } else if (strcmp(metadata->message, "pressure error") == 0) {
+        gate->errors++;
+    }
+    pthread_mutex_unlock(&gate->mutex);
+    return 0;
+}
+
+void close_gate(void) {
+    pthread_mutex_lock(&gate.mutex);
+    gate.closed = true;
+    gate.count = 0;
+    gate.last = -1;
+    gate.dropped = 0;
+    gate.errors = 0;
+    pthread_mutex_unlock(&gate.mutex);
+}
+
+void *open_gate(void *arg) {
+    (void)arg;
+    struct timespec pause = {.tv_sec = 0, .tv_nsec = 100000000};
+    nanosleep(&pause, NULL);
+    pthread_mutex_lock(&gate.mutex);
+    gate.closed = false;
+    pthread_cond_broadcast(&gate.cond);
+    pthread_mutex_unlock(&gate.mutex);
+    return NULL;
+}
+
+void *producer_thread(void *arg) {
+    int producer = *(int *)arg;
+    for (int i = 0; i < PRODUCER_LOGS; i++) {
+        int length = padded ? (producer * 31 + i) % MAX_PADDING : 0;
+        INFO("producer %d log %d%.*s", producer, i, length, padding);
+    }
+    return NULL;
+}
+
+void run_producers(void) {
+    pthread_t threads[PRODUCERS];
+    int ids[PRODUCERS];
+    for (int i = 0; i < PRODUCERS; i++) {
+        ids[i] = i;
+        pthread_create(&threads[i], NULL, producer_thread, &ids[i]);
+    }
+    for (int i = 0; i < PRODUCERS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    sleep(1);
+}
+
+DEFINE_CALLBACK(counting_sink_init, {
+    linc_set_sink_enabled(linc_default_sink, false);
+    struct linc_sink_funcs counting_funcs;
+    memset(&counting_funcs, 0, sizeof(counting_funcs));
+    counting_funcs.data = &counting;
+    counting_funcs.open = sink_counting_open;
+    counting_funcs.close = sink_counting_close;
+    counting_funcs.write = sink_counting_write;
+    counting_funcs.flush = sink_counting_flush;
+    linc_register_sink("counting", LINC_LEVEL_TRACE, true, counting_funcs);
+})
+
+DEFINE_CALLBACK(counting_sink_clean, {
+    pthread_mutex_lock(&counting.mutex);
+    counting.count = 0;
+    counting.out_of_order = 0;
+    counting.last_timestamp = 0;
+    counting.unsorted = 0;
+    counting.corrupted = 0;
+    for (int i = 0; i < PRODUCERS; i++) {
+        counting.last[i] = -1;
+    }
+    pthread_mutex_unlock(&counting.mutex);
+})
+
+TEST_RUNNER(title, {
+    BEFORE_ALL(counting_sink_init);
+    BEFORE_EACH(counting_sink_clean);
+
+    TEST_SUITE("Multiple producers tests", {
+        TEST_CASE("Should deliver every log of every producer in order", {
+            run_producers();
+
+            pthread_mutex_lock(&counting.mutex);
+            int count = counting.count;
+            int out_of_order = counting.out_of_order;
+            pthread_mutex_unlock(&counting.mutex);
+            ASSERT_EQUAL(PRODUCERS * PRODUCER_LOGS, count, "Error count");
+            ASSERT_EQUAL(0, out_of_order, "Error order");
+        });
+
+        TEST_CASE("Should deliver variable-length logs intact", {
+            memset(padding, 'x', MAX_PADDING);
+            padded = true;
+            run_producers();
+            padded = false;
+
+            pthread_mutex_lock(&counting.mutex);
+            int count = counting.count;
+            int out_of_order = counting.out_of_order;
+            int corrupted = counting.corrupted;
+            pthread_mutex_unlock(&counting.mutex);
+            ASSERT_EQUAL(PRODUCERS * PRODUCER_LOGS, count, "Error count");
+            ASSERT_EQUAL(0, out_of_order, "Error order");
+            ASSERT_EQUAL(0, corrupted, "Error content");
+        });
+    });
+
+    TEST_SUITE("Per-thread pipeline tests", {
+        TEST_CASE("Should deliver every log ordered by timestamp", {
+            int result = linc_set_pipeline(LINC_PIPELINE_PER_THREAD);
+            ASSERT_EQUAL(0, result, "Error result");
+
+            run_producers();
+
+            pthread_mutex_lock(&counting.mutex);
+            int count = counting.count;
+            int out_of_order = counting.out_of_order;
+            int unsorted = counting.unsorted;
+            pthread_mutex_unlock(&counting.mutex);
+            ASSERT_EQUAL(PRODUCERS * PRODUCER_LOGS, count, "Error count");
+            ASSERT_EQUAL(0, out_of_order, "Error order");
+            ASSERT_EQUAL(0, unsorted, "Error timestamp order");
+        });
+
+        TEST_CASE("Should convert timestamps of the time stamp counter", {
+            if (linc_set_clock(LINC_CLOCK_TSC) < 0) {
+                linc_set_clock(LINC_CLOCK_COARSE);
+            }
+            run_producers();
+            linc_set_clock(LINC_CLOCK_MONOTONIC);
+
+            struct timespec real;
+            clock_gettime(CLOCK_REALTIME, &real);
+            int64_t now = (int64_t)real.tv_sec * 1000000000L + (int64_t)real.tv_nsec;
+            pthread_mutex_lock(&counting.mutex);
+            int count = counting.count;
+            int unsorted = counting.unsorted;
+            int64_t last_timestamp = counting.last_timestamp;
+            pthread_mutex_unlock(&counting.mutex);
+            ASSERT_EQUAL(PRODUCERS * PRODUCER_LOGS, count, "Error count");
+            ASSERT_EQUAL(0, unsorted, "Error timestamp order");
+            ASSERT_TRUE(last_timestamp <= now && last_timestamp > now - 5000000000L, "Error timestamp conversion");
+        });
+
+        TEST_CASE("Should reuse buffers of exited threads", {
+            run_producers();
+
+            pthread_mutex_lock(&counting.mutex);
+            int count = counting.count;
+            int out_of_order = counting.out_of_order;
+            pthread_mutex_unlock(&counting.mutex);
+            ASSERT_EQUAL(PRODUCERS * PRODUCER_LOGS, count, "Error count");
+            ASSERT_EQUAL(0, out_of_order, "Error order");
+
+            int result = linc_set_pipeline(LINC_PIPELINE_SHARED);
+            ASSERT_EQUAL(0, result, "Error result");
+            result = linc_set_pipeline(2);
+            ASSERT_EQUAL(-1, result, "Error result");
+        });
+    });
+
+    TEST_SUITE("Independent sinks tests", {
+        TEST_CASE("Should not throttle fast sinks behind a slow sink", {
+            struct linc_sink_funcs slow_funcs;
+            memset(&slow_funcs, 0, sizeof(slow_funcs));
+            slow_funcs.open = sink_counting_open;
+            slow_funcs.close = sink_counting_close;
+            slow_funcs.write = sink_slow_write;
+            slow_funcs.flush = sink_counting_flush;
+            linc_sink slow = linc_register_sink("slow", LINC_LEVEL_TRACE, true, slow_funcs);
+            ASSERT_NOT_NULL(slow, "Error sink");
+
+            for (int i = 0; i < SLOW_LOGS; i++) {
+                INFO("producer 0 log %d", i);
+            }
+            int count = 0;
+            struct timespec pause;
+            pause.tv_sec = 0;
+            pause.tv_nsec = 1000000;
+            for (int attempt = 0; attempt < 1000 && count < SLOW_LOGS; attempt++) {
+                nanosleep(&pause, NULL);
+                pthread_mutex_lock(&counting.mutex);
+                count = counting.count;
+                pthread_mutex_unlock(&counting.mutex);
+            }
+            pthread_mutex_lock(&slow_mutex);
+            int slow_logs = slow_count;
+            pthread_mutex_unlock(&slow_mutex);
+            linc_set_sink_enabled(slow, false);
+
+            ASSERT_EQUAL(SLOW_LOGS, count, "Error count");
+            ASSERT_TRUE(slow_logs < SLOW_LOGS, "Error slow sink count");
+        });
+    });
+
+    TEST_SUITE("Shared texts tests", {
+        TEST_CASE("Should render each record once for the sinks of the same layout", {
+            linc_sink sinks[2];
+            for (int i = 0; i < 2; i++) {
+                struct linc_sink_funcs sharing_funcs;
+                memset(&sharing_funcs, 0, sizeof(sharing_funcs));
+                sharing_funcs.data = &sharing[i];
+                sharing_funcs.open = sink_counting_open;
+                sharing_funcs.close = sink_counting_close;
+                sharing_funcs.write = sink_sharing_write;
+                sharing_funcs.flush = sink_counting_flush;
+                sinks[i] = linc_register_sink(sharing_names[i], LINC_LEVEL_TRACE, true, sharing_funcs);
+                ASSERT_NOT_NULL(sinks[i], "Error sink");
+            }
+
+            for (int i = 0; i < SHARED_LOGS; i++) {
+                INFO("shared log %d", i);
+            }
+            int count = 0;
+            struct timespec pause;
+            pause.tv_sec = 0;
+            pause.tv_nsec = 1000000;
+            for (int attempt = 0; attempt < 1000 && count < 2 * SHARED_LOGS; attempt++) {
+                nanosleep(&pause, NULL);
+                pthread_mutex_lock(&sharing[0].mutex);
+                pthread_mutex_lock(&sharing[1].mutex);
+                count = sharing[0].count + sharing[1].count;
+                pthread_mutex_unlock(&sharing[1].mutex);
+                pthread_mutex_unlock(&sharing[0].mutex);
+            }
+            linc_set_sink_enabled(sinks[0], false);
+            linc_set_sink_enabled(sinks[1], false);
+
+            int shared = 0;
+            for (int i = 0; i < SHARED_LOGS; i++) {
+                shared += sharing[0].texts[i] != NULL && sharing[0].texts[i] == sharing[1].texts[i];
+            }
+            ASSERT_EQUAL(2 * SHARED_LOGS, count, "Error count");
+            ASSERT_EQUAL(0, sharing[0].mismatched + sharing[1].mismatched, "Error shared text");
+            ASSERT_EQUAL(SHARED_LOGS, shared, "Error shared text count");
+        });
+    });
+
+    TEST_SUITE("Thread identity tests", {
+        TEST_CASE("Should render the name and kernel ID of each thread", {
+            naming.layout = linc_layout_compile("%N|%I|%i");
+            ASSERT_NOT_NULL(naming.layout, "Error layout");
+            struct linc_sink_funcs naming_funcs;
+            memset(&naming_funcs, 0, sizeof(naming_funcs));
+            naming_funcs.data = &naming;
+            naming_funcs.open = sink_counting_open;
+            naming_funcs.close = sink_counting_close;
+            naming_funcs.write = sink_naming_write;
+            naming_funcs.flush = sink_counting_flush;
+            naming_sink = linc_register_sink("naming", LINC_LEVEL_TRACE, true, naming_funcs);
+            ASSERT_NOT_NULL(naming_sink, "Error sink");
+
+            pthread_t threads[2];
+            int ids[2];
+            for (int i = 0; i < 2; i++) {
+                ids[i] = i;
+                pthread_create(&threads[i], NULL, naming_thread, &ids[i]);
+                pthread_join(threads[i], NULL);
+            }
+            int count = 0;
+            struct timespec pause;
+            pause.tv_sec = 0;
+            pause.tv_nsec = 1000000;
+            for (int attempt = 0; attempt < 1000 && count < 2; attempt++) {
+                nanosleep(&pause, NULL);
+                pthread_mutex_lock(&naming.mutex);
+                count = naming.count;
+                pthread_mutex_unlock(&naming.mutex);
+            }
+            linc_set_sink_enabled(naming_sink, false);
+
+            char name[32];
+            long tids[2];
+            char ids_text[2][32];
+            ASSERT_EQUAL(2, count, "Error count");
+            ASSERT_EQUAL(3, sscanf(naming.texts[0], "%31[^|]|%ld|%31s", name, &tids[0], ids_text[0]), "Error fields");
+            ASSERT_STRING_EQUAL("named thread", name, "Error thread name");
+            ASSERT_EQUAL(3, sscanf(naming.texts[1], "%31[^|]|%ld|%31s", name, &tids[1], ids_text[1]), "Error fields");
+            ASSERT_TRUE(strcmp(name, "named thread") != 0, "Error thread name of another thread");
+            ASSERT_TRUE(tids[0] > 0 && tids[1] > 0 && tids[0] != tids[1], "Error kernel thread IDs");
+            ASSERT_EQUAL(16, (int)strlen(ids_text[0]), "Error thread ID");
+        });
+
+        TEST_CASE("Should validate thread names", {
+            ASSERT_EQUAL(-1, linc_set_thread_name(NULL), "Error NULL name");
+            ASSERT_EQUAL(-1, linc_set_thread_name(""), "Error empty name");
+            ASSERT_EQUAL(-1, linc_set_thread_name("0123456789abcdef"), "Error too long name");
+            ASSERT_EQUAL(0, linc_set_thread_name("main"), "Error valid name");
+        });
+
+        TEST_CASE("Should keep the thread ID of threads without an entry and retry the claim", {
+            linc_set_sink_enabled(naming_sink, true);
+            static pthread_t threads[LINC_DEFAULT_MAX_THREADS + 1];
+            for (int i = 0; i < LINC_DEFAULT_MAX_THREADS; i++) {
+                pthread_create(&threads[i], NULL, crowding_thread, NULL);
+            }
+            pthread_mutex_lock(&crowding.mutex);
+            while (crowding.ready < LINC_DEFAULT_MAX_THREADS) {
+                pthread_cond_wait(&crowding.cond, &crowding.mutex);
+            }
+            pthread_mutex_unlock(&crowding.mutex);
+            pthread_create(&threads[LINC_DEFAULT_MAX_THREADS], NULL, crowded_thread, NULL);
+            pthread_mutex_lock(&crowding.mutex);
+            while (crowding.ready < LINC_DEFAULT_MAX_THREADS + 1) {
+                pthread_cond_wait(&crowding.cond, &crowding.mutex);
+            }
+            crowding.released = true;
+            pthread_cond_broadcast(&crowding.cond);
+            pthread_mutex_unlock(&crowding.mutex);
+            for (int i = 0; i <= LINC_DEFAULT_MAX_THREADS; i++) {
+                pthread_join(threads[i], NULL);
+            }
+            linc_set_sink_enabled(naming_sink, false);
+
+            pthread_mutex_lock(&naming.mutex);
+            ASSERT_EQUAL(0, (int)naming.crowded_threads[0], "Error entry of a full registry");
+            ASSERT_TRUE(naming.crowded_ids[0] == crowding.id, "Error thread ID without an entry");
+            ASSERT_TRUE(naming.crowded_threads[1] != 0, "Error entry not claimed again");
+            ASSERT_TRUE(naming.crowded_ids[1] == crowding.id, "Error thread ID with an entry");
+            pthread_mutex_unlock(&naming.mutex);
+        });
+    });
+
+    TEST_SUITE("Batched sinks tests", {
+        TEST_CASE("Should write batches of records in order", {
+            struct linc_sink_funcs batching_funcs;
+            memset(&batching_funcs, 0, sizeof(batching_funcs));
+            batching_funcs.data = &batching;
+            batching_funcs.open = sink_counting_open;
+            batching_funcs.close = sink_counting_close;
+            batching_funcs.flush = sink_counting_flush;
+            batching_funcs.write_batch = sink_batching_write_batch;
+            linc_sink sink = linc_register_sink("batching", LINC_LEVEL_TRACE, true, batching_funcs);
+            ASSERT_NOT_NULL(sink, "Error sink");
+            int result = linc_set_sink_batch(sink, BATCH_SIZE, 20000);
+            ASSERT_EQUAL(0, result, "Error result");
+
+            for (int i = 0; i < BATCH_LOGS; i++) {
+                INFO("batch log %d", i);
+            }
+            sleep(1);
+
+            pthread_mutex_lock(&batching.mutex);
+            int count = batching.count;
+            int calls = batching.calls;
+            int oversized = batching.oversized;
+            int out_of_order = batching.out_of_order;
+            pthread_mutex_unlock(&batching.mutex);
+            linc_set_sink_enabled(sink, false);
+
+            ASSERT_EQUAL(BATCH_LOGS, count, "Error count");
+            ASSERT_EQUAL(0, oversized, "Error batch size");
+            ASSERT_EQUAL(0, out_of_order, "Error order");
+            ASSERT_TRUE(calls <= BATCH_LOGS / BATCH_SIZE + 2, "Error batch count");
+        });
+
+        TEST_CASE("Should validate batch settings and callbacks", {
+            int result = linc_set_sink_batch(linc_default_sink, 0, 0);
+            ASSERT_EQUAL(-1, result, "Error result");
+            result = linc_set_sink_batch(linc_default_sink, LINC_DEFAULT_BATCH_SIZE + 1, 0);
+            ASSERT_EQUAL(-1, result, "Error result");
+            result = linc_set_sink_batch(NULL, 1, 0);
+            ASSERT_EQUAL(-1, result, "Error result");
+
+            struct linc_sink_funcs missing_funcs;
+            memset(&missing_funcs, 0, sizeof(missing_funcs));
+            missing_funcs.open = sink_counting_open;
+            missing_funcs.close = sink_counting_close;
+            missing_funcs.flush = sink_counting_flush;
+            linc_sink sink = linc_register_sink("missing", LINC_LEVEL_TRACE, true, missing_funcs);
+            ASSERT_NULL(sink, "Error sink");
+        });
+    });
+
+    TEST_SUITE("Backpressure tests", {
+        TEST_CASE("Should drop new logs and report them while errors block", {
+            struct linc_sink_funcs gate_funcs;
+            memset(&gate_funcs, 0, sizeof(gate_funcs));
+            gate_funcs.data = &gate;
+            gate_funcs.open = sink_counting_open;
+            gate_funcs.close = sink_counting_close;
+            gate_funcs.write = sink_gate_write;
+            gate_funcs.flush = sink_counting_flush;
+            close_gate();
+            gate_sink = linc_register_sink("gate", LINC_LEVEL_TRACE, true, gate_funcs);
+            ASSERT_NOT_NULL(gate_sink, "Error sink");
+            pressure = linc_register_module("pressure", LINC_LEVEL_TRACE, true);
+            ASSERT_NOT_NULL(pressure, "Error module");
+            int result = linc_set_module_backpressure(pressure, LINC_LEVEL_INFO, LINC_BACKPRESSURE_DROP_NEWEST, 0);
+            ASSERT_EQUAL(0, result, "Error result");
+
+            for (int i = 0; i < PRESSURE_LOGS; i++) {
+                INFO_M(pressure, "pressure log %d", i);
+            }
+            size_t dropped = linc_get_module_dropped(pressure);
+            pthread_t opener;
+            pthread_create(&opener, NULL, open_gate, NULL);
+            ERROR_M(pressure, "pressure error");
+            pthread_join(opener, NULL);
+            sleep(1);
+
+            pthread_mutex_lock(&gate.mutex);
+            int count = gate.count;
+            int reported = gate.dropped;
+            int errors = gate.errors;
+            pthread_mutex_unlock(&gate.mutex);
+            ASSERT_TRUE(dropped > 0, "Error dropped count");
+            ASSERT_EQUAL(dropped, linc_get_module_dropped(pressure), "Error blocked error dropped");
+            ASSERT_EQUAL(PRESSURE_LOGS, count + (int)dropped, "Error count");
+            ASSERT_EQUAL((int)dropped, reported, "Error reported count");
+            ASSERT_EQUAL(1, errors, "Error blocked error");
+        });
+
+        TEST_CASE("Should overwrite the oldest logs and keep the newest", {
+            close_gate();
+            size_t before = linc_get_module_dropped(pressure);
+            int result =
+                linc_set_module_backpressure(pressure, LINC_LEVEL_INFO, LINC_BACKPRESSURE_OVERWRITE_OLDEST, 0);
+            ASSERT_EQUAL(0, result, "Error result");
+
+            for (int i = 0; i < PRESSURE_LOGS; i++) {
+                INFO_M(pressure, "pressure log %d", i);
+            }
+            pthread_t opener;
+            pthread_create(&opener, NULL, open_gate, NULL);
+            pthread_join(opener, NULL);
+            sleep(1);
+
+            size_t dropped = linc_get_module_dropped(pressure) - before;
+            pthread_mutex_lock(&gate.mutex);
+            int count = gate.count;
+            int last = gate.last;
+            int reported = gate.dropped;
+            pthread_mutex_unlock(&gate.mutex);
+            ASSERT_TRUE(dropped > 0, "Error dropped count");
+            ASSERT_EQUAL(PRESSURE_LOGS, count + (int)dropped, "Error count");
+            ASSERT_EQUAL(PRESSURE_LOGS - 1, last, "Error newest log");
+            ASSERT_EQUAL((int)dropped, reported, "Error reported count");
+        });
+
+        TEST_CASE("Should give up after the timeout and validate policies", {
+            close_gate();
+            size_t before = linc_get_module_dropped(pressure);
+            int result =
+                linc_set_module_backpressure(pressure, LINC_LEVEL_INFO, LINC_BACKPRESSURE_BLOCK_TIMEOUT, 100);
+            ASSERT_EQUAL(0, result, "Error result");
+
+            for (int i = 0; i < PRESSURE_LOGS / 2; i++) {
+                INFO_M(pressure, "pressure log %d", i);
+            }
+            pthread_t opener;
+            pthread_create(&opener, NULL, open_gate, NULL);
+            pthread_join(opener, NULL);
+            sleep(1);
+            linc_set_sink_enabled(gate_sink, false);
+
+            size_t dropped = linc_get_module_dropped(pressure) - before;
+            pthread_mutex_lock(&gate.mutex);
+            int count = gate.count;
+            pthread_mutex_unlock(&gate.mutex);
+            ASSERT_TRUE(dropped > 0, "Error dropped count");
+            ASSERT_EQUAL(PRESSURE_LOGS / 2, count + (int)dropped, "Error count");
+
+            result = linc_set_module_backpressure(pressure, LINC_LEVEL_INFO, 4, 0);
+            ASSERT_EQUAL(-1, result, "Error result");
+            result = linc_set_module_backpressure(pressure, 6, LINC_BACKPRESSURE_BLOCK, 0);
+            ASSERT_EQUAL(-1, result, "Error result");
+            result = linc_set_module_backpressure(NULL, LINC_LEVEL_INFO, LINC_BACKPRESSURE_BLOCK, 0);
+            ASSERT_EQUAL(-1, result, "Error result");
+        });
+    });
+})
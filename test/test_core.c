@@ -1,14 +1,32 @@
+// Logs below INFO are removed from this file, see "Compile level tests".
+#define LINC_COMPILE_LEVEL LINC_LEVEL_INFO
+
 #include "linc.h"
 #include "utinc.h"
 
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 const char *title = "LINC core functions test\n";
 
-char timestamp_buffer[24];
+char timestamp_buffer[32];
 char metadata_buffer[816];
 struct linc_metadata metadata;
+int evaluated = 0;
+
+int evaluate(void) {
+    return ++evaluated;
+}
+
+// Distance in nanoseconds between linc_timestamp and the realtime clock.
+int64_t clock_distance(void) {
+    struct timespec real;
+    clock_gettime(CLOCK_REALTIME, &real);
+    int64_t distance = linc_timestamp() - ((int64_t)real.tv_sec * 1000000000L + (int64_t)real.tv_nsec);
+    return distance < 0 ? -distance : distance;
+}
 
 DEFINE_CALLBACK(clean_timestamp, { memset(timestamp_buffer, 0, sizeof(timestamp_buffer)); })
 DEFINE_CALLBACK(clean_metadata, {
@@ -255,6 +273,56 @@ TEST_RUNNER(title, {
             ASSERT_EQUAL(result, 0, "Error in linc_timestamp_string result");
             ASSERT_STRING_EQUAL("1677-09-21 00:12:43.145", timestamp_buffer, "Error formatting min timestamp");
         });
+
+        TEST_CASE("Should format micro and nanoseconds", {
+            int64_t ns = 1700000000123456789LL;
+            int result = linc_format_timestamp(
+                ns, timestamp_buffer, sizeof(timestamp_buffer), LINC_TIMESTAMP_MICROSECONDS, LINC_TIMEZONE_UTC);
+            ASSERT_EQUAL(result, 0, "Error in linc_format_timestamp result");
+            ASSERT_STRING_EQUAL("2023-11-14 22:13:20.123456", timestamp_buffer, "Error formatting microseconds");
+
+            result = linc_format_timestamp(
+                ns, timestamp_buffer, sizeof(timestamp_buffer), LINC_TIMESTAMP_NANOSECONDS, LINC_TIMEZONE_UTC);
+            ASSERT_EQUAL(result, 0, "Error in linc_format_timestamp result");
+            ASSERT_STRING_EQUAL("2023-11-14 22:13:20.123456789", timestamp_buffer, "Error formatting nanoseconds");
+
+            result = linc_format_timestamp(ns, timestamp_buffer, 20, LINC_TIMESTAMP_NANOSECONDS, LINC_TIMEZONE_UTC);
+            ASSERT_EQUAL(result, -1, "Error in linc_format_timestamp result with size 20");
+            ASSERT_STRING_EQUAL("2023-11-14 22:13:20", timestamp_buffer, "Error formatting with size 20");
+
+            result = linc_format_timestamp(ns, timestamp_buffer, sizeof(timestamp_buffer), 4, LINC_TIMEZONE_UTC);
+            ASSERT_EQUAL(result, -1, "Error in linc_format_timestamp result with wrong precision");
+        });
+
+        TEST_CASE("Should update the cached second", {
+            int64_t ns = 1700000000999999999LL;
+            int result = linc_timestamp_string(ns, timestamp_buffer, sizeof(timestamp_buffer));
+            ASSERT_EQUAL(result, 0, "Error in linc_timestamp_string result");
+            ASSERT_STRING_EQUAL("2023-11-14 22:13:20.999", timestamp_buffer, "Error formatting first second");
+
+            result = linc_timestamp_string(ns + 1, timestamp_buffer, sizeof(timestamp_buffer));
+            ASSERT_EQUAL(result, 0, "Error in linc_timestamp_string result");
+            ASSERT_STRING_EQUAL("2023-11-14 22:13:21.000", timestamp_buffer, "Error formatting next second");
+
+            result = linc_timestamp_string(ns - 86400000000000LL, timestamp_buffer, sizeof(timestamp_buffer));
+            ASSERT_EQUAL(result, 0, "Error in linc_timestamp_string result");
+            ASSERT_STRING_EQUAL("2023-11-13 22:13:20.999", timestamp_buffer, "Error formatting previous day");
+        });
+
+        TEST_CASE("Should format local time", {
+            setenv("TZ", "UTC-2", 1);
+            tzset();
+            int result = linc_format_timestamp(
+                0, timestamp_buffer, sizeof(timestamp_buffer), LINC_TIMESTAMP_MILLISECONDS, LINC_TIMEZONE_LOCAL);
+            ASSERT_EQUAL(result, 0, "Error in linc_format_timestamp result");
+            ASSERT_STRING_EQUAL("1970-01-01 02:00:00.000", timestamp_buffer, "Error formatting local time");
+
+            result = linc_timestamp_string(0, timestamp_buffer, sizeof(timestamp_buffer));
+            ASSERT_EQUAL(result, 0, "Error in linc_timestamp_string result");
+            ASSERT_STRING_EQUAL("1970-01-01 00:00:00.000", timestamp_buffer, "Error formatting UTC time");
+            unsetenv("TZ");
+            tzset();
+        });
     });
 
     BEFORE_EACH(clean_metadata);
@@ -360,4 +428,40 @@ TEST_RUNNER(title, {
                 "Error formatting with size 50");
         });
     });
+
+    TEST_SUITE("Clock tests", {
+        TEST_CASE("Should follow the realtime clock with every clock", {
+            ASSERT_TRUE(clock_distance() < 5000000, "Error monotonic clock distance");
+
+            int result = linc_set_clock(LINC_CLOCK_COARSE);
+            ASSERT_EQUAL(0, result, "Error coarse clock");
+            ASSERT_TRUE(clock_distance() < 20000000, "Error coarse clock distance");
+
+            result = linc_set_clock(LINC_CLOCK_TSC);
+            if (result == 0) {
+                int64_t previous = linc_timestamp();
+                ASSERT_TRUE(clock_distance() < 5000000, "Error tsc clock distance");
+                ASSERT_TRUE(linc_timestamp() >= previous, "Error tsc clock order");
+            }
+
+            result = linc_set_clock(LINC_CLOCK_MONOTONIC);
+            ASSERT_EQUAL(0, result, "Error monotonic clock");
+            result = linc_set_clock(3);
+            ASSERT_EQUAL(-1, result, "Error invalid clock");
+        });
+    });
+
+    TEST_SUITE("Compile level tests", {
+        TEST_CASE("Should not evaluate logs below the compile level", {
+            linc_set_sink_enabled(linc_default_sink, false);
+            linc_module module = linc_register_module("elided", LINC_LEVEL_TRACE, true);
+            ASSERT_NOT_NULL(module, "Error module");
+            TRACE_M(module, "%d", evaluate());
+            DEBUG_M(module, "%d", evaluate());
+            ASSERT_EQUAL(0, evaluated, "Error elided arguments evaluated");
+            INFO_M(module, "%d", evaluate());
+            FATAL_M(module, "%d", evaluate());
+            ASSERT_EQUAL(2, evaluated, "Error kept arguments not evaluated");
+        });
+    });
 })
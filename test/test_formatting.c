@@ -0,0 +1,167 @@
+#include "linc.h"
+#include "utinc.h"
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define MESSAGES 16
+
+const char *title = "LINC deferred formatting test\n";
+
+struct recording {
+    pthread_mutex_t mutex;
+    int count;
+    char messages[MESSAGES][LINC_DEFAULT_MAX_MESSAGE_LENGTH + LINC_ZERO_CHAR_LENGTH];
+};
+struct recording recording = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+};
+
+char expected[LINC_DEFAULT_MAX_MESSAGE_LENGTH + LINC_ZERO_CHAR_LENGTH];
+char long_string[2 * LINC_DEFAULT_MAX_MESSAGE_LENGTH];
+
+int sink_recording_open(void *data) {
+    (void)data;
+    return 0;
+}
+
+int sink_recording_close(void *data) {
+    (void)data;
+    return 0;
+}
+
+int sink_recording_write(void *data, struct linc_metadata *metadata) {
+    struct recording *recording = (struct recording *)data;
+    pthread_mutex_lock(&recording->mutex);
+    if (recording->count < MESSAGES) {
+        strcpy(recording->messages[recording->count], metadata->message);
+    }
+    recording->count++;
+    pthread_mutex_unlock(&recording->mutex);
+    return 0;
+}
+
+int sink_recording_flush(void *data) {
+    (void)data;
+    return 0;
+}
+
+// Waits up to one second for the worker to deliver the given number of messages.
+int wait_messages(int count) {
+    struct timespec pause = {.tv_sec = 0, .tv_nsec = 1000000};
+    for (int attempt = 0; attempt < 1000; attempt++) {
+        pthread_mutex_lock(&recording.mutex);
+        int current = recording.count;
+        pthread_mutex_unlock(&recording.mutex);
+        if (current >= count) {
+            return current;
+        }
+        nanosleep(&pause, NULL);
+    }
+    return -1;
+}
+
+DEFINE_CALLBACK(recording_sink_init, {
+    linc_set_sink_enabled(linc_default_sink, false);
+    struct linc_sink_funcs recording_funcs;
+    memset(&recording_funcs, 0, sizeof(recording_funcs));
+    recording_funcs.data = &recording;
+    recording_funcs.open = sink_recording_open;
+    recording_funcs.close = sink_recording_close;
+    recording_funcs.write = sink_recording_write;
+    recording_funcs.flush = sink_recording_flush;
+    linc_register_sink("recording", LINC_LEVEL_TRACE, true, recording_funcs);
+    linc_set_formatting(LINC_FORMATTING_DEFERRED);
+    memset(long_string, 'y', sizeof(long_string) - 1);
+})
+
+DEFINE_CALLBACK(recording_sink_clean, {
+    pthread_mutex_lock(&recording.mutex);
+    recording.count = 0;
+    memset(recording.messages, 0, sizeof(recording.messages));
+    pthread_mutex_unlock(&recording.mutex);
+    memset(expected, 0, sizeof(expected));
+})
+
+TEST_RUNNER(title, {
+    BEFORE_ALL(recording_sink_init);
+    BEFORE_EACH(recording_sink_clean);
+
+    TEST_SUITE("Deferred formatting tests", {
+        TEST_CASE("Should format integers like printf", {
+            INFO("%d %i %+05d %-6d| %hhd %hd", -42, 7, 12, 3, (signed char)-5, (short)300);
+            INFO("%u %o %#x %X %lu %lld %llu", 42u, 8u, 255u, 0xABCu, 123456789UL, -9000000000LL, 18000000000ULL);
+            INFO("%jd %ju %zu %td %c%c", (intmax_t)-1, (uintmax_t)2, (size_t)3, (ptrdiff_t)-4, 'o', 'k');
+            ASSERT_EQUAL(3, wait_messages(3), "Error count");
+
+            snprintf(expected, sizeof(expected), "%d %i %+05d %-6d| %hhd %hd", -42, 7, 12, 3, (signed char)-5,
+                     (short)300);
+            ASSERT_STRING_EQUAL(expected, recording.messages[0], "Error int message");
+            snprintf(expected, sizeof(expected), "%u %o %#x %X %lu %lld %llu", 42u, 8u, 255u, 0xABCu, 123456789UL,
+                     -9000000000LL, 18000000000ULL);
+            ASSERT_STRING_EQUAL(expected, recording.messages[1], "Error unsigned message");
+            snprintf(expected, sizeof(expected), "%jd %ju %zu %td %c%c", (intmax_t)-1, (uintmax_t)2, (size_t)3,
+                     (ptrdiff_t)-4, 'o', 'k');
+            ASSERT_STRING_EQUAL(expected, recording.messages[2], "Error typedef message");
+        });
+
+        TEST_CASE("Should format floating points and pointers like printf", {
+            int local = 0;
+            INFO("%f %.2f %e %G %a %Lf", 3.5, 2.345, 12345.678, 0.00001, 1.0, (long double)1.25);
+            INFO("%p %p", (void *)&local, (void *)NULL);
+            ASSERT_EQUAL(2, wait_messages(2), "Error count");
+
+            snprintf(expected, sizeof(expected), "%f %.2f %e %G %a %Lf", 3.5, 2.345, 12345.678, 0.00001, 1.0,
+                     (long double)1.25);
+            ASSERT_STRING_EQUAL(expected, recording.messages[0], "Error double message");
+            snprintf(expected, sizeof(expected), "%p %p", (void *)&local, (void *)NULL);
+            ASSERT_STRING_EQUAL(expected, recording.messages[1], "Error pointer message");
+        });
+
+        TEST_CASE("Should copy strings before they change", {
+            char name[16] = "worker-1";
+            INFO("[%s] [%10s] [%-10s] [%.3s] %% done", name, name, name, name);
+            memset(name, 0, sizeof(name));
+            INFO("[%*d] [%-*.*s] [%.*f]", 6, 42, 8, 2, "abcdef", 1, 2.25);
+            ASSERT_EQUAL(2, wait_messages(2), "Error count");
+
+            ASSERT_STRING_EQUAL("[worker-1] [  worker-1] [worker-1  ] [wor] % done", recording.messages[0],
+                                "Error string message");
+            snprintf(expected, sizeof(expected), "[%*d] [%-*.*s] [%.*f]", 6, 42, 8, 2, "abcdef", 1, 2.25);
+            ASSERT_STRING_EQUAL(expected, recording.messages[1], "Error star message");
+        });
+
+        TEST_CASE("Should truncate messages like vsnprintf", {
+            INFO("%s", long_string);
+            INFO("id %700d end", 7);
+            INFO("%.*s|%s", 3, long_string, "tail");
+            ASSERT_EQUAL(3, wait_messages(3), "Error count");
+
+            memcpy(expected, long_string, LINC_DEFAULT_MAX_MESSAGE_LENGTH);
+            ASSERT_STRING_EQUAL(expected, recording.messages[0], "Error long string message");
+            memset(expected, ' ', LINC_DEFAULT_MAX_MESSAGE_LENGTH);
+            memcpy(expected, "id ", 3);
+            ASSERT_STRING_EQUAL(expected, recording.messages[1], "Error long width message");
+            ASSERT_STRING_EQUAL("yyy|tail", recording.messages[2], "Error precision message");
+        });
+
+        TEST_CASE("Should switch formatting at runtime", {
+            int result = linc_set_formatting(LINC_FORMATTING_EAGER);
+            ASSERT_EQUAL(0, result, "Error result");
+            INFO("eager %d", 1);
+            result = linc_set_formatting(LINC_FORMATTING_DEFERRED);
+            ASSERT_EQUAL(0, result, "Error result");
+            INFO("deferred %d", 2);
+            ASSERT_EQUAL(2, wait_messages(2), "Error count");
+
+            ASSERT_STRING_EQUAL("eager 1", recording.messages[0], "Error eager message");
+            ASSERT_STRING_EQUAL("deferred 2", recording.messages[1], "Error deferred message");
+            result = linc_set_formatting(2);
+            ASSERT_EQUAL(-1, result, "Error result");
+        });
+    });
+})
@@ -0,0 +1,254 @@
+#include "linc.h"
+#include "utinc.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define HTTP_LOGS 100
+#define HTTP_BATCH_BYTES 4096
+
+const char *title = "LINC HTTP sink test\n";
+
+// A local server that answers every request with 200 and keeps the bodies it received, one after the other.
+struct server {
+    int fd;
+    char port[16];
+    bool is_closing;  // Closes the connection after each response
+    bool is_array;    // Every body was a JSON array
+    int requests;
+    int connections;
+    size_t used;
+    char bodies[1 << 20];
+    pthread_mutex_t mutex;
+};
+
+static struct server server = {.fd = -1, .mutex = PTHREAD_MUTEX_INITIALIZER};
+static struct linc_sink_http_options http_options;
+static bool seen[HTTP_LOGS];
+static const struct timespec http_pause = {.tv_sec = 0, .tv_nsec = 500000000};  // Many flush delays
+static const char response[] = "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok";
+
+// Handles the complete request at the start of the buffer of a connection, returns the bytes it used, or 0 if it is
+// not complete yet.
+static size_t serve_request(int fd, char *buffer, size_t used) {
+    char *end = NULL;
+    for (size_t i = 3; i < used && end == NULL; i++) {
+        if (memcmp(buffer + i - 3, "\r\n\r\n", 4) == 0) {
+            end = buffer + i + 1;
+        }
+    }
+    if (end == NULL) {
+        return 0;
+    }
+    *(end - 1) = '\0';
+    const char *length_header = strstr(buffer, "Content-Length: ");
+    size_t length = length_header != NULL ? strtoul(length_header + 16, NULL, 10) : 0;
+    size_t head_length = (size_t)(end - buffer);
+    if (head_length + length > used) {
+        *(end - 1) = '\n';
+        return 0;
+    }
+
+    pthread_mutex_lock(&server.mutex);
+    if (server.used + length < sizeof(server.bodies)) {
+        memcpy(server.bodies + server.used, end, length);
+        server.used += length;
+        server.bodies[server.used] = '\0';
+    }
+    server.is_array &= length > 1 && end[0] == '[' && end[length - 1] == ']';
+    server.requests++;
+    pthread_mutex_unlock(&server.mutex);
+    send(fd, response, sizeof(response) - 1, MSG_NOSIGNAL);
+    return head_length + length;
+}
+
+// Reads the requests of a connection until the client closes it. A closing server stops writing after its first
+// response and only drains the connection, so the client sends the other requests again on a new one.
+static void *serve_connection(void *arg) {
+    int fd = (int)(intptr_t)arg;
+    char buffer[1 << 16];
+    size_t used = 0;
+    bool is_answered = false;
+    ssize_t bytes = 0;
+    while ((bytes = recv(fd, buffer + used, sizeof(buffer) - used, 0)) > 0) {
+        used += (size_t)bytes;
+        size_t handled = 0;
+        while (!is_answered && (handled = serve_request(fd, buffer, used)) > 0) {
+            memmove(buffer, buffer + handled, used - handled);
+            used -= handled;
+            if (server.is_closing) {
+                shutdown(fd, SHUT_WR);
+                is_answered = true;
+            }
+        }
+        if (is_answered) {
+            used = 0;
+        }
+    }
+    close(fd);
+    return NULL;
+}
+
+// Accepts connections, each one is served by its own thread, since sinks keep theirs open.
+static void *serve(void *arg) {
+    (void)arg;
+    while (true) {
+        int fd = accept(server.fd, NULL, NULL);
+        if (fd < 0) {
+            continue;
+        }
+        pthread_mutex_lock(&server.mutex);
+        server.connections++;
+        pthread_mutex_unlock(&server.mutex);
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, serve_connection, (void *)(intptr_t)fd) != 0) {
+            close(fd);
+            continue;
+        }
+        pthread_detach(thread);
+    }
+    return NULL;
+}
+
+// Listens on a port of the loopback interface chosen by the system.
+static int server_start(void) {
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    server.fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (server.fd < 0 || bind(server.fd, (struct sockaddr *)&address, length) < 0 || listen(server.fd, 8) < 0
+        || getsockname(server.fd, (struct sockaddr *)&address, &length) < 0) {
+        return -1;
+    }
+    snprintf(server.port, sizeof(server.port), "%d", ntohs(address.sin_port));
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, serve, NULL) != 0) {
+        return -1;
+    }
+    pthread_detach(thread);
+    return 0;
+}
+
+static void server_reset(bool is_closing) {
+    pthread_mutex_lock(&server.mutex);
+    server.is_closing = is_closing;
+    server.is_array = true;
+    server.requests = 0;
+    server.connections = 0;
+    server.used = 0;
+    server.bodies[0] = '\0';
+    pthread_mutex_unlock(&server.mutex);
+}
+
+// Counts the distinct logs numbered from 0 that the server received.
+static int count_logs(const char *prefix) {
+    char format[64];
+    snprintf(format, sizeof(format), "%s%%d", prefix);
+    memset(seen, 0, sizeof(seen));
+    int count = 0;
+    for (char *log = strstr(server.bodies, prefix); log != NULL; log = strstr(log + 1, prefix)) {
+        int index = -1;
+        sscanf(log, format, &index);
+        if (index >= 0 && index < HTTP_LOGS && !seen[index]) {
+            seen[index] = true;
+            count++;
+        }
+    }
+    return count;
+}
+
+DEFINE_CALLBACK(default_sink_init, {
+    linc_set_sink_enabled(linc_default_sink, false);
+})
+
+TEST_RUNNER(title, {
+    BEFORE_ALL(default_sink_init);
+
+    TEST_SUITE("HTTP sinks tests", {
+        TEST_CASE("Should send batches of logs over one connection", {
+            ASSERT_EQUAL(0, server_start(), "Error starting the server");
+            server_reset(false);
+            http_options.path = "/logs";
+            http_options.batch_size = HTTP_BATCH_BYTES;
+            http_options.flush_delay_us = 20000;
+            struct linc_sink_funcs funcs = linc_sink_http_funcs("127.0.0.1", server.port, &http_options);
+            linc_sink sink = linc_register_sink("http", LINC_LEVEL_TRACE, true, funcs);
+            ASSERT_NOT_NULL(sink, "Error sink");
+
+            for (int i = 0; i < HTTP_LOGS; i++) {
+                INFO("http log %d \"quoted\"", i);
+            }
+            nanosleep(&http_pause, NULL);
+            linc_set_sink_enabled(sink, false);
+
+            pthread_mutex_lock(&server.mutex);
+            ASSERT_EQUAL(HTTP_LOGS, count_logs("http log "), "Error count");
+            ASSERT_TRUE(server.requests > 1 && server.requests < HTTP_LOGS, "Error logs not batched");
+            ASSERT_EQUAL(1, server.connections, "Error connection not kept alive");
+            ASSERT_TRUE(server.is_array, "Error body not a JSON array");
+            ASSERT_NOT_NULL(strstr(server.bodies, "\\\"quoted\\\""), "Error quotes not escaped");
+            pthread_mutex_unlock(&server.mutex);
+        });
+
+        TEST_CASE("Should send the logs again after the server closed the connection", {
+            server_reset(true);
+            http_options.is_ndjson = true;
+            struct linc_sink_funcs funcs = linc_sink_http_funcs("127.0.0.1", server.port, &http_options);
+            linc_sink sink = linc_register_sink("reconnect", LINC_LEVEL_TRACE, true, funcs);
+            ASSERT_NOT_NULL(sink, "Error sink");
+
+            for (int i = 0; i < HTTP_LOGS; i++) {
+                INFO("reconnect log %d", i);
+            }
+            nanosleep(&http_pause, NULL);
+            linc_set_sink_enabled(sink, false);
+
+            pthread_mutex_lock(&server.mutex);
+            ASSERT_EQUAL(HTTP_LOGS, count_logs("reconnect log "), "Error count");
+            ASSERT_EQUAL(server.requests, server.connections, "Error request after the connection was closed");
+            ASSERT_FALSE(server.is_array, "Error body not JSON lines");
+            pthread_mutex_unlock(&server.mutex);
+        });
+
+        TEST_CASE("Should give back the slot of sinks whose registration fails", {
+            int failed = 0;
+            for (int i = 0; i < LINC_DEFAULT_MAX_NETWORK_SINKS + 1; i++) {
+                struct linc_sink_funcs funcs = linc_sink_http_funcs("127.0.0.1", server.port, NULL);
+                failed += linc_register_sink("http", LINC_LEVEL_TRACE, true, funcs) == NULL;
+            }
+            struct linc_sink_funcs funcs = linc_sink_http_funcs("127.0.0.1", server.port, NULL);
+            linc_sink sink = linc_register_sink("fresh", LINC_LEVEL_TRACE, true, funcs);
+            linc_set_sink_enabled(sink, false);
+
+            ASSERT_EQUAL(LINC_DEFAULT_MAX_NETWORK_SINKS + 1, failed, "Error duplicate name");
+            ASSERT_NOT_NULL(sink, "Error fresh sink");
+        });
+
+        TEST_CASE("Should reject invalid HTTP sinks and text that would break the request", {
+            ASSERT_NULL(linc_sink_http_funcs(NULL, "80", NULL).open, "Error NULL host");
+            ASSERT_NULL(linc_sink_http_funcs("127.0.0.1", NULL, NULL).open, "Error NULL port");
+            http_options.path = "logs";
+            ASSERT_NULL(linc_sink_http_funcs("127.0.0.1", "80", &http_options).open, "Error relative path");
+            http_options.path = "/logs HTTP/1.1\r\nX-Injected: 1\r\n";
+            ASSERT_NULL(linc_sink_http_funcs("127.0.0.1", "80", &http_options).open, "Error header in the path");
+            http_options.path = "/two words";
+            ASSERT_NULL(linc_sink_http_funcs("127.0.0.1", "80", &http_options).open, "Error space in the path");
+            ASSERT_NULL(linc_sink_http_funcs("127.0.0.1\r\nX-Injected: 1", "80", NULL).open, "Error host header");
+            ASSERT_NULL(linc_sink_http_funcs("127.0.0.1", "80\n", NULL).open, "Error newline in the port");
+            ASSERT_NULL(linc_sink_http_funcs("", "80", NULL).open, "Error empty host");
+            http_options.path = NULL;
+            http_options.batch_size = LINC_DEFAULT_HTTP_BATCH_BYTES + 1;
+            ASSERT_NULL(linc_sink_http_funcs("127.0.0.1", "80", &http_options).open, "Error too large body");
+        });
+    });
+})
@@ -0,0 +1,145 @@
+#include "linc.h"
+#include "utinc.h"
+
+#include <stdint.h>
+#include <string.h>
+
+const char *title = "LINC layouts test\n";
+
+char layout_buffer[1024];
+char expected_buffer[1024];
+struct linc_metadata metadata;
+
+DEFINE_CALLBACK(clean_metadata, {
+    memset(&metadata, 0, sizeof(metadata));
+    metadata.timestamp = 1757500215000000000;
+    metadata.level = LINC_LEVEL_WARN;
+    metadata.thread_id = 0x0123456789;
+    metadata.module_name = "module";
+    metadata.filename = "test_file.c";
+    metadata.line = 42;
+    metadata.func = "test_function";
+    strcpy(metadata.message, "This is a test message");
+    memset(layout_buffer, 0, sizeof(layout_buffer));
+    memset(expected_buffer, 0, sizeof(expected_buffer));
+})
+
+TEST_RUNNER(title, {
+    BEFORE_EACH(clean_metadata);
+    TEST_SUITE("Built-in layouts tests", {
+        TEST_CASE("Should render the text layouts like linc_stringify_metadata", {
+            int result = linc_layout_render(linc_layout_text, &metadata, layout_buffer, sizeof(layout_buffer));
+            ASSERT_TRUE(result > 0, "Error in linc_layout_render result");
+            linc_stringify_metadata(&metadata, expected_buffer, sizeof(expected_buffer), false);
+            ASSERT_STRING_EQUAL(expected_buffer, layout_buffer, "Error rendering text layout");
+
+            result = linc_layout_render(linc_layout_text_color, &metadata, layout_buffer, sizeof(layout_buffer));
+            ASSERT_TRUE(result > 0, "Error in linc_layout_render result");
+            linc_stringify_metadata(&metadata, expected_buffer, sizeof(expected_buffer), true);
+            ASSERT_STRING_EQUAL(expected_buffer, layout_buffer, "Error rendering colored text layout");
+        });
+
+        TEST_CASE("Should render compiled text patterns like the built-in ones", {
+            linc_layout text = linc_layout_compile("[ %t ] [ %-5l ] [ %i ] [ %-16M ] %f:%n %F: %m\n");
+            ASSERT_NOT_NULL(text, "Error compiling text pattern");
+            linc_layout_render(text, &metadata, layout_buffer, sizeof(layout_buffer));
+            linc_layout_render(linc_layout_text, &metadata, expected_buffer, sizeof(expected_buffer));
+            ASSERT_STRING_EQUAL(expected_buffer, layout_buffer, "Error rendering text pattern");
+
+            linc_layout color = linc_layout_compile(
+                "[ %{bold}%t%{reset} ] [ %{level}%-5l%{reset} ] [ %{bold}%i%{reset} ] [ %{bold}%-16M%{reset} ] "
+                "%{cyan}%f%{reset}:%{yellow}%n%{reset} %{magenta}%F%{reset}: %m\n");
+            ASSERT_NOT_NULL(color, "Error compiling colored text pattern");
+            metadata.level = 9;
+            linc_layout_render(color, &metadata, layout_buffer, sizeof(layout_buffer));
+            linc_layout_render(linc_layout_text_color, &metadata, expected_buffer, sizeof(expected_buffer));
+            ASSERT_STRING_EQUAL(expected_buffer, layout_buffer, "Error rendering colored text pattern");
+        });
+
+        TEST_CASE("Should render the JSON layout", {
+            strcpy(metadata.message, "say \"hi\"\\\n\t\x01");
+            int result = linc_layout_render(linc_layout_json, &metadata, layout_buffer, sizeof(layout_buffer));
+            ASSERT_TRUE(result > 0, "Error in linc_layout_render result");
+            ASSERT_STRING_EQUAL(
+                "{\"timestamp\":\"2025-09-10 10:30:15.000\",\"level\":\"WARN\",\"thread_id\":\"0000000123456789\","
+                "\"module\":\"module\",\"file\":\"test_file.c\",\"line\":42,\"func\":\"test_function\","
+                "\"message\":\"say \\\"hi\\\"\\\\\\n\\t\\u0001\"}\n",
+                layout_buffer,
+                "Error rendering JSON layout");
+        });
+
+        TEST_CASE("Should render the logfmt layout", {
+            int result = linc_layout_render(linc_layout_logfmt, &metadata, layout_buffer, sizeof(layout_buffer));
+            ASSERT_TRUE(result > 0, "Error in linc_layout_render result");
+            ASSERT_STRING_EQUAL(
+                "time=\"2025-09-10 10:30:15.000\" level=WARN thread_id=0000000123456789 module=module "
+                "file=test_file.c line=42 func=test_function message=\"This is a test message\"\n",
+                layout_buffer,
+                "Error rendering logfmt layout");
+
+            strcpy(metadata.message, "done");
+            metadata.module_name = NULL;
+            linc_layout_render(linc_layout_logfmt, &metadata, layout_buffer, sizeof(layout_buffer));
+            ASSERT_STRING_EQUAL(
+                "time=\"2025-09-10 10:30:15.000\" level=WARN thread_id=0000000123456789 module=unknown "
+                "file=test_file.c line=42 func=test_function message=done\n",
+                layout_buffer,
+                "Error rendering unquoted logfmt layout");
+
+            strcpy(metadata.message, "");
+            linc_layout_render(linc_layout_logfmt, &metadata, layout_buffer, sizeof(layout_buffer));
+            ASSERT_TRUE(strstr(layout_buffer, " message=\"\"\n") != NULL, "Error rendering empty logfmt value");
+        });
+    });
+
+    TEST_SUITE("Compiled layouts tests", {
+        TEST_CASE("Should pad and escape fields", {
+            metadata.timestamp = -1500000000;
+            linc_layout layout = linc_layout_compile("%5n|%-5n|%T|%%|%-6l|%3M");
+            ASSERT_NOT_NULL(layout, "Error compiling pattern");
+            int result = linc_layout_render(layout, &metadata, layout_buffer, sizeof(layout_buffer));
+            ASSERT_EQUAL(39, result, "Error in linc_layout_render result");
+            ASSERT_STRING_EQUAL(
+                "   42|42   |-1500000000|%|WARN  |module", layout_buffer, "Error rendering padded fields");
+        });
+
+        TEST_CASE("Should reject invalid patterns", {
+            ASSERT_NULL(linc_layout_compile(NULL), "Error compiling NULL pattern");
+            ASSERT_NULL(linc_layout_compile("%x"), "Error compiling unknown field");
+            ASSERT_NULL(linc_layout_compile("%"), "Error compiling trailing percent");
+            ASSERT_NULL(linc_layout_compile("%{purple}%m"), "Error compiling unknown color");
+            ASSERT_NULL(linc_layout_compile("%{bold%m"), "Error compiling unterminated color");
+            ASSERT_NULL(linc_layout_compile("%j10m"), "Error compiling escaped field with a width");
+            ASSERT_NULL(linc_layout_compile("%99999m"), "Error compiling field wider than the maximum");
+            memset(expected_buffer, 'x', LINC_DEFAULT_LAYOUT_LITERALS_LENGTH + 1);
+            ASSERT_NULL(linc_layout_compile(expected_buffer), "Error compiling too long constant text");
+        });
+
+        TEST_CASE("Should truncate like snprintf", {
+            linc_layout layout = linc_layout_compile("%l: %m");
+            ASSERT_NOT_NULL(layout, "Error compiling pattern");
+            int result = linc_layout_render(layout, &metadata, layout_buffer, 10);
+            ASSERT_EQUAL(-1, result, "Error in linc_layout_render result with size 10");
+            ASSERT_STRING_EQUAL("WARN: Thi", layout_buffer, "Error truncating output");
+
+            result = linc_layout_render(layout, &metadata, layout_buffer, 0);
+            ASSERT_EQUAL(-1, result, "Error in linc_layout_render result with zero size");
+            result = linc_layout_render(NULL, &metadata, layout_buffer, sizeof(layout_buffer));
+            ASSERT_EQUAL(-1, result, "Error in linc_layout_render result with NULL layout");
+
+            metadata.module_name = "";
+            result = linc_layout_render(layout, &metadata, layout_buffer, sizeof(layout_buffer));
+            ASSERT_TRUE(result > 0, "Error in linc_layout_render result with unused invalid module");
+            result = linc_layout_render(linc_layout_json, &metadata, layout_buffer, sizeof(layout_buffer));
+            ASSERT_EQUAL(-1, result, "Error in linc_layout_render result with invalid module");
+        });
+
+        TEST_CASE("Should stop compiling when every layout is used", {
+            int compiled = 0;
+            while (linc_layout_compile("%m") != NULL) {
+                compiled++;
+            }
+            ASSERT_TRUE(compiled < LINC_DEFAULT_MAX_LAYOUTS, "Error in number of compiled layouts");
+        });
+    });
+})
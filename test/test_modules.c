@@ -43,11 +43,17 @@ int sink_in_memory_flush(void *data) {
 }
 
 linc_module modules[LINC_DEFAULT_MAX_MODULES];
+int evaluated = 0;
+
+int evaluate(void) {
+    return ++evaluated;
+}
 
 DEFINE_CALLBACK(in_memory_sink_init, {
     modules[0] = linc_default_module;
     linc_set_sink_enabled(linc_default_sink, false);
     struct linc_sink_funcs in_memory_funcs;
+    memset(&in_memory_funcs, 0, sizeof(in_memory_funcs));
     in_memory_funcs.data = &in_memory;
     in_memory_funcs.open = sink_in_memory_open;
     in_memory_funcs.close = sink_in_memory_close;
@@ -173,6 +179,44 @@ TEST_RUNNER(title, {
             ASSERT_EQUAL(2, in_memory.count, "Error count");
         });
 
+        TEST_CASE("Should not evaluate arguments of filtered logs", {
+            evaluated = 0;
+            TRACE_M(modules[1], "Filtered log %d", evaluate());
+            ASSERT_EQUAL(0, evaluated, "Error filtered level evaluated");
+            DEBUG_M(modules[1], "Accepted log %d", evaluate());
+            ASSERT_EQUAL(1, evaluated, "Error accepted level not evaluated");
+
+            int result = linc_set_module_enabled(modules[1], false);
+            ASSERT_EQUAL(0, result, "Error result");
+            FATAL_M(modules[1], "Disabled log %d", evaluate());
+            ASSERT_EQUAL(1, evaluated, "Error disabled module evaluated");
+            ASSERT_TRUE(!linc_is_enabled(modules[1], LINC_LEVEL_FATAL), "Error disabled module");
+            ASSERT_TRUE(!linc_is_enabled(NULL, LINC_LEVEL_FATAL), "Error null module");
+
+            result = linc_set_module_enabled(modules[1], true);
+            ASSERT_EQUAL(0, result, "Error result");
+            result = linc_set_module_level(modules[1], LINC_LEVEL_TRACE);
+            ASSERT_EQUAL(0, result, "Error result");
+            TRACE_M(modules[1], "Accepted log %d", evaluate());
+            ASSERT_EQUAL(2, evaluated, "Error lowered level not evaluated");
+            sleep(1);
+            ASSERT_EQUAL(2, in_memory.count, "Error count");
+        });
+
+        TEST_CASE("Should keep the level of a disabled module", {
+            int result = linc_set_module_enabled(modules[1], false);
+            ASSERT_EQUAL(0, result, "Error result");
+            result = linc_set_module_level(modules[1], LINC_LEVEL_WARN);
+            ASSERT_EQUAL(0, result, "Error result");
+            ASSERT_TRUE(!linc_is_enabled(modules[1], LINC_LEVEL_FATAL), "Error disabled module");
+
+            result = linc_set_module_enabled(modules[1], true);
+            ASSERT_EQUAL(0, result, "Error result");
+            ASSERT_TRUE(!linc_is_enabled(modules[1], LINC_LEVEL_INFO), "Error level below the minimum");
+            ASSERT_TRUE(linc_is_enabled(modules[1], LINC_LEVEL_WARN), "Error level at the minimum");
+            ASSERT_TRUE(linc_is_enabled(modules[1], LINC_LEVEL_FATAL), "Error level above the minimum");
+        });
+
         TEST_CASE("Should not register a new module", {
             linc_module wrong_module = linc_register_module("new_module", LINC_LEVEL_INFO, true);
             ASSERT_NULL(wrong_module, "Error wrong module");
@@ -0,0 +1,200 @@
+#include "internal/recovery.h"
+#include "internal/shared.h"
+#include "linc.h"
+#include "utinc.h"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define RECOVERY_LOGS 5
+#define RECOVER_TOOL "build/binaries/tools/linc-recover"
+
+const char *title = "LINC crash recovery test\n";
+
+static struct linc_signal child_signal;
+static struct linc_signal moved_signal;
+static struct linc_ring_buffer moved_ring;
+static struct linc_recovery_reader reader;
+static struct linc_metadata recovered;
+static char recovered_lines[RECOVERY_LOGS][1024];
+static char expected_message[256];
+static char crash_text[65536];
+static char ring_path[] = "/tmp/linc_test_ring_XXXXXX";
+static char crash_path[] = "/tmp/linc_test_crash_XXXXXX";
+static char output_path[] = "/tmp/linc_test_output_XXXXXX";
+static char moved_path[64];
+static unsigned char not_a_ring[LINC_RECOVERY_HEADER_BYTES];
+
+// Places the shared ring in the file, logs and crashes. The child has no worker thread, so the records stay in the
+// ring, as if the worker had not taken them yet.
+static void crash_child(int crash_fd) {
+    linc_signal_init(&child_signal);
+    if (linc_recovery_map(&linc.ring_buffer, ring_path, LINC_DEFAULT_RING_BUFFER_BYTES, &child_signal) < 0
+        || linc_set_crash_handler(crash_fd) < 0) {
+        _exit(1);
+    }
+    for (int i = 0; i < RECOVERY_LOGS; i++) {
+        WARN("recovery log %d", i);
+    }
+    raise(SIGSEGV);
+    _exit(2);
+}
+
+// Logs and crashes in a child, returns its pid once it was killed by the signal, or -1.
+static pid_t crash(int crash_fd) {
+    pid_t child = fork();
+    if (child == 0) {
+        crash_child(crash_fd);
+    }
+    int wait_status = 0;
+    if (child < 0 || waitpid(child, &wait_status, 0) < 0 || !WIFSIGNALED(wait_status)
+        || WTERMSIG(wait_status) != SIGSEGV) {
+        return -1;
+    }
+    return child;
+}
+
+// Reads the records left in the ring file into the recovered lines, returns their number or -1.
+static int recover_all(const char *path) {
+    int fd = open(path, O_RDONLY);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) < 0) {
+        return -1;
+    }
+    void *data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED || linc_recovery_open(&reader, data, (size_t)info.st_size) < 0) {
+        return -1;
+    }
+    int count = 0;
+    int status = 0;
+    while ((status = linc_recovery_next(&reader, &recovered)) > 0 && count < RECOVERY_LOGS) {
+        snprintf(expected_message, sizeof(expected_message), "recovery log %d", count);
+        if (strcmp(recovered.message, expected_message) != 0 || strcmp(recovered.func, "crash_child") != 0) {
+            status = -1;
+            break;
+        }
+        linc_stringify_metadata(&recovered, recovered_lines[count], sizeof(recovered_lines[count]), false);
+        count++;
+    }
+    munmap(data, (size_t)info.st_size);
+    return status < 0 ? -1 : count;
+}
+
+// Runs linc-recover on the ring file with LINC_RING_FILE naming it too, as in a shell that still exports it, and
+// writes what it prints to the output file. Returns the exit status of the tool, or -1.
+static int run_recover(int output_fd) {
+    pid_t child = fork();
+    if (child == 0) {
+        setenv(LINC_RECOVERY_VARIABLE, ring_path, 1);
+        dup2(output_fd, STDOUT_FILENO);
+        execl(RECOVER_TOOL, "linc-recover", ring_path, (char *)NULL);
+        _exit(127);
+    }
+    int wait_status = 0;
+    if (child < 0 || waitpid(child, &wait_status, 0) < 0 || !WIFEXITED(wait_status)) {
+        return -1;
+    }
+    return WEXITSTATUS(wait_status);
+}
+
+// Maps the ring file in a child while this process holds it, returns 0 if the child was refused the file.
+static int map_in_child(void) {
+    pid_t child = fork();
+    if (child == 0) {
+        linc_signal_init(&child_signal);
+        _exit(linc_recovery_map(&moved_ring, ring_path, LINC_DEFAULT_RING_BUFFER_BYTES, &child_signal) < 0 ? 0 : 1);
+    }
+    int wait_status = 0;
+    if (child < 0 || waitpid(child, &wait_status, 0) < 0 || !WIFEXITED(wait_status)) {
+        return -1;
+    }
+    return WEXITSTATUS(wait_status);
+}
+
+TEST_RUNNER(title, {
+    TEST_SUITE("Crash recovery tests", {
+        TEST_CASE("Should recover the records of a crashed process", {
+            int ring_fd = mkstemp(ring_path);
+            int crash_fd = mkstemp(crash_path);
+            ASSERT_TRUE(ring_fd >= 0 && crash_fd >= 0, "Error mkstemp");
+            close(ring_fd);
+
+            ASSERT_TRUE(crash(crash_fd) > 0, "Error child not killed by the signal");
+            ASSERT_EQUAL(RECOVERY_LOGS, recover_all(ring_path), "Error records recovered from the ring file");
+            ASSERT_TRUE(strstr(recovered_lines[0], "[ WARN  ]") != NULL, "Error level of a recovered record");
+
+            ssize_t length = pread(crash_fd, crash_text, sizeof(crash_text) - 1, 0);
+            close(crash_fd);
+            unlink(ring_path);
+            unlink(crash_path);
+            ASSERT_TRUE(length > 0, "Error reading the crash file");
+            crash_text[length] = '\0';
+            size_t offset = 0;
+            for (int i = 0; i < RECOVERY_LOGS; i++) {
+                size_t line_length = strlen(recovered_lines[i]);
+                ASSERT_TRUE(strncmp(crash_text + offset, recovered_lines[i], line_length) == 0,
+                            "Error line written by the crash handler");
+                offset += line_length;
+            }
+            ASSERT_EQUAL((size_t)length, offset, "Error length of the crash file");
+        });
+
+        TEST_CASE("Should print the records with linc-recover while LINC_RING_FILE is set", {
+            int crash_fd = open("/dev/null", O_WRONLY);
+            int output_fd = mkstemp(output_path);
+            ASSERT_TRUE(crash_fd >= 0 && output_fd >= 0, "Error opening the files");
+            ASSERT_TRUE(crash(crash_fd) > 0, "Error child not killed by the signal");
+            close(crash_fd);
+
+            int status = run_recover(output_fd);
+            ssize_t length = pread(output_fd, crash_text, sizeof(crash_text) - 1, 0);
+            close(output_fd);
+            unlink(output_path);
+            ASSERT_EQUAL(0, status, "Error exit status of linc-recover");
+            ASSERT_TRUE(length > 0, "Error reading the output of linc-recover");
+            crash_text[length] = '\0';
+            int lines = 0;
+            for (const char *line = strchr(crash_text, '\n'); line != NULL; line = strchr(line + 1, '\n')) {
+                lines++;
+            }
+            ASSERT_EQUAL(RECOVERY_LOGS, lines, "Error lines printed by linc-recover");
+            ASSERT_NOT_NULL(strstr(crash_text, "recovery log 4"), "Error last record printed by linc-recover");
+            int left = recover_all(ring_path);
+            unlink(ring_path);
+            ASSERT_EQUAL(RECOVERY_LOGS, left, "Error records left in the ring file");
+        });
+
+        TEST_CASE("Should move aside a ring file holding records and refuse a live one", {
+            int crash_fd = open("/dev/null", O_WRONLY);
+            ASSERT_TRUE(crash_fd >= 0, "Error opening /dev/null");
+            pid_t child = crash(crash_fd);
+            close(crash_fd);
+            ASSERT_TRUE(child > 0, "Error child not killed by the signal");
+            snprintf(moved_path, sizeof(moved_path), "%s.%ld", ring_path, (long)child);
+
+            linc_signal_init(&moved_signal);
+            int status = linc_recovery_map(&moved_ring, ring_path, LINC_DEFAULT_RING_BUFFER_BYTES, &moved_signal);
+            int refused = map_in_child();
+            int moved = recover_all(moved_path);
+            unlink(ring_path);
+            unlink(moved_path);
+            ASSERT_EQUAL(0, status, "Error mapping the ring file again");
+            ASSERT_EQUAL(RECOVERY_LOGS, moved, "Error records of the file moved aside");
+            ASSERT_EQUAL(0, refused, "Error ring file of a running process mapped");
+        });
+
+        TEST_CASE("Should reject files that are not ring files", {
+            ASSERT_EQUAL(-1, linc_recovery_open(&reader, not_a_ring, sizeof(not_a_ring)), "Error empty header");
+            ASSERT_EQUAL(-1, linc_recovery_open(&reader, not_a_ring, 16), "Error short file");
+            ASSERT_EQUAL(-1, linc_set_crash_handler(-1), "Error crash handler without a file descriptor");
+        });
+    });
+})
@@ -0,0 +1,328 @@
+#include "linc.h"
+#include "utinc.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define STREAM_LOGS 100
+#define FILE_LOGS 100
+#define ROTATION_MAX_SIZE 1024
+
+const char *title = "LINC sinks test\n";
+
+static char output[65536];
+static char padding[301];  // Makes some lines larger than a slice of an asynchronous sink
+static struct linc_sink_file_options file_options;
+static struct linc_sink_rotation_options rotation_options;
+static struct linc_sink_mmap_options mmap_options;
+static const struct timespec file_pause = {.tv_sec = 0, .tv_nsec = 500000000};  // Many times the flush delay
+
+// Reads everything from the file descriptor into output, after the bytes already used, and returns the bytes used.
+static size_t read_output(int fd, size_t used) {
+    ssize_t bytes = 0;
+    while ((bytes = read(fd, output + used, sizeof(output) - 1 - used)) > 0) {
+        used += (size_t)bytes;
+    }
+    output[used] = '\0';
+    return used;
+}
+
+// Reads the rotated files of the path in order, then the path itself, into output, and deletes them. Returns the
+// number of rotated files, or -1 if one is larger than the maximum size.
+static int read_rotated(const char *path, size_t max_size) {
+    char rotated[512];
+    size_t used = 0;
+    int count = 0;
+    bool is_too_large = false;
+    while (true) {
+        snprintf(rotated, sizeof(rotated), "%s.%d", path, count + 1);
+        int fd = open(rotated, O_RDONLY);
+        if (fd < 0) {
+            break;
+        }
+        size_t start = used;
+        used = read_output(fd, used);
+        is_too_large |= used - start > max_size;
+        close(fd);
+        unlink(rotated);
+        count++;
+    }
+    int fd = open(path, O_RDONLY);
+    if (fd >= 0) {
+        read_output(fd, used);
+        close(fd);
+        unlink(path);
+    }
+    return is_too_large ? -1 : count;
+}
+
+// Counts the lines of output with the prefix, and how many of them are not numbered in order.
+static int count_lines(const char *prefix, int *out_of_order) {
+    char format[64];
+    snprintf(format, sizeof(format), "%s%%d", prefix);
+    int count = 0;
+    *out_of_order = 0;
+    for (char *line = strstr(output, prefix); line != NULL; line = strstr(line + 1, prefix)) {
+        int index = -1;
+        sscanf(line, format, &index);
+        *out_of_order += index != count;
+        count++;
+    }
+    return count;
+}
+
+DEFINE_CALLBACK(default_sink_init, {
+    linc_set_sink_enabled(linc_default_sink, false);
+})
+
+TEST_RUNNER(title, {
+    BEFORE_ALL(default_sink_init);
+
+    TEST_SUITE("Stream sinks tests", {
+        TEST_CASE("Should write every line of a batch to a pipe", {
+            int pipe_fds[2];
+            ASSERT_EQUAL(0, pipe(pipe_fds), "Error pipe");
+            fflush(stdout);
+            int saved_stdout = dup(STDOUT_FILENO);
+            dup2(pipe_fds[1], STDOUT_FILENO);
+            linc_sink sink = linc_register_sink("stdout", LINC_LEVEL_TRACE, true, linc_sink_stdout_funcs());
+            linc_set_sink_batch(sink, LINC_DEFAULT_BATCH_SIZE, 10000);
+
+            for (int i = 0; i < STREAM_LOGS; i++) {
+                INFO("stream log %d", i);
+            }
+            sleep(1);
+            linc_set_sink_enabled(sink, false);
+            dup2(saved_stdout, STDOUT_FILENO);
+            close(saved_stdout);
+            close(pipe_fds[1]);
+
+            read_output(pipe_fds[0], 0);
+            close(pipe_fds[0]);
+
+            int out_of_order = 0;
+            int count = count_lines("stream log ", &out_of_order);
+            ASSERT_NOT_NULL(sink, "Error sink");
+            ASSERT_EQUAL(STREAM_LOGS, count, "Error count");
+            ASSERT_EQUAL(0, out_of_order, "Error order");
+            ASSERT_NULL(strstr(output, "\x1b["), "Error colors on a pipe");
+        });
+
+        TEST_CASE("Should reject a second sink on stdout", {
+            linc_sink sink = linc_register_sink("stdout_again", LINC_LEVEL_TRACE, true, linc_sink_stdout_funcs());
+            ASSERT_NULL(sink, "Error second stdout sink");
+        });
+    });
+
+    TEST_SUITE("File sinks tests", {
+        TEST_CASE("Should write buffered logs once the flush delay passed", {
+            char path[] = "/tmp/linc_test_file_XXXXXX";
+            int fd = mkstemp(path);
+            ASSERT_TRUE(fd >= 0, "Error mkstemp");
+            file_options.buffer_size = 65536;
+            file_options.flush_delay_us = 20000;
+            struct linc_sink_funcs funcs = linc_sink_file_funcs(path, &file_options);
+            linc_sink sink = linc_register_sink("file", LINC_LEVEL_TRACE, true, funcs);
+            ASSERT_NOT_NULL(sink, "Error sink");
+
+            for (int i = 0; i < FILE_LOGS; i++) {
+                INFO("file log %d", i);
+            }
+            nanosleep(&file_pause, NULL);
+            read_output(fd, 0);
+            close(fd);
+            unlink(path);
+            linc_set_sink_enabled(sink, false);
+
+            int out_of_order = 0;
+            int count = count_lines("file log ", &out_of_order);
+            ASSERT_EQUAL(FILE_LOGS, count, "Error count");
+            ASSERT_EQUAL(0, out_of_order, "Error order");
+        });
+
+        TEST_CASE("Should write asynchronous logs in order", {
+            char path[] = "/tmp/linc_test_async_XXXXXX";
+            int fd = mkstemp(path);
+            ASSERT_TRUE(fd >= 0, "Error mkstemp");
+            file_options.buffer_size = 1024;
+            file_options.flush_delay_us = 20000;
+            file_options.is_async = true;
+            struct linc_sink_funcs funcs = linc_sink_file_funcs(path, &file_options);
+            file_options.is_async = false;
+            linc_sink sink = linc_register_sink("async", LINC_LEVEL_TRACE, true, funcs);
+            ASSERT_NOT_NULL(sink, "Error sink");
+
+            memset(padding, 'x', sizeof(padding) - 1);
+            for (int i = 0; i < FILE_LOGS; i++) {
+                INFO("async log %d %s", i, i % 10 == 0 ? padding : "");
+            }
+            nanosleep(&file_pause, NULL);
+            read_output(fd, 0);
+            close(fd);
+            unlink(path);
+            linc_set_sink_enabled(sink, false);
+
+            int out_of_order = 0;
+            int count = count_lines("async log ", &out_of_order);
+            ASSERT_EQUAL(FILE_LOGS, count, "Error count");
+            ASSERT_EQUAL(0, out_of_order, "Error order");
+            ASSERT_NOT_NULL(strstr(output, padding), "Error large line");
+        });
+
+        TEST_CASE("Should reject files that cannot be opened", {
+            ASSERT_NULL(linc_sink_file_funcs(NULL, NULL).open, "Error NULL path");
+            file_options.buffer_size = LINC_DEFAULT_FILE_BUFFER_BYTES + 1;
+            ASSERT_NULL(linc_sink_file_funcs("/tmp/linc.log", &file_options).open, "Error too large buffer");
+            linc_sink sink = linc_register_sink("missing", LINC_LEVEL_TRACE, true, linc_sink_file_funcs(NULL, NULL));
+            ASSERT_NULL(sink, "Error registering an empty sink");
+            struct linc_sink_funcs funcs = linc_sink_file_funcs("/nonexistent/linc.log", NULL);
+            ASSERT_NULL(linc_register_sink("missing", LINC_LEVEL_TRACE, true, funcs), "Error missing directory");
+        });
+    });
+
+    TEST_SUITE("Rotating file sinks tests", {
+        TEST_CASE("Should keep every line in order across rotated files", {
+            char directory[] = "/tmp/linc_test_rotation_XXXXXX";
+            ASSERT_NOT_NULL(mkdtemp(directory), "Error mkdtemp");
+            char path[64];
+            snprintf(path, sizeof(path), "%s/app.log", directory);
+            file_options.buffer_size = 0;
+            file_options.flush_delay_us = 20000;
+            rotation_options.max_size = ROTATION_MAX_SIZE;
+            struct linc_sink_funcs funcs = linc_sink_rotating_funcs(path, &file_options, &rotation_options);
+            linc_sink sink = linc_register_sink("rotating", LINC_LEVEL_TRACE, true, funcs);
+            ASSERT_NOT_NULL(sink, "Error sink");
+
+            for (int i = 0; i < FILE_LOGS; i++) {
+                INFO("rotated log %d", i);
+            }
+            nanosleep(&file_pause, NULL);
+            linc_set_sink_enabled(sink, false);
+            int rotated = read_rotated(path, ROTATION_MAX_SIZE);
+            rmdir(directory);
+
+            int out_of_order = 0;
+            int count = count_lines("rotated log ", &out_of_order);
+            ASSERT_TRUE(rotated > 1, "Error number of rotated files");
+            ASSERT_EQUAL(FILE_LOGS, count, "Error count");
+            ASSERT_EQUAL(0, out_of_order, "Error order");
+        });
+
+        TEST_CASE("Should compress rotated files and keep the newest ones", {
+            char directory[] = "/tmp/linc_test_rotation_XXXXXX";
+            ASSERT_NOT_NULL(mkdtemp(directory), "Error mkdtemp");
+            char path[64];
+            snprintf(path, sizeof(path), "%s/app.log", directory);
+            rotation_options.max_size = ROTATION_MAX_SIZE;
+            rotation_options.max_files = 2;
+            rotation_options.is_compressed = true;
+            struct linc_sink_funcs funcs = linc_sink_rotating_funcs(path, &file_options, &rotation_options);
+            linc_sink sink = linc_register_sink("compressed", LINC_LEVEL_TRACE, true, funcs);
+            ASSERT_NOT_NULL(sink, "Error sink");
+
+            for (int i = 0; i < FILE_LOGS; i++) {
+                INFO("compressed log %d", i);
+            }
+            nanosleep(&file_pause, NULL);
+            nanosleep(&file_pause, NULL);
+            linc_set_sink_enabled(sink, false);
+
+            int rotated = 0;
+            int compressed = 0;
+            DIR *dir = opendir(directory);
+            ASSERT_NOT_NULL(dir, "Error opendir");
+            for (struct dirent *entry = readdir(dir); entry != NULL; entry = readdir(dir)) {
+                char name[512];
+                snprintf(name, sizeof(name), "%s/%s", directory, entry->d_name);
+                if (strncmp(entry->d_name, "app.log.", 8) == 0) {
+                    rotated++;
+                    compressed += strstr(entry->d_name, ".gz") != NULL;
+                }
+                if (entry->d_name[0] != '.') {
+                    unlink(name);
+                }
+            }
+            closedir(dir);
+            rmdir(directory);
+            ASSERT_EQUAL(2, rotated, "Error number of rotated files kept");
+            ASSERT_EQUAL(2, compressed, "Error number of compressed files");
+        });
+
+        TEST_CASE("Should reject rotating sinks without rotation options", {
+            ASSERT_NULL(linc_sink_rotating_funcs("/tmp/linc.log", NULL, NULL).open, "Error NULL rotation");
+        });
+
+        TEST_CASE("Should reject compressed rotating sinks without gzip", {
+            char saved_path[4096];
+            snprintf(saved_path, sizeof(saved_path), "%s", getenv("PATH") != NULL ? getenv("PATH") : "");
+            setenv("PATH", "/nonexistent", 1);
+            rotation_options.is_compressed = true;
+            struct linc_sink_funcs funcs = linc_sink_rotating_funcs("/tmp/linc.log", NULL, &rotation_options);
+            setenv("PATH", saved_path, 1);
+            ASSERT_NULL(funcs.open, "Error compression without gzip");
+        });
+    });
+
+    TEST_SUITE("Memory-mapped sinks tests", {
+        TEST_CASE("Should copy lines into segments and truncate the unused tail", {
+            char path[] = "/tmp/linc_test_mmap_XXXXXX";
+            int fd = mkstemp(path);
+            ASSERT_TRUE(fd >= 0, "Error mkstemp");
+            mmap_options.segment_size = 4096;
+            struct linc_sink_funcs mapped = linc_sink_mmap_funcs(path, &mmap_options);
+            linc_sink sink = linc_register_sink("mmap", LINC_LEVEL_TRACE, true, mapped);
+            ASSERT_NOT_NULL(sink, "Error sink");
+
+            for (int i = 0; i < FILE_LOGS; i++) {
+                INFO("mapped log %d", i);
+            }
+            nanosleep(&file_pause, NULL);
+            linc_set_sink_enabled(sink, false);
+            struct stat st;
+            fstat(fd, &st);
+            read_output(fd, 0);
+            ASSERT_TRUE(st.st_size > 4096, "Error segment growth");
+            ASSERT_EQUAL(0, (int)(st.st_size % 4096), "Error preallocated segment");
+
+            // Closing a second sink would truncate the file under the mapping of the first one.
+            struct linc_sink_funcs shared = linc_sink_mmap_funcs(path, &mmap_options);
+            linc_sink second = linc_register_sink("mmap again", LINC_LEVEL_TRACE, true, shared);
+            close(fd);
+            unlink(path);
+
+            int out_of_order = 0;
+            int count = count_lines("mapped log ", &out_of_order);
+            ASSERT_NULL(second, "Error second sink on the same file");
+            ASSERT_EQUAL(FILE_LOGS, count, "Error count");
+            ASSERT_EQUAL(0, out_of_order, "Error order");
+        });
+
+        TEST_CASE("Should find the end of the lines of a file left by a crash and truncate it there", {
+            char path[] = "/tmp/linc_test_mmap_XXXXXX";
+            int fd = mkstemp(path);
+            ASSERT_TRUE(fd >= 0, "Error mkstemp");
+            const char lines[] = "first line\nsecond line\n";
+            ASSERT_EQUAL((int)sizeof(lines) - 1, (int)write(fd, lines, sizeof(lines) - 1), "Error write");
+            ASSERT_EQUAL(0, ftruncate(fd, 4096), "Error preallocated tail");
+
+            // The sink starts after the last line and cuts the zero bytes left after the lines it writes.
+            struct linc_sink_funcs funcs = linc_sink_mmap_funcs(path, &mmap_options);
+            int opened = funcs.open(funcs.data);
+            int reopened = funcs.open(funcs.data);
+            funcs.close(funcs.data);
+            struct stat st;
+            fstat(fd, &st);
+            close(fd);
+            unlink(path);
+            ASSERT_EQUAL(0, opened, "Error opening");
+            ASSERT_EQUAL(-1, reopened, "Error opening twice");
+            ASSERT_EQUAL((int)sizeof(lines) - 1, (int)st.st_size, "Error truncating the tail");
+        });
+    });
+})
@@ -0,0 +1,148 @@
+#include "linc.h"
+#include "utinc.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define SYSLOG_LOGS 100
+#define SYSLOG_MIN_DATAGRAM 480
+
+const char *title = "LINC syslog sink test\n";
+
+static char output[131072];
+static char padding[301];  // Makes every log longer than the smallest datagram
+static struct linc_sink_syslog_options syslog_options;
+static const struct timeval syslog_timeout = {.tv_sec = 0, .tv_usec = 500000};  // Many times the flush delay
+
+// Reads datagrams into output, one per line, until none arrived for the timeout, and returns their number. The sink
+// thread may be waiting on a full Unix socket meanwhile. The largest size is stored in `max_length`.
+static int read_datagrams(int fd, size_t *max_length) {
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &syslog_timeout, sizeof(syslog_timeout));
+    size_t used = 0;
+    int count = 0;
+    ssize_t bytes = 0;
+    *max_length = 0;
+    while ((bytes = recv(fd, output + used, sizeof(output) - 2 - used, 0)) > 0) {
+        *max_length = (size_t)bytes > *max_length ? (size_t)bytes : *max_length;
+        used += (size_t)bytes;
+        output[used++] = '\n';
+        count++;
+    }
+    output[used] = '\0';
+    return count;
+}
+
+// Counts the lines of output with the prefix, and how many of them are not numbered in order.
+static int count_lines(const char *prefix, int *out_of_order) {
+    char format[64];
+    snprintf(format, sizeof(format), "%s%%d", prefix);
+    int count = 0;
+    *out_of_order = 0;
+    for (char *line = strstr(output, prefix); line != NULL; line = strstr(line + 1, prefix)) {
+        int index = -1;
+        sscanf(line, format, &index);
+        *out_of_order += index != count;
+        count++;
+    }
+    return count;
+}
+
+DEFINE_CALLBACK(default_sink_init, {
+    linc_set_sink_enabled(linc_default_sink, false);
+})
+
+TEST_RUNNER(title, {
+    BEFORE_ALL(default_sink_init);
+
+    TEST_SUITE("Syslog sinks tests", {
+        TEST_CASE("Should send RFC 5424 datagrams to a UDP receiver", {
+            struct sockaddr_in address;
+            memset(&address, 0, sizeof(address));
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            socklen_t length = sizeof(address);
+            int fd = socket(AF_INET, SOCK_DGRAM, 0);
+            ASSERT_EQUAL(0, bind(fd, (struct sockaddr *)&address, length), "Error bind");
+            ASSERT_EQUAL(0, getsockname(fd, (struct sockaddr *)&address, &length), "Error getsockname");
+            char port[16];
+            snprintf(port, sizeof(port), "%d", ntohs(address.sin_port));
+            syslog_options.app_name = "linc test";
+            struct linc_sink_funcs funcs = linc_sink_syslog_funcs("127.0.0.1", port, &syslog_options);
+            linc_sink sink = linc_register_sink("syslog", LINC_LEVEL_TRACE, true, funcs);
+            ASSERT_NOT_NULL(sink, "Error sink");
+
+            for (int i = 0; i < SYSLOG_LOGS; i++) {
+                INFO("syslog log %d", i);
+            }
+            size_t max_length = 0;
+            int datagrams = read_datagrams(fd, &max_length);
+            linc_set_sink_enabled(sink, false);
+            close(fd);
+
+            int out_of_order = 0;
+            int count = count_lines("syslog log ", &out_of_order);
+            ASSERT_EQUAL(SYSLOG_LOGS, datagrams, "Error datagrams");
+            ASSERT_EQUAL(SYSLOG_LOGS, count, "Error count");
+            ASSERT_EQUAL(0, out_of_order, "Error order");
+            ASSERT_TRUE(strncmp(output, "<14>1 ", 6) == 0, "Error priority and version");
+            ASSERT_TRUE(output[16] == 'T' && output[32] == 'Z', "Error timestamp");
+            ASSERT_NOT_NULL(strstr(output, " linctest "), "Error APP-NAME");
+            ASSERT_NOT_NULL(strstr(output, " - syslog log 0\n"), "Error MSGID and MSG");
+        });
+
+        TEST_CASE("Should cut datagrams sent to a Unix socket", {
+            char path[] = "/tmp/linc_test_syslog_XXXXXX";
+            close(mkstemp(path));
+            unlink(path);
+            struct sockaddr_un address;
+            memset(&address, 0, sizeof(address));
+            address.sun_family = AF_UNIX;
+            strcpy(address.sun_path, path);
+            int fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+            ASSERT_EQUAL(0, bind(fd, (struct sockaddr *)&address, sizeof(address)), "Error bind");
+            syslog_options.max_datagram = SYSLOG_MIN_DATAGRAM;
+            syslog_options.layout = linc_layout_text;
+            struct linc_sink_funcs funcs = linc_sink_syslog_funcs(path, NULL, &syslog_options);
+            linc_sink sink = linc_register_sink("dev log", LINC_LEVEL_TRACE, true, funcs);
+            ASSERT_NOT_NULL(sink, "Error sink");
+
+            memset(padding, 'x', sizeof(padding) - 1);
+            for (int i = 0; i < SYSLOG_LOGS; i++) {
+                WARN("unix log %d %s %s", i, padding, padding);
+            }
+            size_t max_length = 0;
+            int datagrams = read_datagrams(fd, &max_length);
+            linc_set_sink_enabled(sink, false);
+            close(fd);
+            unlink(path);
+
+            int out_of_order = 0;
+            int count = count_lines("unix log ", &out_of_order);
+            ASSERT_EQUAL(SYSLOG_LOGS, datagrams, "Error datagrams");
+            ASSERT_EQUAL(SYSLOG_LOGS, count, "Error count");
+            ASSERT_EQUAL(0, out_of_order, "Error order");
+            ASSERT_EQUAL(SYSLOG_MIN_DATAGRAM, max_length, "Error datagram not cut");
+            ASSERT_TRUE(strncmp(output, "<12>1 ", 6) == 0, "Error priority of a warning");
+            ASSERT_NOT_NULL(strstr(output, "[ WARN  ]"), "Error layout of the MSG part");
+        });
+
+        TEST_CASE("Should reject invalid syslog sinks", {
+            ASSERT_NULL(linc_sink_syslog_funcs(NULL, "514", NULL).open, "Error NULL address");
+            struct linc_sink_funcs funcs = linc_sink_syslog_funcs("/nonexistent/log", NULL, NULL);
+            ASSERT_NULL(linc_register_sink("missing", LINC_LEVEL_TRACE, true, funcs), "Error missing Unix socket");
+            syslog_options.max_datagram = SYSLOG_MIN_DATAGRAM - 1;
+            ASSERT_NULL(linc_sink_syslog_funcs("127.0.0.1", "514", &syslog_options).open, "Error too small datagram");
+            syslog_options.max_datagram = LINC_DEFAULT_SYSLOG_BUFFER_BYTES + 1;
+            ASSERT_NULL(linc_sink_syslog_funcs("127.0.0.1", "514", &syslog_options).open, "Error datagram over buffer");
+            syslog_options.max_datagram = 0;
+            syslog_options.facility = 24;
+            ASSERT_NULL(linc_sink_syslog_funcs("127.0.0.1", "514", &syslog_options).open, "Error facility");
+        });
+    });
+})
@@ -0,0 +1,207 @@
+#include "internal/binary.h"
+#include "internal/shared.h"
+#include "linc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+
+// Converts the files of binary sinks back into the lines the default text layout would have written, optionally only
+// the logs of a time range, from a level or of a module.
+//
+//   linc-decode [-l level] [-m module] [-s start] [-e end] [file...]
+//
+// Times are seconds since epoch or "YYYY-MM-DD HH:MM:SS", both with an optional fraction of second, in the timezone
+// of the log lines. The start is included and the end is not. Files are read from the standard input if none is given.
+
+#define DECODE_BUFFER_LENGTH 65536  // Bytes read from a file at once
+
+struct decode_filter {
+    enum linc_level level;  // Lowest level printed
+    const char *module;     // Module printed, NULL for all
+    int64_t start;          // First timestamp printed
+    int64_t end;            // Timestamp after the last one printed
+};
+
+static struct linc_binary_reader decode_reader;
+static struct linc_metadata decode_metadata;
+static char decode_buffer[DECODE_BUFFER_LENGTH + LINC_BINARY_RECORD_LENGTH];
+static char decode_line[LINC_LOG_MAX_LENGTH];
+
+// Days since epoch of a date of the proleptic Gregorian calendar.
+static int64_t decode_days(int64_t year, int64_t month, int64_t day) {
+    year -= month <= 2;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    int64_t year_of_era = year - era * 400;
+    int64_t day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int64_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + day_of_era - 719468;
+}
+
+// Reads a time into nanoseconds since epoch, returns -1 if it is not valid.
+static int decode_time(const char *text, int64_t *timestamp) {
+    int year = 0;
+    int month = 0;
+    int day = 0;
+    int hour = 0;
+    int minute = 0;
+    int second = 0;
+    int length = 0;
+    int64_t seconds = 0;
+    if (sscanf(text, "%4d-%2d-%2d%*1[ T]%2d:%2d:%2d%n", &year, &month, &day, &hour, &minute, &second, &length) == 6
+        && length > 0) {
+        if (LINC_DEFAULT_TIMEZONE == LINC_TIMEZONE_LOCAL) {
+            struct tm tm;
+            memset(&tm, 0, sizeof(tm));
+            tm.tm_year = year - 1900;
+            tm.tm_mon = month - 1;
+            tm.tm_mday = day;
+            tm.tm_hour = hour;
+            tm.tm_min = minute;
+            tm.tm_sec = second;
+            tm.tm_isdst = -1;
+            seconds = (int64_t)mktime(&tm);
+        } else {
+            seconds = decode_days(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+        }
+    } else {
+        char *end = NULL;
+        seconds = strtoll(text, &end, 10);
+        if (end == text) {
+            return -1;
+        }
+        length = (int)(end - text);
+    }
+
+    int64_t fraction = 0;
+    const char *rest = text + length;
+    if (*rest == '.') {
+        int64_t scale = 100000000;
+        for (rest++; *rest >= '0' && *rest <= '9'; rest++) {
+            fraction += (*rest - '0') * scale;
+            scale /= 10;
+        }
+    }
+    if (*rest != '\0') {
+        return -1;
+    }
+    *timestamp = seconds * 1000000000L + fraction;
+    return 0;
+}
+
+static int decode_level(const char *text, enum linc_level *level) {
+    for (int i = LINC_LEVEL_TRACE; i <= LINC_LEVEL_FATAL; i++) {
+        if (strcasecmp(text, linc_level_string((enum linc_level)i)) == 0) {
+            *level = (enum linc_level)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static bool decode_is_printed(const struct decode_filter *filter, const struct linc_metadata *metadata) {
+    if (metadata->level < filter->level || metadata->timestamp < filter->start || metadata->timestamp >= filter->end) {
+        return false;
+    }
+    if (filter->module == NULL) {
+        return true;
+    }
+    const char *module = metadata->module_name != NULL ? metadata->module_name : "unknown";
+    return strcmp(module, filter->module) == 0;
+}
+
+// Prints the logs of the file that pass the filter, returns -1 if the file cannot be read or is not valid.
+static int decode_file(FILE *file, const char *name, const struct decode_filter *filter) {
+    memset(&decode_reader, 0, sizeof(decode_reader));
+    size_t length = 0;
+    size_t offset = 0;
+    bool is_eof = false;
+    while (true) {
+        if (!is_eof && length < LINC_BINARY_RECORD_LENGTH) {
+            size_t bytes = fread(decode_buffer + length, 1, sizeof(decode_buffer) - length, file);
+            length += bytes;
+            is_eof = bytes == 0;
+            if (is_eof && ferror(file)) {
+                fprintf(stderr, "linc-decode: %s: read error\n", name);
+                return -1;
+            }
+        }
+        size_t position = 0;
+        enum linc_binary_status status = LINC_BINARY_DEFINITION;
+        while (status != LINC_BINARY_PARTIAL && (is_eof || length - position >= LINC_BINARY_RECORD_LENGTH)) {
+            size_t used = 0;
+            const char *data = decode_buffer + position;
+            status = linc_binary_decode(&decode_reader, data, length - position, &decode_metadata, &used);
+            if (status == LINC_BINARY_INVALID) {
+                fprintf(stderr, "linc-decode: %s: invalid data at offset %zu\n", name, offset + position);
+                return -1;
+            }
+            if (status == LINC_BINARY_RECORD && decode_is_printed(filter, &decode_metadata)) {
+                int result = linc_stringify_metadata(&decode_metadata, decode_line, sizeof(decode_line), false);
+                fputs(result >= 0 ? decode_line : "[ LINC ERROR ] Internal logging error\n", stdout);
+            }
+            position += used;
+        }
+        memmove(decode_buffer, decode_buffer + position, length - position);
+        length -= position;
+        offset += position;
+        if (is_eof) {
+            break;
+        }
+    }
+    if (length > 0) {
+        fprintf(stderr, "linc-decode: %s: truncated log at offset %zu\n", name, offset);
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    struct decode_filter filter = {.level = LINC_LEVEL_TRACE, .module = NULL, .start = INT64_MIN, .end = INT64_MAX};
+    int option = 0;
+    while ((option = getopt(argc, argv, "l:m:s:e:")) != -1) {
+        int result = 0;
+        switch (option) {
+            case 'l':
+                result = decode_level(optarg, &filter.level);
+                break;
+            case 'm':
+                filter.module = optarg;
+                break;
+            case 's':
+                result = decode_time(optarg, &filter.start);
+                break;
+            case 'e':
+                result = decode_time(optarg, &filter.end);
+                break;
+            default:
+                result = -1;
+                break;
+        }
+        if (result < 0) {
+            fprintf(stderr, "usage: linc-decode [-l level] [-m module] [-s start] [-e end] [file...]\n");
+            return 2;
+        }
+    }
+
+    int status = 0;
+    if (optind == argc) {
+        status = decode_file(stdin, "stdin", &filter) < 0 ? 1 : 0;
+    }
+    for (int i = optind; i < argc; i++) {
+        FILE *file = fopen(argv[i], "rb");
+        if (file == NULL) {
+            fprintf(stderr, "linc-decode: %s: cannot open\n", argv[i]);
+            status = 1;
+            continue;
+        }
+        if (decode_file(file, argv[i], &filter) < 0) {
+            status = 1;
+        }
+        fclose(file);
+    }
+    return status;
+}
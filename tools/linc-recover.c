@@ -0,0 +1,71 @@
+#include "internal/recovery.h"
+#include "internal/shared.h"
+#include "linc.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Prints the records left in the ring file of a process that crashed, the oldest first, as the default text layout
+// would have written them. The file is the one named by LINC_RING_FILE when the process started, or the one it was
+// moved aside to, "<file>.<pid>", when the process started again before the file was read. The tool only links the
+// reader of ring files, not the library, so it never maps a ring of its own, even with LINC_RING_FILE set.
+//
+//   linc-recover file...
+
+static struct linc_metadata recover_metadata;
+static struct linc_recovery_line recover_line;
+
+// Prints the records of the file, returns -1 if the file cannot be read or is not valid.
+static int recover_file(const char *name) {
+    int fd = open(name, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "linc-recover: %s: cannot open\n", name);
+        return -1;
+    }
+    struct stat info;
+    void *data = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (data == MAP_FAILED) {
+        fprintf(stderr, "linc-recover: %s: cannot map\n", name);
+        return -1;
+    }
+
+    struct linc_recovery_reader reader;
+    if (linc_recovery_open(&reader, data, (size_t)info.st_size) < 0) {
+        fprintf(stderr, "linc-recover: %s: not a ring file of this build\n", name);
+        munmap(data, (size_t)info.st_size);
+        return -1;
+    }
+    int status = 0;
+    while ((status = linc_recovery_next(&reader, &recover_metadata)) > 0) {
+        linc_recovery_format(&recover_line, &recover_metadata);
+        fwrite(recover_line.text, 1, recover_line.length, stdout);
+    }
+    if (status < 0) {
+        unsigned long long position = (unsigned long long)reader.position;
+        fprintf(stderr, "linc-recover: %s: invalid record at position %llu\n", name, position);
+    }
+    munmap(data, (size_t)info.st_size);
+    return status;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: linc-recover file...\n");
+        return 2;
+    }
+    int status = 0;
+    for (int i = 1; i < argc; i++) {
+        if (recover_file(argv[i]) < 0) {
+            status = 1;
+        }
+    }
+    return status;
+}